@@ -0,0 +1,531 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BotStressSubsystem.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "PickupCube.h"
+#include "Engine/World.h"
+#include "Dom/JsonObject.h"
+#include "Misc/CommandLine.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBotStress, Log, All);
+
+/** Comma or space separated bot counts, e.g. "8,16,32" */
+static TArray<int32> ParseBotCounts(const FString& Text)
+{
+	TArray<FString> Parts;
+	Text.ParseIntoArray(Parts, TEXT(","), true);
+
+	TArray<int32> Counts;
+	for (const FString& Part : Parts)
+	{
+		TArray<FString> Words;
+		Part.ParseIntoArrayWS(Words);
+		for (const FString& Word : Words)
+		{
+			if (Word.IsNumeric())
+			{
+				Counts.Add(FCString::Atoi(*Word));
+			}
+		}
+	}
+	return Counts;
+}
+
+void UBotStressSubsystem::Deinitialize()
+{
+	if (IsRunning())
+	{
+		StopStress();
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UBotStressSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBotStressSubsystem, STATGROUP_Tickables);
+}
+
+void UBotStressSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString CountsText;
+	if (!CommandLineRun.Claim(InWorld, TEXT("LiquidXBots"), CountsText))
+	{
+		return;
+	}
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	int32 CommandLineFrames = DefaultMeasureFrames;
+	FParse::Value(CommandLine, TEXT("BotFrames="), CommandLineFrames);
+	FParse::Value(CommandLine, TEXT("BotWarmup="), WarmupFrames);
+	FParse::Value(CommandLine, TEXT("BotTargetGameThreadMs="), TargetGameThreadMs);
+	RateScale = 1.0f;
+	FParse::Value(CommandLine, TEXT("BotRateScale="), RateScale);
+
+	TArray<int32> CommandLineCounts = ParseBotCounts(CountsText);
+	if (CommandLineCounts.Num() == 0)
+	{
+		CommandLineCounts = DefaultBotCounts;
+	}
+
+	if (!StartStress(CommandLineCounts, CommandLineFrames))
+	{
+		CommandLineRun.Finish(false);
+	}
+}
+
+bool UBotStressSubsystem::StartStress(const TArray<int32>& InBotCounts, int32 InMeasureFrames)
+{
+	UWorld* World = GetWorld();
+	if (IsRunning() || World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogBotStress, Warning, TEXT("Bot stress not started: %s"), IsRunning() ? TEXT("a run is in progress") : TEXT("clients can't spawn bots"));
+		return false;
+	}
+
+	BotCounts.Reset();
+	for (int32 Count : InBotCounts)
+	{
+		if (Count > 0)
+		{
+			BotCounts.AddUnique(Count);
+		}
+	}
+	BotCounts.Sort();
+	if (BotCounts.Num() == 0)
+	{
+		UE_LOG(LogBotStress, Warning, TEXT("Bot stress not started: no bot counts"));
+		return false;
+	}
+
+	// Stages add bots on top of the previous stage's, so start from none
+	ClearBots();
+
+	MeasureFrames = FMath::Max(1, InMeasureFrames);
+	StageIndex = 0;
+	FrameInPhase = 0;
+	Samples.Reset(MeasureFrames);
+	StageResults.Reset();
+
+	SpawnArena();
+
+	Sampler.Start(World, nullptr, [this](const FPerfFrameTiming& Timing) { HandleFrame(Timing); });
+
+	Phase = EPhase::Spawning;
+	UE_LOG(LogBotStress, Display, TEXT("Bot stress: %d stages up to %d bots, %d warmup + %d measured frames each, rate scale %.2f"),
+		BotCounts.Num(), BotCounts.Last(), WarmupFrames, MeasureFrames, RateScale);
+	return true;
+}
+
+void UBotStressSubsystem::StopStress()
+{
+	if (IsRunning())
+	{
+		FinishStress();
+	}
+}
+
+int32 UBotStressSubsystem::SpawnBots(int32 Count)
+{
+	if (IsRunning() || GetWorld()->GetNetMode() == NM_Client)
+	{
+		return 0;
+	}
+
+	SpawnArena();
+
+	int32 NumSpawned = 0;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		NumSpawned += SpawnBot() ? 1 : 0;
+	}
+	return NumSpawned;
+}
+
+void UBotStressSubsystem::ClearBots()
+{
+	if (IsRunning())
+	{
+		return;
+	}
+
+	Arena.Clear(GetWorld());
+	Bots.Empty();
+	ClusterCentres.Empty();
+	WallLanes.Empty();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Arena
+
+void UBotStressSubsystem::SpawnArena()
+{
+	if (ClusterCentres.Num() > 0 || WallLanes.Num() > 0)
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	Stream.Initialize(TEXT("LiquidXBots"));
+
+	UClass* SpawnCubeClass = CubeClass.LoadSynchronous();
+	if (!SpawnCubeClass)
+	{
+		SpawnCubeClass = APickupCube::StaticClass();
+	}
+
+	auto RandomArenaPoint = [this](float Radius)
+	{
+		const FVector2D Point = FVector2D(Stream.FRandRange(-1.0f, 1.0f), Stream.FRandRange(-1.0f, 1.0f)).GetSafeNormal() * Radius * FMath::Sqrt(Stream.FRand());
+		return Origin + FVector(Point, 0.0f);
+	};
+
+	// Walls anywhere in the arena with a lane down their left side; the lane's wall is on its right
+	for (int32 Index = 0; Index < NumWalls; ++Index)
+	{
+		const FRotator Rotation(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f);
+		const FVector Location = RandomArenaPoint(ArenaRadius - WallLength * 0.5f);
+		if (!Arena.SpawnWall(World, Location, Rotation, FVector(WallLength / 100.0f, 0.2f, 4.0f)))
+		{
+			continue;
+		}
+
+		// Close enough to the wall for the wall probes to reach
+		FWallLane& Lane = WallLanes.AddDefaulted_GetRef();
+		Lane.Direction = Rotation.Vector();
+		Lane.Start = Location - Lane.Direction * WallLength * 0.5f - FRotationMatrix(Rotation).GetUnitAxis(EAxis::Y) * 60.0f;
+	}
+
+	// Clusters of cubes for the bots to run to, pick up, throw and punch. The arena is built before any
+	// stage is measured, so the spawn cost never shows up in the results.
+	for (int32 Cluster = 0; Cluster < NumCubeClusters; ++Cluster)
+	{
+		const FVector Centre = RandomArenaPoint(ArenaRadius * 0.9f);
+		ClusterCentres.Add(Centre);
+		for (int32 Slot = 0; Slot < CubesPerCluster; ++Slot)
+		{
+			const float Angle = 2.0f * PI * Slot / CubesPerCluster;
+			const float Radius = 120.0f + 60.0f * (Slot % 2);
+			const FTransform CubeTransform(Centre + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0f));
+			Arena.AcquireCube(World, SpawnCubeClass, CubeTransform);
+		}
+	}
+}
+
+bool UBotStressSubsystem::SpawnBot()
+{
+	UWorld* World = GetWorld();
+
+	UClass* SpawnCharacterClass = CharacterClass.LoadSynchronous();
+	if (!SpawnCharacterClass)
+	{
+		SpawnCharacterClass = ALiquidX_Test_SimpleCharacter::StaticClass();
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	FVector Location;
+	if (!GetRandomMoveTarget(Stream, Location))
+	{
+		Location = Origin;
+	}
+	Location += FVector(Stream.FRandRange(-300.0f, 300.0f), Stream.FRandRange(-300.0f, 300.0f), 0.0f);
+	const FTransform Transform(FRotator(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f), Location);
+
+	ALiquidX_Test_SimpleCharacter* Character = World->SpawnActor<ALiquidX_Test_SimpleCharacter>(SpawnCharacterClass, Transform, SpawnParams);
+	if (!Character)
+	{
+		return false;
+	}
+
+	ALiquidXBotController* Controller = World->SpawnActor<ALiquidXBotController>(ALiquidXBotController::StaticClass(), Transform, SpawnParams);
+	if (!Controller)
+	{
+		Character->Destroy();
+		return false;
+	}
+
+	FBotActionRates ScaledRates = BotRates;
+	ScaledRates.SprintPerMinute *= RateScale;
+	ScaledRates.DoubleJumpPerMinute *= RateScale;
+	ScaledRates.JetpackPerMinute *= RateScale;
+	ScaledRates.WallRunPerMinute *= RateScale;
+	ScaledRates.PickupThrowPerMinute *= RateScale;
+	ScaledRates.PunchPerMinute *= RateScale;
+
+	Controller->Possess(Character);
+	Controller->InitializeBot(ScaledRates, Stream.RandHelper(MAX_int32));
+	Bots.Add(Character);
+	Arena.Add(Character);
+	Arena.Add(Controller);
+	return true;
+}
+
+bool UBotStressSubsystem::GetRandomMoveTarget(FRandomStream& InStream, FVector& OutTarget) const
+{
+	if (ClusterCentres.Num() > 0 && InStream.FRand() < 0.8f)
+	{
+		OutTarget = ClusterCentres[InStream.RandHelper(ClusterCentres.Num())];
+		return true;
+	}
+
+	if (ClusterCentres.Num() == 0 && WallLanes.Num() == 0)
+	{
+		return false;
+	}
+
+	const FVector2D Point = FVector2D(InStream.FRandRange(-1.0f, 1.0f), InStream.FRandRange(-1.0f, 1.0f)).GetSafeNormal() * ArenaRadius * FMath::Sqrt(InStream.FRand());
+	OutTarget = Origin + FVector(Point, 0.0f);
+	return true;
+}
+
+bool UBotStressSubsystem::FindNearestWallLane(const FVector& Location, FVector& OutStart, FVector& OutDirection) const
+{
+	const FWallLane* Nearest = nullptr;
+	float NearestDistSquared = TNumericLimits<float>::Max();
+	for (const FWallLane& Lane : WallLanes)
+	{
+		const float DistSquared = FVector::DistSquared2D(Location, Lane.Start);
+		if (DistSquared < NearestDistSquared)
+		{
+			Nearest = &Lane;
+			NearestDistSquared = DistSquared;
+		}
+	}
+
+	if (!Nearest)
+	{
+		return false;
+	}
+
+	OutStart = Nearest->Start;
+	OutDirection = Nearest->Direction;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Stages
+
+void UBotStressSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	switch (Phase)
+	{
+	case EPhase::Spawning:
+	{
+		const int32 Target = BotCounts[StageIndex];
+		for (int32 Spawned = 0; Spawned < SpawnPerFrame && Bots.Num() < Target; ++Spawned)
+		{
+			if (!SpawnBot())
+			{
+				UE_LOG(LogBotStress, Warning, TEXT("Bot stress: spawn failed at %d bots, measuring what is there"), Bots.Num());
+				BotCounts[StageIndex] = Bots.Num();
+				break;
+			}
+		}
+
+		if (Bots.Num() >= BotCounts[StageIndex])
+		{
+			Phase = EPhase::Warmup;
+			FrameInPhase = 0;
+		}
+		break;
+	}
+
+	case EPhase::Warmup:
+		if (++FrameInPhase >= WarmupFrames)
+		{
+			Phase = EPhase::Measure;
+			FrameInPhase = 0;
+			Samples.Reset(MeasureFrames);
+		}
+		break;
+
+	case EPhase::Measure:
+		if (Samples.Num() >= MeasureFrames)
+		{
+			FinishStage();
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UBotStressSubsystem::FinishStage()
+{
+	FStageResult& Result = StageResults.AddDefaulted_GetRef();
+	Result.NumBots = Bots.Num();
+	Result.NumFrames = Samples.Num();
+
+	Result.FrameMs = FPerfPercentiles::Compute(Samples, [](const FPerfFrameTiming& Sample) { return Sample.FrameMs; });
+	Result.GameThreadMs = FPerfPercentiles::Compute(Samples, [](const FPerfFrameTiming& Sample) { return Sample.GameThreadMs; });
+	Result.TracesPerFrame = FPerfPercentiles::Compute(Samples, [](const FPerfFrameTiming& Sample) { return Sample.NumTraces; }).Average;
+
+	UE_LOG(LogBotStress, Display, TEXT("Bot stress: %d bots, frame avg %.2f p50 %.2f p95 %.2f p99 %.2f ms, game thread p95 %.2f ms, traces %.1f/frame"),
+		Result.NumBots, Result.FrameMs.Average, Result.FrameMs.P50, Result.FrameMs.P95, Result.FrameMs.P99, Result.GameThreadMs.P95, Result.TracesPerFrame);
+
+	Samples.Reset();
+	++StageIndex;
+	if (StageIndex >= BotCounts.Num())
+	{
+		FinishStress();
+		return;
+	}
+
+	Phase = EPhase::Spawning;
+	FrameInPhase = 0;
+}
+
+void UBotStressSubsystem::FinishStress()
+{
+	Sampler.Stop();
+
+	const bool bCompleted = StageResults.Num() == BotCounts.Num();
+	WriteResults();
+
+	Phase = EPhase::Idle;
+	Samples.Empty();
+	ClearBots();
+
+	CommandLineRun.Finish(bCompleted);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Measurement
+
+void UBotStressSubsystem::HandleFrame(const FPerfFrameTiming& Timing)
+{
+	if (Phase == EPhase::Measure && Timing.bHasFrameMs)
+	{
+		Samples.Add(Timing);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Results
+
+void UBotStressSubsystem::WriteResults()
+{
+	const FString OutputPath = FPerfReport::GetOutputPath(TEXT("BotOutput"), TEXT("Benchmarks"), TEXT("Bots"));
+
+	// The largest stage that held the target, as long as every smaller stage held it too
+	int32 MaxBotsWithinTarget = 0;
+	for (const FStageResult& Result : StageResults)
+	{
+		if (Result.GameThreadMs.P95 > TargetGameThreadMs)
+		{
+			break;
+		}
+		MaxBotsWithinTarget = Result.NumBots;
+	}
+
+	// Scaling curve CSV, one row per stage
+	FString Csv = TEXT("Bots,Frames,FrameAvgMs,FrameP50Ms,FrameP90Ms,FrameP95Ms,FrameP99Ms,FrameMaxMs,GameThreadAvgMs,GameThreadP95Ms,GameThreadP99Ms,TracesPerFrame\n");
+	for (const FStageResult& Result : StageResults)
+	{
+		Csv += FString::Printf(TEXT("%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f\n"),
+			Result.NumBots, Result.NumFrames,
+			Result.FrameMs.Average, Result.FrameMs.P50, Result.FrameMs.P90, Result.FrameMs.P95, Result.FrameMs.P99, Result.FrameMs.Max,
+			Result.GameThreadMs.Average, Result.GameThreadMs.P95, Result.GameThreadMs.P99, Result.TracesPerFrame);
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Stages;
+	for (const FStageResult& Result : StageResults)
+	{
+		TSharedRef<FJsonObject> Stage = MakeShared<FJsonObject>();
+		Stage->SetNumberField(TEXT("bots"), Result.NumBots);
+		Stage->SetNumberField(TEXT("frames"), Result.NumFrames);
+		Stage->SetObjectField(TEXT("frameMs"), Result.FrameMs.ToJson());
+		Stage->SetObjectField(TEXT("gameThreadMs"), Result.GameThreadMs.ToJson());
+		Stage->SetNumberField(TEXT("tracesPerFrame"), Result.TracesPerFrame);
+		Stages.Add(MakeShared<FJsonValueObject>(Stage));
+	}
+
+	TSharedRef<FJsonObject> Root = FPerfReport::MakeJson(GetWorld());
+	Root->SetNumberField(TEXT("warmupFrames"), WarmupFrames);
+	Root->SetNumberField(TEXT("measureFrames"), MeasureFrames);
+	Root->SetNumberField(TEXT("rateScale"), RateScale);
+	Root->SetNumberField(TEXT("targetGameThreadMs"), TargetGameThreadMs);
+	Root->SetNumberField(TEXT("maxBotsWithinTarget"), MaxBotsWithinTarget);
+	Root->SetBoolField(TEXT("completed"), StageResults.Num() == BotCounts.Num());
+	Root->SetArrayField(TEXT("stages"), Stages);
+	FPerfReport::Write(OutputPath, Csv, Root);
+
+	UE_LOG(LogBotStress, Display, TEXT("Bot stress: %d of %d stages, p95 world tick time held %.1f ms up to %d bots -> %s.json"),
+		StageResults.Num(), BotCounts.Num(), TargetGameThreadMs, MaxBotsWithinTarget, *OutputPath);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void RunBotStress(const TArray<FString>& Args, UWorld* World)
+{
+	UBotStressSubsystem* BotStress = World ? World->GetSubsystem<UBotStressSubsystem>() : nullptr;
+	if (!BotStress)
+	{
+		return;
+	}
+
+	TArray<int32> Counts = ParseBotCounts(FString::Join(Args, TEXT(",")));
+	if (Counts.Num() == 0)
+	{
+		Counts = BotStress->DefaultBotCounts;
+	}
+	BotStress->StartStress(Counts, BotStress->DefaultMeasureFrames);
+}
+
+static void StopBotStress(const TArray<FString>& Args, UWorld* World)
+{
+	if (UBotStressSubsystem* BotStress = World ? World->GetSubsystem<UBotStressSubsystem>() : nullptr)
+	{
+		BotStress->StopStress();
+	}
+}
+
+static void SpawnStressBots(const TArray<FString>& Args, UWorld* World)
+{
+	UBotStressSubsystem* BotStress = World ? World->GetSubsystem<UBotStressSubsystem>() : nullptr;
+	if (!BotStress || Args.Num() < 1)
+	{
+		UE_LOG(LogBotStress, Warning, TEXT("Usage: LiquidX.Bots.Spawn <Count>"));
+		return;
+	}
+
+	const int32 NumSpawned = BotStress->SpawnBots(FCString::Atoi(*Args[0]));
+	UE_LOG(LogBotStress, Display, TEXT("Spawned %d bots, %d in total"), NumSpawned, BotStress->GetNumBots());
+}
+
+static void ClearStressBots(const TArray<FString>& Args, UWorld* World)
+{
+	if (UBotStressSubsystem* BotStress = World ? World->GetSubsystem<UBotStressSubsystem>() : nullptr)
+	{
+		BotStress->ClearBots();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RunBotStressCommand(
+	TEXT("LiquidX.Bots.Run"),
+	TEXT("Measure frame time with increasing bot counts, e.g. LiquidX.Bots.Run 8 16 32, and write the scaling curve to Saved/Benchmarks"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBotStress));
+
+static FAutoConsoleCommandWithWorldAndArgs StopBotStressCommand(
+	TEXT("LiquidX.Bots.Stop"),
+	TEXT("End the running bot stress run early and write the stages measured so far"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopBotStress));
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnBotsCommand(
+	TEXT("LiquidX.Bots.Spawn"),
+	TEXT("Add <Count> AI bots to the bot arena without measuring"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SpawnStressBots));
+
+static FAutoConsoleCommandWithWorldAndArgs ClearBotsCommand(
+	TEXT("LiquidX.Bots.Clear"),
+	TEXT("Remove the AI bots and their arena"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ClearStressBots));
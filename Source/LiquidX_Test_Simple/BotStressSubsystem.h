@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LiquidXBotController.h"
+#include "LiquidXPerfRun.h"
+#include "BotStressSubsystem.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+class APickupCube;
+
+/**
+ * Bot stress harness for sizing server hardware. Builds an arena of cube clusters and wall-run walls,
+ * then raises the number of ALiquidXBotController-driven characters through a list of stages. Each
+ * stage spawns bots up to its count, warms up, then measures frame time and world tick (game thread)
+ * time. The scaling curve, one row per stage with average, p50, p90, p95, p99 and max, goes to
+ * Saved/Benchmarks as CSV and JSON, along with the largest bot count whose p95 world tick time held
+ * TargetGameThreadMs.
+ *
+ * Started from the command line, the process exits when the last stage is done:
+ *   LiquidX_Test_Simple <Map> -nullrhi -unattended -nosound -LiquidXBots=8,16,32,64,128,256
+ *     [-BotFrames=N] [-BotWarmup=N] [-BotRateScale=X] [-BotOutput=<Path>] [-BotTargetGameThreadMs=X]
+ * Add -server for a dedicated server. From the console: LiquidX.Bots.Run <Count> [Count...],
+ * LiquidX.Bots.Stop, LiquidX.Bots.Spawn <Count> for unmeasured bots to play among and LiquidX.Bots.Clear.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UBotStressSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Run a stage for each bot count, in increasing order. Fails while a run is in progress or on a network client. */
+	bool StartStress(const TArray<int32>& InBotCounts, int32 InMeasureFrames);
+
+	/** End the run now, write the stages measured so far and remove the bots and arena */
+	void StopStress();
+
+	bool IsRunning() const { return Phase != EPhase::Idle; }
+
+	/** Build the arena if needed and add Count bots to it, unmeasured. Returns how many were spawned. */
+	int32 SpawnBots(int32 Count);
+
+	/** Remove the bots and arena; not while a run is in progress */
+	void ClearBots();
+
+	int32 GetNumBots() const { return Bots.Num(); }
+
+	/** A point for a bot to run to: usually a cube cluster, otherwise anywhere in the arena. False without an arena. */
+	bool GetRandomMoveTarget(FRandomStream& Stream, FVector& OutTarget) const;
+
+	/** Start and direction of the wall-run lane closest to Location; its wall is on the right */
+	bool FindNearestWallLane(const FVector& Location, FVector& OutStart, FVector& OutDirection) const;
+
+	/** Character the bots drive; the plain native class when this doesn't load */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots")
+	TSoftClassPtr<ALiquidX_Test_SimpleCharacter> CharacterClass;
+
+	/** Cube spawned in the arena; the plain native class when this doesn't load */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots")
+	TSoftClassPtr<APickupCube> CubeClass;
+
+	/** Action rates given to every bot, scaled by -BotRateScale */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots")
+	FBotActionRates BotRates;
+
+	/** Bot counts of the stages when none are given */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots")
+	TArray<int32> DefaultBotCounts;
+
+	/** Centre of the arena, at floor height plus a little */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Arena")
+	FVector Origin = FVector(0.0f, 0.0f, 200.0f);
+
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Arena", meta = (ClampMin = "100"))
+	float ArenaRadius = 4000.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Arena", meta = (ClampMin = "0"))
+	int32 NumCubeClusters = 32;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Arena", meta = (ClampMin = "1"))
+	int32 CubesPerCluster = 8;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Arena", meta = (ClampMin = "0"))
+	int32 NumWalls = 16;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Arena", meta = (ClampMin = "100"))
+	float WallLength = 1200.0f;
+
+	/** Bots spawned per frame while a stage fills up, so spawning doesn't hitch the measurement */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Measurement", meta = (ClampMin = "1"))
+	int32 SpawnPerFrame = 16;
+
+	/** Frames run after a stage's bots are in before measuring */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Measurement", meta = (ClampMin = "0"))
+	int32 WarmupFrames = 180;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Measurement", meta = (ClampMin = "1"))
+	int32 DefaultMeasureFrames = 600;
+
+	/**
+	 * World tick time a stage's p95 has to hold to count towards maxBotsWithinTarget; 33.3 is a 30 Hz server.
+	 * Frame time can't be used: a -server run waits out its tick-rate cap, so frames never drop below 33.3 ms.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Bots|Measurement", meta = (ClampMin = "0"))
+	float TargetGameThreadMs = 33.3f;
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		Spawning,
+		Warmup,
+		Measure
+	};
+
+	struct FStageResult
+	{
+		int32 NumBots = 0;
+		int32 NumFrames = 0;
+		FPerfPercentiles FrameMs;
+		FPerfPercentiles GameThreadMs;
+		float TracesPerFrame = 0.0f;
+	};
+
+	struct FWallLane
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector Direction = FVector::ForwardVector;
+	};
+
+	void SpawnArena();
+	bool SpawnBot();
+	void FinishStage();
+	void FinishStress();
+	void WriteResults();
+	void HandleFrame(const FPerfFrameTiming& Timing);
+
+	EPhase Phase = EPhase::Idle;
+	TArray<int32> BotCounts;
+	int32 StageIndex = 0;
+	int32 MeasureFrames = 0;
+	int32 FrameInPhase = 0;
+	float RateScale = 1.0f;
+
+	/** -LiquidXBots; exit when done */
+	FPerfCommandLineRun CommandLineRun;
+
+	/** Seeds the arena layout and each bot, so runs are comparable */
+	FRandomStream Stream;
+
+	TArray<FVector> ClusterCentres;
+	TArray<FWallLane> WallLanes;
+
+	/** Walls, pooled cubes and the bots with their controllers, removed by ClearBots */
+	FPerfArena Arena;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ALiquidX_Test_SimpleCharacter>> Bots;
+
+	FPerfFrameSampler Sampler;
+	TArray<FPerfFrameTiming> Samples;
+	TArray<FStageResult> StageResults;
+};
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterAbilities.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "WallRunProbeSubsystem.h"
+#include "LiquidXCharacterMovementComponent.h"
+#include "LiquidXStats.h"
+
+/////Jetpack/////
+bool UJetpackAbility::Activate()
+{
+	// The input fires every frame while held; only the first press counts as an activation
+	ULiquidXCharacterMovementComponent* Movement = GetCharacter()->GetLiquidXMovement();
+	const bool bWasActive = Movement->WantsJetpack();
+	Movement->SetWantsJetpack(true);
+	return !bWasActive;
+}
+
+void UJetpackAbility::Deactivate()
+{
+	GetCharacter()->GetLiquidXMovement()->SetWantsJetpack(false);
+}
+
+/////Wall run/////
+void UWallRunAbility::OnRegistered()
+{
+	if (bUseAsyncProbes)
+	{
+		if (UWallRunProbeSubsystem* Probes = GetWorld()->GetSubsystem<UWallRunProbeSubsystem>())
+		{
+			ProberHandle = Probes->RegisterProber(GetCharacter());
+		}
+	}
+}
+
+void UWallRunAbility::OnUnregistered()
+{
+	if (ProberHandle != INDEX_NONE)
+	{
+		if (UWallRunProbeSubsystem* Probes = GetWorld()->GetSubsystem<UWallRunProbeSubsystem>())
+		{
+			Probes->UnregisterProber(ProberHandle);
+		}
+		ProberHandle = INDEX_NONE;
+	}
+}
+
+bool UWallRunAbility::ShouldTick() const
+{
+	const ULiquidXCharacterMovementComponent* Movement = GetCharacter()->GetLiquidXMovement();
+	return Movement->IsWallRunning() || Movement->IsFalling();
+}
+
+void UWallRunAbility::TickAbility(float DeltaTime)
+{
+	if (ProberHandle != INDEX_NONE)
+	{
+		CheckWallRunAsync();
+	}
+	else
+	{
+		GetCharacter()->CheckWallRun();
+	}
+}
+
+void UWallRunAbility::SetProbeLOD(int32 MinInterval, bool bDebugDraw)
+{
+	if (ProberHandle != INDEX_NONE)
+	{
+		if (UWallRunProbeSubsystem* Probes = GetWorld()->GetSubsystem<UWallRunProbeSubsystem>())
+		{
+			Probes->SetProberLOD(ProberHandle, MinInterval, bDebugDraw);
+		}
+	}
+}
+
+void UWallRunAbility::CheckWallRunAsync()
+{
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_WallRunCheck);
+
+	ALiquidX_Test_SimpleCharacter* Character = GetCharacter();
+	ULiquidXCharacterMovementComponent* Movement = Character->GetLiquidXMovement();
+	UWallRunProbeSubsystem* Probes = GetWorld()->GetSubsystem<UWallRunProbeSubsystem>();
+
+	if (Movement->IsWallRunning())
+	{
+		// Once running, the movement component keeps confirming the wall itself
+		return;
+	}
+
+	if (!Movement->IsFalling())
+	{
+		// Forget the last fall's result so the next jump doesn't start from it
+		Probes->ResetProbeResult(ProberHandle);
+		Movement->SetWallRunHint(false, FVector::ZeroVector);
+		return;
+	}
+
+	// Hand last frame's probe to the movement component, then ask for the next one from where we are now
+	const FWallProbeResult& Result = Probes->GetProbeResult(ProberHandle);
+	if (Result.bValid)
+	{
+		Movement->SetWallRunHint(Result.bHit, Result.WallNormal);
+	}
+
+	Probes->UpdateProbe(ProberHandle, Character->GetActorLocation(), Character->GetActorRightVector(),
+		Character->GetActorForwardVector() * Character->GetTuning().WallRunForwardOffset, Character->GetTuning().WallCheckDistance);
+}
+
+/////Double jump/////
+bool UDoubleJumpAbility::Activate()
+{
+	ALiquidX_Test_SimpleCharacter* Character = GetCharacter();
+	ULiquidXCharacterMovementComponent* Movement = Character->GetLiquidXMovement();
+	if (Movement->IsMovingOnGround())
+	{
+		Character->Jump();
+		return true;
+	}
+	else if (Movement->CanDoubleJump())
+	{
+		// Applied by the movement simulation so it is predicted and replayed with the move
+		Movement->RequestDoubleJump();
+		return true;
+	}
+	return false;
+}
+
+/////Sprint/////
+bool USprintAbility::Activate()
+{
+	// The input fires every frame while held; only the first press counts as an activation
+	ULiquidXCharacterMovementComponent* Movement = GetCharacter()->GetLiquidXMovement();
+	if (Movement->WantsToSprint())
+	{
+		return false;
+	}
+
+	Movement->SetWantsToSprint(true);
+	return true;
+}
+
+void USprintAbility::Deactivate()
+{
+	GetCharacter()->GetLiquidXMovement()->SetWantsToSprint(false);
+}
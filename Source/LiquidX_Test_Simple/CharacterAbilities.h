@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CharacterAbility.h"
+#include "CharacterAbilities.generated.h"
+
+/** Relays the jetpack input to the movement component, which burns fuel and thrusts. Never ticks. */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API UJetpackAbility : public UCharacterAbility
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Activate() override;
+	virtual void Deactivate() override;
+};
+
+/**
+ * Wall detection for the movement component's wall-run mode. Only ticks while the character is airborne
+ * or wall-running. With bUseAsyncProbes the wall probes go through UWallRunProbeSubsystem and are
+ * consumed a frame later.
+ */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API UWallRunAbility : public UCharacterAbility
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnRegistered() override;
+	virtual void OnUnregistered() override;
+	virtual bool ShouldTick() const override;
+	virtual void TickAbility(float DeltaTime) override;
+
+	/** Forwarded to the async prober, see UWallRunProbeSubsystem::SetProberLOD */
+	void SetProbeLOD(int32 MinInterval, bool bDebugDraw);
+
+protected:
+	/** Batch the wall probes as async traces instead of two blocking traces per frame */
+	UPROPERTY(EditDefaultsOnly, Category = "Wall Run")
+	bool bUseAsyncProbes = true;
+
+private:
+	void CheckWallRunAsync();
+
+	int32 ProberHandle = INDEX_NONE;
+};
+
+/** Jump, then a second jump while airborne, applied by the movement component. Never ticks. */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API UDoubleJumpAbility : public UCharacterAbility
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Activate() override;
+};
+
+/** Relays the sprint input to the movement component, which raises the walk speed. Never ticks. */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API USprintAbility : public UCharacterAbility
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Activate() override;
+	virtual void Deactivate() override;
+};
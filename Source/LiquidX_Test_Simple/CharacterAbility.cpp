@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterAbility.h"
+#include "CharacterAbilityComponent.h"
+
+UWorld* UCharacterAbility::GetWorld() const
+{
+	return OwnerComponent ? OwnerComponent->GetWorld() : nullptr;
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/EngineBaseTypes.h"
+#include "CharacterAbility.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+class UCharacterAbilityComponent;
+
+/** Timing and usage counters for one ability */
+USTRUCT(BlueprintType)
+struct FCharacterAbilityStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	FName AbilityName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	int32 NumActivations = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	int32 NumTicks = 0;
+
+	/** Time spent in the last tick, in milliseconds */
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	float LastTickMs = 0.0f;
+
+	/** Time spent in all ticks and activations, in milliseconds */
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	float TotalMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	bool bTicking = false;
+};
+
+/**
+ * A movement ability run by UCharacterAbilityComponent. Abilities are triggered by events
+ * (input, landing, movement mode changes) and only tick, in their own tick group, while
+ * ShouldTick() holds.
+ */
+UCLASS(Abstract, Blueprintable)
+class LIQUIDX_TEST_SIMPLE_API UCharacterAbility : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// UObject interface
+	virtual UWorld* GetWorld() const override;
+
+	/** Called once when the owning component creates the ability */
+	virtual void OnRegistered() {}
+
+	/** Called when the owning component ends play */
+	virtual void OnUnregistered() {}
+
+	/** Trigger fired (e.g. input pressed). Returns false if the ability could not activate. */
+	virtual bool Activate() { return true; }
+
+	/** Trigger released (e.g. input released) */
+	virtual void Deactivate() {}
+
+	/** Activation conditions. The ability ticks only while this is true. */
+	virtual bool ShouldTick() const { return false; }
+
+	virtual void TickAbility(float DeltaTime) {}
+
+	ETickingGroup GetTickGroup() const { return TickGroup; }
+
+	const FCharacterAbilityStats& GetStats() const { return Stats; }
+
+	ALiquidX_Test_SimpleCharacter* GetCharacter() const { return Character; }
+
+	UCharacterAbilityComponent* GetOwnerComponent() const { return OwnerComponent; }
+
+protected:
+	/** Tick group this ability runs in while active */
+	UPROPERTY(EditDefaultsOnly, Category = "Ability")
+	TEnumAsByte<ETickingGroup> TickGroup = TG_PrePhysics;
+
+private:
+	friend class UCharacterAbilityComponent;
+
+	UPROPERTY()
+	TObjectPtr<UCharacterAbilityComponent> OwnerComponent;
+
+	UPROPERTY()
+	TObjectPtr<ALiquidX_Test_SimpleCharacter> Character;
+
+	FCharacterAbilityStats Stats;
+};
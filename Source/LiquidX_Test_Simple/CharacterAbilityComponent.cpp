@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterAbilityComponent.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+void FCharacterAbilityTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (IsValid(Target) && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->RunTickGroup(GroupIndex, DeltaTime);
+	}
+}
+
+FString FCharacterAbilityTickFunction::DiagnosticMessage()
+{
+	return GetNameSafe(Target) + TEXT("[AbilityTick]");
+}
+
+FName FCharacterAbilityTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return Target ? Target->GetClass()->GetFName() : NAME_None;
+}
+
+UCharacterAbilityComponent::UCharacterAbilityComponent()
+{
+	// Abilities tick through their own per-group tick functions
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UCharacterAbilityComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ALiquidX_Test_SimpleCharacter* Character = Cast<ALiquidX_Test_SimpleCharacter>(GetOwner());
+	for (const TSubclassOf<UCharacterAbility>& AbilityClass : AbilityClasses)
+	{
+		if (!AbilityClass)
+		{
+			continue;
+		}
+
+		UCharacterAbility* Ability = NewObject<UCharacterAbility>(this, AbilityClass);
+		Ability->OwnerComponent = this;
+		Ability->Character = Character;
+		Ability->Stats.AbilityName = AbilityClass->GetFName();
+		Abilities.Add(Ability);
+
+		// Register every group up front so abilities can start ticking from inside another tick
+		FindOrAddTickGroup(Ability->GetTickGroup());
+	}
+
+	for (UCharacterAbility* Ability : Abilities)
+	{
+		Ability->OnRegistered();
+	}
+	RefreshAbilityTicks();
+}
+
+void UCharacterAbilityComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	for (const TUniquePtr<FAbilityTickGroup>& Group : TickGroups)
+	{
+		if (Character && Character->GetCharacterMovement())
+		{
+			Character->GetCharacterMovement()->PrimaryComponentTick.RemovePrerequisite(this, Group->TickFunction);
+		}
+		Group->TickFunction.UnRegisterTickFunction();
+	}
+	TickGroups.Empty();
+
+	for (UCharacterAbility* Ability : Abilities)
+	{
+		Ability->OnUnregistered();
+	}
+	Abilities.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UCharacterAbilityComponent::TryActivateAbility(TSubclassOf<UCharacterAbility> AbilityClass)
+{
+	UCharacterAbility* Ability = FindAbility(AbilityClass);
+	if (!Ability)
+	{
+		return false;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const bool bActivated = Ability->Activate();
+	Ability->Stats.TotalMs += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	if (bActivated)
+	{
+		Ability->Stats.NumActivations++;
+		RefreshAbilityTick(Ability);
+	}
+	return bActivated;
+}
+
+void UCharacterAbilityComponent::DeactivateAbility(TSubclassOf<UCharacterAbility> AbilityClass)
+{
+	if (UCharacterAbility* Ability = FindAbility(AbilityClass))
+	{
+		Ability->Deactivate();
+		RefreshAbilityTick(Ability);
+	}
+}
+
+void UCharacterAbilityComponent::RefreshAbilityTicks()
+{
+	for (UCharacterAbility* Ability : Abilities)
+	{
+		RefreshAbilityTick(Ability);
+	}
+}
+
+void UCharacterAbilityComponent::RefreshAbilityTick(UCharacterAbility* Ability)
+{
+	if (!Ability || Ability->Stats.bTicking || !Ability->ShouldTick())
+	{
+		return;
+	}
+
+	for (const TUniquePtr<FAbilityTickGroup>& Group : TickGroups)
+	{
+		if (Group->TickFunction.TickGroup == Ability->GetTickGroup())
+		{
+			Ability->Stats.bTicking = true;
+			Group->TickingAbilities.Add(Ability);
+			Group->TickFunction.SetTickFunctionEnable(true);
+			return;
+		}
+	}
+}
+
+UCharacterAbility* UCharacterAbilityComponent::FindAbility(TSubclassOf<UCharacterAbility> AbilityClass) const
+{
+	for (UCharacterAbility* Ability : Abilities)
+	{
+		if (Ability->IsA(AbilityClass))
+		{
+			return Ability;
+		}
+	}
+	return nullptr;
+}
+
+TArray<FCharacterAbilityStats> UCharacterAbilityComponent::GetAbilityStats() const
+{
+	TArray<FCharacterAbilityStats> AllStats;
+	AllStats.Reserve(Abilities.Num());
+	for (const UCharacterAbility* Ability : Abilities)
+	{
+		AllStats.Add(Ability->GetStats());
+	}
+	return AllStats;
+}
+
+void UCharacterAbilityComponent::SetAbilityTickInterval(float TickInterval)
+{
+	if (TickInterval == AbilityTickInterval)
+	{
+		return;
+	}
+
+	// Abilities get the accumulated delta time when they do tick, so their integration stays correct
+	AbilityTickInterval = TickInterval;
+	for (const TUniquePtr<FAbilityTickGroup>& Group : TickGroups)
+	{
+		Group->TickFunction.UpdateTickIntervalAndCoolDown(TickInterval);
+	}
+}
+
+UCharacterAbilityComponent::FAbilityTickGroup& UCharacterAbilityComponent::FindOrAddTickGroup(ETickingGroup Group)
+{
+	for (const TUniquePtr<FAbilityTickGroup>& Existing : TickGroups)
+	{
+		if (Existing->TickFunction.TickGroup == Group)
+		{
+			return *Existing;
+		}
+	}
+
+	const int32 GroupIndex = TickGroups.Add(MakeUnique<FAbilityTickGroup>());
+	FAbilityTickGroup& NewGroup = *TickGroups[GroupIndex];
+
+	FCharacterAbilityTickFunction& TickFunction = NewGroup.TickFunction;
+	TickFunction.Target = this;
+	TickFunction.GroupIndex = GroupIndex;
+	TickFunction.TickGroup = Group;
+	TickFunction.EndTickGroup = Group;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = false;
+	TickFunction.bAllowTickOnDedicatedServer = true;
+	TickFunction.TickInterval = AbilityTickInterval;
+	TickFunction.RegisterTickFunction(GetOwner()->GetLevel());
+
+	// Pre-physics abilities feed forces and velocities into this frame's movement update
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	if (Group <= TG_PrePhysics && Character && Character->GetCharacterMovement())
+	{
+		Character->GetCharacterMovement()->PrimaryComponentTick.AddPrerequisite(this, TickFunction);
+	}
+
+	return NewGroup;
+}
+
+void UCharacterAbilityComponent::RunTickGroup(int32 GroupIndex, float DeltaTime)
+{
+	if (!TickGroups.IsValidIndex(GroupIndex))
+	{
+		return;
+	}
+
+	FAbilityTickGroup& Group = *TickGroups[GroupIndex];
+
+	// Index loop: an ability may start others (and append to this list) from inside its tick
+	for (int32 AbilityIndex = 0; AbilityIndex < Group.TickingAbilities.Num();)
+	{
+		UCharacterAbility* Ability = Group.TickingAbilities[AbilityIndex];
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Ability->TickAbility(DeltaTime);
+		const float ElapsedMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+		FCharacterAbilityStats& Stats = Ability->Stats;
+		Stats.NumTicks++;
+		Stats.LastTickMs = ElapsedMs;
+		Stats.TotalMs += ElapsedMs;
+
+		if (Ability->ShouldTick())
+		{
+			++AbilityIndex;
+		}
+		else
+		{
+			Stats.bTicking = false;
+			Group.TickingAbilities.RemoveAt(AbilityIndex, 1, EAllowShrinking::No);
+		}
+	}
+
+	if (Group.TickingAbilities.Num() == 0)
+	{
+		Group.TickFunction.SetTickFunctionEnable(false);
+	}
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CharacterAbility.h"
+#include "CharacterAbilityComponent.generated.h"
+
+class UCharacterAbilityComponent;
+
+/** Runs the ticking abilities of one tick group. Enabled only while at least one of them is active. */
+USTRUCT()
+struct FCharacterAbilityTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UCharacterAbilityComponent* Target = nullptr;
+
+	/** Index into the target's tick groups */
+	int32 GroupIndex = INDEX_NONE;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FCharacterAbilityTickFunction> : public TStructOpsTypeTraitsBase2<FCharacterAbilityTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Owns the character's movement abilities and schedules them. Each ability ticks in its own tick
+ * group, only while its activation conditions hold, so an idle character costs nothing per frame.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class LIQUIDX_TEST_SIMPLE_API UCharacterAbilityComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCharacterAbilityComponent();
+
+	/** Fire an ability's trigger. Returns false if the ability is not present or refused to activate. */
+	bool TryActivateAbility(TSubclassOf<UCharacterAbility> AbilityClass);
+
+	/** Release an ability's trigger */
+	void DeactivateAbility(TSubclassOf<UCharacterAbility> AbilityClass);
+
+	/** Re-evaluate ShouldTick() for every ability, e.g. after a movement mode change */
+	void RefreshAbilityTicks();
+
+	/** Start ticking Ability if its activation conditions now hold */
+	void RefreshAbilityTick(UCharacterAbility* Ability);
+
+	/** Seconds between ticks of every ability tick group, 0 for every frame; set by the character's significance */
+	void SetAbilityTickInterval(float TickInterval);
+
+	float GetAbilityTickInterval() const { return AbilityTickInterval; }
+
+	UCharacterAbility* FindAbility(TSubclassOf<UCharacterAbility> AbilityClass) const;
+
+	template<class T>
+	T* FindAbility() const
+	{
+		return Cast<T>(FindAbility(T::StaticClass()));
+	}
+
+	UFUNCTION(BlueprintPure, Category = "Ability")
+	TArray<FCharacterAbilityStats> GetAbilityStats() const;
+
+	/** Abilities created for this character when play begins */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability")
+	TArray<TSubclassOf<UCharacterAbility>> AbilityClasses;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	friend struct FCharacterAbilityTickFunction;
+
+	struct FAbilityTickGroup
+	{
+		FCharacterAbilityTickFunction TickFunction;
+		TArray<UCharacterAbility*> TickingAbilities;
+	};
+
+	FAbilityTickGroup& FindOrAddTickGroup(ETickingGroup Group);
+	void RunTickGroup(int32 GroupIndex, float DeltaTime);
+
+	UPROPERTY()
+	TArray<TObjectPtr<UCharacterAbility>> Abilities;
+
+	TArray<TUniquePtr<FAbilityTickGroup>> TickGroups;
+
+	float AbilityTickInterval = 0.0f;
+};
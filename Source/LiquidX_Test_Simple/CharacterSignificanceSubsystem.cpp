@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterSignificanceSubsystem.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "CharacterAbilityComponent.h"
+#include "CharacterAbilities.h"
+#include "InputRecordingSubsystem.h"
+#include "LiquidXStats.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCharacterSignificance, Log, All);
+
+void UCharacterSignificanceSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	Ranking.Empty();
+	ViewLocations.Empty();
+	ViewDirections.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCharacterSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCharacterSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UCharacterSignificanceSubsystem::RegisterCharacter(ALiquidX_Test_SimpleCharacter* Character)
+{
+	if (!Character || Entries.ContainsByPredicate([Character](const FSignificanceEntry& Entry) { return Entry.Character == Character; }))
+	{
+		return;
+	}
+
+	FSignificanceEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Character = Character;
+
+	// Redistribute right away so a wave of new characters doesn't run at full rate until the next update
+	TimeUntilUpdate = 0.0f;
+}
+
+void UCharacterSignificanceSubsystem::UnregisterCharacter(ALiquidX_Test_SimpleCharacter* Character)
+{
+	const int32 EntryIndex = Entries.IndexOfByPredicate([Character](const FSignificanceEntry& Entry) { return Entry.Character == Character; });
+	if (EntryIndex != INDEX_NONE)
+	{
+		Entries.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+		TimeUntilUpdate = 0.0f;
+	}
+}
+
+const FCharacterSignificanceSettings& UCharacterSignificanceSubsystem::GetSettings(ECharacterSignificance Significance) const
+{
+	switch (Significance)
+	{
+	case ECharacterSignificance::Medium:
+		return MediumSettings;
+	case ECharacterSignificance::Low:
+		return LowSettings;
+	default:
+		return HighSettings;
+	}
+}
+
+void UCharacterSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Entries.Num() == 0)
+	{
+		return;
+	}
+
+	UpdateBudgetScale();
+
+	TimeUntilUpdate -= DeltaTime;
+	if (TimeUntilUpdate > 0.0f)
+	{
+		return;
+	}
+	TimeUntilUpdate = UpdateInterval;
+
+	UpdateSignificance();
+}
+
+void UCharacterSignificanceSubsystem::UpdateBudgetScale()
+{
+	// Real frame time, not the dilated world delta
+	const float FrameMs = FApp::GetDeltaTime() * 1000.0f;
+	AverageFrameMs = AverageFrameMs > 0.0f ? FMath::Lerp(AverageFrameMs, FrameMs, 0.05f) : FrameMs;
+
+	if (TargetFrameMs <= 0.0f)
+	{
+		BudgetScale = 1.0f;
+		return;
+	}
+
+	// Shrink quickly while over the target, grow back slowly once comfortably under it
+	if (AverageFrameMs > TargetFrameMs * 1.05f)
+	{
+		BudgetScale *= 0.98f;
+	}
+	else if (AverageFrameMs < TargetFrameMs * 0.9f)
+	{
+		BudgetScale *= 1.005f;
+	}
+	BudgetScale = FMath::Clamp(BudgetScale, MinBudgetScale, 1.0f);
+}
+
+void UCharacterSignificanceSubsystem::UpdateSignificance()
+{
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_Significance);
+
+	ViewLocations.Reset();
+	ViewDirections.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+			ViewDirections.Add(ViewRotation.Vector());
+		}
+	}
+
+	// Rendering only tells something where there is a renderer
+	const bool bCheckRendered = FApp::CanEverRender() && !IsRunningDedicatedServer();
+
+	Ranking.Reset();
+	for (int32 EntryIndex = Entries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+	{
+		FSignificanceEntry& Entry = Entries[EntryIndex];
+		const ALiquidX_Test_SimpleCharacter* Character = Entry.Character.Get();
+		if (!Character)
+		{
+			Entries.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		// Player characters on the server (and replayed ones, which must stay deterministic) are never throttled
+		Entry.bAlwaysHigh = Character->IsLocallyControlled() || Character->IsPlayerControlled()
+			|| Cast<AInputReplayController>(Character->GetController()) != nullptr;
+		Entry.Score = Entry.bAlwaysHigh ? 1.0f : ScoreCharacter(*Character, bCheckRendered);
+	}
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		Ranking.Add(EntryIndex);
+	}
+	Ranking.Sort([this](int32 A, int32 B)
+	{
+		const FSignificanceEntry& EntryA = Entries[A];
+		const FSignificanceEntry& EntryB = Entries[B];
+		return EntryA.bAlwaysHigh != EntryB.bAlwaysHigh ? EntryA.bAlwaysHigh : EntryA.Score > EntryB.Score;
+	});
+
+	const int32 HighBudget = FMath::FloorToInt32(MaxHighSignificance * BudgetScale);
+	const int32 MediumBudget = FMath::FloorToInt32(MaxMediumSignificance * BudgetScale);
+	int32 NumHigh = 0;
+	int32 NumMedium = 0;
+	NumBySignificance[0] = NumBySignificance[1] = NumBySignificance[2] = 0;
+
+	// Best scores first, so a full budget demotes the least significant
+	for (const int32 EntryIndex : Ranking)
+	{
+		FSignificanceEntry& Entry = Entries[EntryIndex];
+
+		ECharacterSignificance Significance = ECharacterSignificance::Low;
+		if (Entry.bAlwaysHigh)
+		{
+			Significance = ECharacterSignificance::High;
+		}
+		else if (Entry.Score >= HighScore && NumHigh < HighBudget)
+		{
+			Significance = ECharacterSignificance::High;
+			++NumHigh;
+		}
+		else if (Entry.Score >= MediumScore && NumMedium < MediumBudget)
+		{
+			Significance = ECharacterSignificance::Medium;
+			++NumMedium;
+		}
+
+		++NumBySignificance[uint8(Significance)];
+
+		if (!Entry.bApplied || Significance != Entry.Significance)
+		{
+			Entry.Significance = Significance;
+			Entry.bApplied = true;
+			ApplySignificance(*Entry.Character.Get(), Significance);
+		}
+	}
+}
+
+float UCharacterSignificanceSubsystem::ScoreCharacter(const ALiquidX_Test_SimpleCharacter& Character, bool bCheckRendered) const
+{
+	// Without any viewer (e.g. a server with no players yet) everything is equally significant
+	if (ViewLocations.Num() == 0)
+	{
+		return 1.0f;
+	}
+
+	const FVector Location = Character.GetActorLocation();
+	const float ConeCos = FMath::Cos(FMath::DegreesToRadians(ViewConeHalfAngle));
+	const bool bRendered = !bCheckRendered || Character.WasRecentlyRendered(UpdateInterval + 0.1f);
+	const float FalloffRange = FMath::Max(MaxSignificanceDistance - FullSignificanceDistance, 1.0f);
+
+	float BestScore = 0.0f;
+	for (int32 ViewIndex = 0; ViewIndex < ViewLocations.Num(); ++ViewIndex)
+	{
+		const FVector ToCharacter = Location - ViewLocations[ViewIndex];
+		const float Distance = ToCharacter.Size();
+		float Score = 1.0f - FMath::Clamp((Distance - FullSignificanceDistance) / FalloffRange, 0.0f, 1.0f);
+
+		const bool bInCone = Distance <= UE_KINDA_SMALL_NUMBER
+			|| FVector::DotProduct(ToCharacter / Distance, ViewDirections[ViewIndex]) >= ConeCos;
+		if (!bInCone || !bRendered)
+		{
+			Score *= OffscreenScale;
+		}
+
+		BestScore = FMath::Max(BestScore, Score);
+	}
+	return BestScore;
+}
+
+void UCharacterSignificanceSubsystem::ApplySignificance(ALiquidX_Test_SimpleCharacter& Character, ECharacterSignificance Significance) const
+{
+	const FCharacterSignificanceSettings& Settings = GetSettings(Significance);
+
+	if (UCharacterAbilityComponent* Abilities = Character.GetAbilityComponent())
+	{
+		Abilities->SetAbilityTickInterval(Settings.AbilityTickInterval);
+
+		if (UWallRunAbility* WallRun = Abilities->FindAbility<UWallRunAbility>())
+		{
+			WallRun->SetProbeLOD(Settings.MinWallRunProbeInterval, Settings.bDebugDraw);
+		}
+	}
+
+	if (USkeletalMeshComponent* Mesh = Character.GetMesh())
+	{
+		Mesh->bEnableUpdateRateOptimizations = Settings.bAnimUpdateRateOptimizations;
+		Mesh->VisibilityBasedAnimTickOption = Settings.AnimTickOption;
+	}
+
+	Character.SetDebugDrawSignificant(Settings.bDebugDraw);
+}
+
+static void ReportSignificance(const TArray<FString>& Args, UWorld* World)
+{
+	if (const UCharacterSignificanceSubsystem* Significance = World ? World->GetSubsystem<UCharacterSignificanceSubsystem>() : nullptr)
+	{
+		UE_LOG(LogCharacterSignificance, Display, TEXT("Significance: %d high, %d medium, %d low, budget %.0f%%"),
+			Significance->GetNumCharacters(ECharacterSignificance::High),
+			Significance->GetNumCharacters(ECharacterSignificance::Medium),
+			Significance->GetNumCharacters(ECharacterSignificance::Low),
+			Significance->GetBudgetScale() * 100.0f);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReportSignificanceCommand(
+	TEXT("LiquidX.Significance.Report"),
+	TEXT("Log how many characters are at each significance level"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReportSignificance));
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "CharacterSignificanceSubsystem.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+
+UENUM(BlueprintType)
+enum class ECharacterSignificance : uint8
+{
+	/** Everything at full rate */
+	High,
+	/** Throttled abilities and wall probes, animation update rate optimizations */
+	Medium,
+	/** Heavily throttled, animation only while rendered, no debug draws */
+	Low
+};
+
+/** What a character at one significance level gets to spend */
+USTRUCT(BlueprintType)
+struct FCharacterSignificanceSettings
+{
+	GENERATED_BODY()
+
+	/** Seconds between ability ticks, 0 ticks every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance", meta = (ClampMin = "0"))
+	float AbilityTickInterval = 0.0f;
+
+	/** Fewest frames between async wall-run probes */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance", meta = (ClampMin = "1"))
+	int32 MinWallRunProbeInterval = 1;
+
+	/** Let the engine skip and interpolate animation updates by screen size */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance")
+	bool bAnimUpdateRateOptimizations = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance")
+	EVisibilityBasedAnimTickOption AnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
+	/** Draw this character's LiquidX.Debug.* traces */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance")
+	bool bDebugDraw = true;
+};
+
+/**
+ * Scores characters by distance to the nearest player view and whether they are in front of it,
+ * then hands out significance levels from a shared budget: the highest scores get High until
+ * MaxHighSignificance is used up, then Medium until MaxMediumSignificance, the rest Low. The
+ * budget is redistributed every UpdateInterval, so it follows the crowd as characters come and go,
+ * and with TargetFrameMs set it shrinks while frames run over that time and grows back after.
+ * Locally controlled characters and, on the server, player characters always stay High.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UCharacterSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterCharacter(ALiquidX_Test_SimpleCharacter* Character);
+	void UnregisterCharacter(ALiquidX_Test_SimpleCharacter* Character);
+
+	const FCharacterSignificanceSettings& GetSettings(ECharacterSignificance Significance) const;
+
+	UFUNCTION(BlueprintPure, Category = "Significance")
+	int32 GetNumCharacters(ECharacterSignificance Significance) const { return NumBySignificance[uint8(Significance)]; }
+
+	/** Fraction of MaxHighSignificance and MaxMediumSignificance currently handed out */
+	UFUNCTION(BlueprintPure, Category = "Significance")
+	float GetBudgetScale() const { return BudgetScale; }
+
+	/** Seconds between re-scoring and redistributing the budget */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = "0"))
+	float UpdateInterval = 0.25f;
+
+	/** Characters closer than this to a view score fully */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Score")
+	float FullSignificanceDistance = 1500.0f;
+
+	/** Characters further than this from every view score 0 */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Score")
+	float MaxSignificanceDistance = 8000.0f;
+
+	/** Half angle of the cone in front of a view that counts as on screen */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Score", meta = (ClampMin = "0", ClampMax = "180"))
+	float ViewConeHalfAngle = 60.0f;
+
+	/** Score multiplier for characters outside every view cone */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Score", meta = (ClampMin = "0", ClampMax = "1"))
+	float OffscreenScale = 0.25f;
+
+	/** Lowest score that qualifies for High, budget permitting */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Score")
+	float HighScore = 0.5f;
+
+	/** Lowest score that qualifies for Medium, budget permitting */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Score")
+	float MediumScore = 0.15f;
+
+	/** Characters that can be High at once, not counting the ones that always are */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Budget", meta = (ClampMin = "0"))
+	int32 MaxHighSignificance = 24;
+
+	/** Characters that can be Medium at once */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Budget", meta = (ClampMin = "0"))
+	int32 MaxMediumSignificance = 96;
+
+	/** Frame time the budget is scaled to hold, 0 keeps it fixed */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Budget", meta = (ClampMin = "0"))
+	float TargetFrameMs = 0.0f;
+
+	/** Smallest fraction of the budget TargetFrameMs can shrink it to */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Budget", meta = (ClampMin = "0", ClampMax = "1"))
+	float MinBudgetScale = 0.25f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Levels")
+	FCharacterSignificanceSettings HighSettings;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Levels")
+	FCharacterSignificanceSettings MediumSettings;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Significance|Levels")
+	FCharacterSignificanceSettings LowSettings;
+
+private:
+	struct FSignificanceEntry
+	{
+		TWeakObjectPtr<ALiquidX_Test_SimpleCharacter> Character;
+		float Score = 0.0f;
+		bool bAlwaysHigh = false;
+		ECharacterSignificance Significance = ECharacterSignificance::High;
+
+		/** Settings of Significance have been pushed to the character */
+		bool bApplied = false;
+	};
+
+	void UpdateSignificance();
+	void UpdateBudgetScale();
+	float ScoreCharacter(const ALiquidX_Test_SimpleCharacter& Character, bool bCheckRendered) const;
+	void ApplySignificance(ALiquidX_Test_SimpleCharacter& Character, ECharacterSignificance Significance) const;
+
+	TArray<FSignificanceEntry> Entries;
+
+	/** Entry indices, sorted by score on each update */
+	TArray<int32> Ranking;
+
+	TArray<FVector> ViewLocations;
+	TArray<FVector> ViewDirections;
+
+	float TimeUntilUpdate = 0.0f;
+	float BudgetScale = 1.0f;
+	float AverageFrameMs = 0.0f;
+	int32 NumBySignificance[3] = { 0, 0, 0 };
+};
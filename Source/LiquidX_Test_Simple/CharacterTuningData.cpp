@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CharacterTuningData.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCharacterTuning, Log, All);
+
+FOnCharacterTuningChanged UCharacterTuningData::OnTuningChanged;
+
+const UCharacterTuningData* UCharacterTuningData::GetCommandLineOverride()
+{
+	static const UCharacterTuningData* Override = []() -> const UCharacterTuningData*
+	{
+		FString AssetPath;
+		if (!FParse::Value(FCommandLine::Get(), TEXT("LiquidXTuning="), AssetPath))
+		{
+			return nullptr;
+		}
+
+		UCharacterTuningData* Loaded = LoadObject<UCharacterTuningData>(nullptr, *AssetPath);
+		if (!Loaded)
+		{
+			UE_LOG(LogCharacterTuning, Error, TEXT("-LiquidXTuning: no tuning asset at '%s'"), *AssetPath);
+			return nullptr;
+		}
+
+		// Outlives every world of the run
+		Loaded->AddToRoot();
+		UE_LOG(LogCharacterTuning, Display, TEXT("Character tuning overridden by %s"), *Loaded->GetPathName());
+		return Loaded;
+	}();
+	return Override;
+}
+
+#if WITH_EDITOR
+void UCharacterTuningData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Characters in PIE pick the new values up without a restart
+	OnTuningChanged.Broadcast(this);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// A/B sweeps
+
+static void ApplyTuning(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() < 1 || !World)
+	{
+		UE_LOG(LogCharacterTuning, Warning, TEXT("Usage: LiquidX.Tuning.Apply <AssetPath|None>"));
+		return;
+	}
+
+	UCharacterTuningData* TuningData = nullptr;
+	if (Args[0] != TEXT("None"))
+	{
+		TuningData = LoadObject<UCharacterTuningData>(nullptr, *Args[0]);
+		if (!TuningData)
+		{
+			UE_LOG(LogCharacterTuning, Warning, TEXT("No tuning asset at '%s'"), *Args[0]);
+			return;
+		}
+	}
+
+	int32 NumCharacters = 0;
+	for (TActorIterator<ALiquidX_Test_SimpleCharacter> It(World); It; ++It)
+	{
+		It->SetTuningData(TuningData);
+		++NumCharacters;
+	}
+
+	UE_LOG(LogCharacterTuning, Display, TEXT("Applied %s to %d characters"), *GetNameSafe(TuningData), NumCharacters);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ApplyTuningCommand(
+	TEXT("LiquidX.Tuning.Apply"),
+	TEXT("Give every character in this world the tuning asset at <AssetPath>, or None for their built-in defaults. Movement values are predicted, so apply the same asset on the server and every client."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ApplyTuning));
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CharacterTuningData.generated.h"
+
+/**
+ * Every movement and ability number of one character archetype. The character keeps a flat copy
+ * and reads it directly, so nothing on the hot path looks an asset up.
+ */
+USTRUCT(BlueprintType)
+struct FCharacterTuning
+{
+	GENERATED_BODY()
+
+	// Movement component
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float WalkSpeed = 500.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float MinAnalogWalkSpeed = 20.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float JumpZVelocity = 700.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float AirControl = 0.35f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float BrakingDecelerationWalking = 2000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float BrakingDecelerationFalling = 1500.0f;
+
+	/** Gravity scale whenever the jetpack is not firing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float GravityScale = 1.75f;
+
+	/** Max walk speed multiplier while sprinting on the ground */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float SprintSpeedMultiplier = 1.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+	float DoubleJumpForce = 700.0f;
+
+	// Wall run
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wall Run")
+	float WallRunSpeed = 800.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wall Run")
+	float WallRunDuration = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wall Run")
+	float WallCheckDistance = 60.0f;
+
+	/** How far ahead of the character the wall probes end */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Wall Run")
+	float WallRunForwardOffset = 50.0f;
+
+	// Jetpack
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Jetpack")
+	float JetpackForce = 1000.0f;
+
+	/** Gravity scale while the jetpack is firing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Jetpack")
+	float JetpackGravityScale = 0.1f;
+
+	/** Fuel capacity; characters start full */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Jetpack")
+	float MaxJetpackFuel = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Jetpack")
+	float JetpackFuelConsumptionRate = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Jetpack")
+	float JetpackFuelRefillRate = 5.0f;
+
+	// Cubes and interaction
+	/** Radius around the character searched for a cube to pick up */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float PickupRadius = 150.0f;
+
+	/** Distance in front of the hand a thrown cube is moved to before it is released */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float ThrowSpawnOffset = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float ThrowForce = 1000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float InteractionRange = 200.0f;
+
+	/** Half angle of the cone in front of the character that Interact and punches pick their target from */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction", meta = (ClampMin = "0", ClampMax = "180"))
+	float InteractionConeHalfAngle = 30.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float PunchForce = 500.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float PunchDamage = 10.0f;
+
+	/** Delay from the start of the punch montage to the hit */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float PunchAnimationDelay = 0.2f;
+
+	/** Punches hit every cube in the interaction cone instead of only the nearest one */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	bool bAreaPunch = false;
+};
+
+class UCharacterTuningData;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCharacterTuningChanged, const UCharacterTuningData*);
+
+/**
+ * Tuning for one character archetype. Characters copy it once when their components initialize
+ * and again only when it changes: after an edit in the editor, or when LiquidX.Tuning.Apply swaps
+ * assets at runtime. A -LiquidXTuning=<AssetPath> command line argument overrides every
+ * character's asset, so automated perf runs can sweep tunings without a rebuild.
+ */
+UCLASS(BlueprintType)
+class LIQUIDX_TEST_SIMPLE_API UCharacterTuningData : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tuning", meta = (ShowOnlyInnerProperties))
+	FCharacterTuning Tuning;
+
+	/** The -LiquidXTuning asset, loaded on first use; null when the argument is absent */
+	static const UCharacterTuningData* GetCommandLineOverride();
+
+	/** Fires when an asset's values change after characters have copied them */
+	static FOnCharacterTuningChanged OnTuningChanged;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
@@ -0,0 +1,334 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeDamageSubsystem.h"
+#include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "PickupCubeInstanceSubsystem.h"
+#include "InteractionIndexSubsystem.h"
+#include "CubeSettleSubsystem.h"
+#include "CubeMassSubsystem.h"
+#include "LiquidXStats.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCubeDamage, Log, All);
+
+void UCubeDamageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PendingEvents.Reserve(ReserveEvents);
+	ProcessingEvents.Reserve(ReserveEvents);
+	Targets.Reserve(ReserveEvents);
+	Healths.Reserve(ReserveEvents);
+	PendingDamage.Reserve(ReserveEvents);
+	PendingImpulses.Reserve(ReserveEvents);
+	TargetIndices.Reserve(ReserveEvents);
+	Notifies.Reserve(ReserveEvents);
+}
+
+void UCubeDamageSubsystem::Deinitialize()
+{
+	PendingEvents.Empty();
+	ProcessingEvents.Empty();
+	Targets.Empty();
+	Healths.Empty();
+	PendingDamage.Empty();
+	PendingImpulses.Empty();
+	TargetIndices.Empty();
+	Notifies.Empty();
+	PendingReleases.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCubeDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCubeDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UCubeDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingEvents.Num() == 0 && PendingReleases.Num() == 0)
+	{
+		return;
+	}
+
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_DamageFlush);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// Anything queued by OnHealthChanged handlers during the pass lands in next frame's queue
+	Swap(PendingEvents, ProcessingEvents);
+	LastNumEvents = ProcessingEvents.Num();
+
+	GatherTargets();
+	ApplyDamage();
+	NotifyDamage();
+	LastNumCubesDamaged = Targets.Num();
+	LIQUIDX_INC_STAT_BY(STAT_LiquidX_DamageEvents, LastNumEvents);
+	LIQUIDX_INC_STAT_BY(STAT_LiquidX_CubesDamaged, LastNumCubesDamaged);
+
+	ProcessingEvents.Reset();
+	Targets.Reset();
+	Healths.Reset();
+	PendingDamage.Reset();
+	PendingImpulses.Reset();
+	TargetIndices.Reset();
+	Notifies.Reset();
+
+	ReleaseDeadCubes();
+
+	LastFlushMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+}
+
+bool UCubeDamageSubsystem::CanQueue() const
+{
+	// Health is server authoritative; clients see the result through replication
+	return GetWorld()->GetNetMode() != NM_Client;
+}
+
+void UCubeDamageSubsystem::QueueDamage(APickupCube* Cube, float Damage, FVector Impulse, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (!CanQueue() || !IsValid(Cube))
+	{
+		return;
+	}
+
+	FQueuedDamage& Event = PendingEvents.AddDefaulted_GetRef();
+	Event.Shape = EDamageShape::Single;
+	Event.Cube = Cube;
+	Event.Direction = Impulse;
+	Event.Damage = Damage;
+	Event.Instigator = EventInstigator;
+	Event.DamageCauser = DamageCauser;
+}
+
+void UCubeDamageSubsystem::QueueRadialDamage(const FVector& Origin, float Radius, float Damage, float ImpulseStrength, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (!CanQueue() || Radius <= 0.0f)
+	{
+		return;
+	}
+
+	FQueuedDamage& Event = PendingEvents.AddDefaulted_GetRef();
+	Event.Shape = EDamageShape::Radial;
+	Event.Origin = Origin;
+	Event.Radius = Radius;
+	Event.Damage = Damage;
+	Event.ImpulseStrength = ImpulseStrength;
+	Event.Instigator = EventInstigator;
+	Event.DamageCauser = DamageCauser;
+}
+
+void UCubeDamageSubsystem::QueueConeDamage(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees, float Damage, float ImpulseStrength, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (!CanQueue() || Range <= 0.0f)
+	{
+		return;
+	}
+
+	FQueuedDamage& Event = PendingEvents.AddDefaulted_GetRef();
+	Event.Shape = EDamageShape::Cone;
+	Event.Origin = Origin;
+	Event.Direction = Direction.GetSafeNormal();
+	Event.Radius = Range;
+	Event.CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.0f, 180.0f)));
+	Event.Damage = Damage;
+	Event.ImpulseStrength = ImpulseStrength;
+	Event.Instigator = EventInstigator;
+	Event.DamageCauser = DamageCauser;
+}
+
+void UCubeDamageSubsystem::QueueRelease(APickupCube* Cube)
+{
+	if (IsValid(Cube))
+	{
+		PendingReleases.Add(Cube);
+	}
+}
+
+void UCubeDamageSubsystem::GatherTargets()
+{
+	const UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>();
+	UPickupCubeInstanceSubsystem* Instancing = bPromoteInstancedCubes ? GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>() : nullptr;
+	UCubeMassSubsystem* CubeMass = GetWorld()->GetSubsystem<UCubeMassSubsystem>();
+
+	for (const FQueuedDamage& Event : ProcessingEvents)
+	{
+		if (Event.Shape == EDamageShape::Single)
+		{
+			if (APickupCube* Cube = Event.Cube.Get())
+			{
+				AddTarget(Cube, Event.Damage, Event.Direction, Event);
+			}
+			continue;
+		}
+
+		// Debris-field entities take area damage in place; only single-target hits promote them
+		if (CubeMass)
+		{
+			CubeMass->ApplyAreaDamage(Event.Origin, Event.Direction, Event.Radius, Event.CosHalfAngle, Event.Damage, Event.ImpulseStrength);
+		}
+
+		if (!InteractionIndex)
+		{
+			continue;
+		}
+
+		if (Instancing)
+		{
+			// Instanced cubes aren't in the index; promote the ones the shape can reach so they register
+			PromotedCubes.Reset();
+			if (Event.Shape == EDamageShape::Cone && Event.CosHalfAngle > 0.0f)
+			{
+				const float ConeRadius = Event.Radius * FMath::Sqrt(1.0f - FMath::Square(Event.CosHalfAngle));
+				Instancing->PromoteAlongSegment(Event.Origin, Event.Origin + Event.Direction * Event.Radius, ConeRadius, PromotedCubes);
+			}
+			else
+			{
+				Instancing->PromoteInRadius(Event.Origin, Event.Radius, PromotedCubes);
+			}
+		}
+
+		QueryResults.Reset();
+		InteractionIndex->QueryRadius(Event.Origin, Event.Radius, APickupCube::StaticClass(), QueryResults);
+
+		for (AActor* Actor : QueryResults)
+		{
+			APickupCube* Cube = static_cast<APickupCube*>(Actor);
+			const FVector ToCube = Cube->GetActorLocation() - Event.Origin;
+
+			if (Event.Shape == EDamageShape::Cone && (ToCube | Event.Direction) < Event.CosHalfAngle * ToCube.Size())
+			{
+				continue;
+			}
+
+			AddTarget(Cube, Event.Damage, ToCube.GetSafeNormal() * Event.ImpulseStrength, Event);
+		}
+	}
+}
+
+void UCubeDamageSubsystem::AddTarget(APickupCube* Cube, float Damage, const FVector& Impulse, const FQueuedDamage& Event)
+{
+	if (Cube->IsInPool())
+	{
+		return;
+	}
+
+	FDamageNotify& Notify = Notifies.AddDefaulted_GetRef();
+	Notify.Cube = Cube;
+	Notify.Damage = Damage;
+	Notify.Instigator = Event.Instigator.Get();
+	Notify.DamageCauser = Event.DamageCauser.Get();
+
+	if (const int32* ExistingIndex = TargetIndices.Find(Cube))
+	{
+		PendingDamage[*ExistingIndex] += Damage;
+		PendingImpulses[*ExistingIndex] += Impulse;
+		return;
+	}
+
+	TargetIndices.Add(Cube, Targets.Num());
+	Targets.Add(Cube);
+	Healths.Add(Cube->GetHealth());
+	PendingDamage.Add(Damage);
+	PendingImpulses.Add(Impulse);
+}
+
+void UCubeDamageSubsystem::ApplyDamage()
+{
+	const int32 NumTargets = Targets.Num();
+
+	for (int32 Index = 0; Index < NumTargets; ++Index)
+	{
+		Healths[Index] = FMath::Max(0.0f, Healths[Index] - PendingDamage[Index]);
+	}
+
+	UCubeSettleSubsystem* Settle = GetWorld()->GetSubsystem<UCubeSettleSubsystem>();
+
+	for (int32 Index = 0; Index < NumTargets; ++Index)
+	{
+		APickupCube* Cube = Targets[Index];
+
+		if (PendingDamage[Index] > 0.0f)
+		{
+			Cube->SetCurrentHealth(Healths[Index]);
+		}
+
+		if (Healths[Index] <= 0.0f)
+		{
+			PendingReleases.Add(Cube);
+			continue;
+		}
+
+		if (!PendingImpulses[Index].IsNearlyZero() && !Cube->IsHeld())
+		{
+			if (Settle)
+			{
+				Settle->AddSimulatingCube(Cube);
+			}
+			else
+			{
+				Cube->GetStaticMeshComponent()->SetSimulatePhysics(true);
+			}
+			Cube->GetStaticMeshComponent()->AddImpulse(PendingImpulses[Index]);
+		}
+	}
+}
+
+void UCubeDamageSubsystem::NotifyDamage()
+{
+	// Dead cubes are only released after this; a handler destroying one skips its remaining hits
+	for (const FDamageNotify& Notify : Notifies)
+	{
+		if (IsValid(Notify.Cube))
+		{
+			Notify.Cube->NotifyDamageTaken(Notify.Damage, Notify.Instigator, Notify.DamageCauser);
+		}
+	}
+}
+
+void UCubeDamageSubsystem::ReleaseDeadCubes()
+{
+	UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>();
+
+	for (const TWeakObjectPtr<APickupCube>& CubePtr : PendingReleases)
+	{
+		// The same cube can be queued twice in a frame; the first release wins
+		APickupCube* Cube = CubePtr.Get();
+		if (!Cube || Cube->IsInPool())
+		{
+			continue;
+		}
+
+		if (CubePool)
+		{
+			CubePool->ReleaseCube(Cube);
+		}
+		else
+		{
+			Cube->Destroy();
+		}
+	}
+
+	PendingReleases.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void ReportCubeDamage(const TArray<FString>& Args, UWorld* World)
+{
+	if (const UCubeDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UCubeDamageSubsystem>() : nullptr)
+	{
+		UE_LOG(LogCubeDamage, Display, TEXT("CubeDamage: last flush events=%d cubes=%d ms=%.3f pending=%d"),
+			DamageSubsystem->GetLastNumEvents(), DamageSubsystem->GetLastNumCubesDamaged(), DamageSubsystem->GetLastFlushMs(), DamageSubsystem->GetNumPendingEvents());
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReportCubeDamageCommand(
+	TEXT("LiquidX.Damage.Report"),
+	TEXT("Log the event count, cube count and cost of the last damage flush"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReportCubeDamage));
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CubeDamageSubsystem.generated.h"
+
+class APickupCube;
+class AController;
+
+/**
+ * Server-side damage queue for pickup cubes. Single-target, radial and cone damage is collected
+ * during the frame and applied in one pass when the subsystem ticks, after actor ticks: events are
+ * resolved to cubes, summed per cube into a contiguous health array, written back once per cube,
+ * and cubes that reached zero are handed back to the pool at the end of the pass. A cube hit by a
+ * hundred events in a frame replicates and broadcasts its health once. Each event still reaches
+ * the cube's OnTakeAnyDamage and the instigator, as TakeDamage would have, after the write back.
+ *
+ * The LiquidX.Damage automation tests flush 10k events; LiquidX.Damage.Report logs the cost of the
+ * last flush in a running game.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UCubeDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Damage one cube; Impulse is applied to it if it survives */
+	UFUNCTION(BlueprintCallable, Category = "Damage")
+	void QueueDamage(APickupCube* Cube, float Damage, FVector Impulse = FVector::ZeroVector, AController* EventInstigator = nullptr, AActor* DamageCauser = nullptr);
+
+	/** Damage every loose cube within Radius of Origin, pushing survivors away from Origin with ImpulseStrength */
+	UFUNCTION(BlueprintCallable, Category = "Damage")
+	void QueueRadialDamage(const FVector& Origin, float Radius, float Damage, float ImpulseStrength = 0.0f, AController* EventInstigator = nullptr, AActor* DamageCauser = nullptr);
+
+	/** Damage every loose cube within Range of Origin and HalfAngleDegrees of Direction */
+	UFUNCTION(BlueprintCallable, Category = "Damage")
+	void QueueConeDamage(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees, float Damage, float ImpulseStrength = 0.0f, AController* EventInstigator = nullptr, AActor* DamageCauser = nullptr);
+
+	/** Return a dead cube to the pool at the end of this frame's pass instead of mid-frame */
+	void QueueRelease(APickupCube* Cube);
+
+	UFUNCTION(BlueprintPure, Category = "Damage")
+	int32 GetNumPendingEvents() const { return PendingEvents.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Damage")
+	int32 GetLastNumEvents() const { return LastNumEvents; }
+
+	UFUNCTION(BlueprintPure, Category = "Damage")
+	int32 GetLastNumCubesDamaged() const { return LastNumCubesDamaged; }
+
+	UFUNCTION(BlueprintPure, Category = "Damage")
+	float GetLastFlushMs() const { return LastFlushMs; }
+
+	/** Expected events per frame; the queue and per-cube arrays are reserved to this once */
+	UPROPERTY(Config, EditAnywhere, Category = "Damage", meta = (ClampMin = "0"))
+	int32 ReserveEvents = 1024;
+
+	/** Promote instanced cubes inside radial and cone shapes so they take damage too */
+	UPROPERTY(Config, EditAnywhere, Category = "Damage")
+	bool bPromoteInstancedCubes = true;
+
+private:
+	enum class EDamageShape : uint8
+	{
+		Single,
+		Radial,
+		Cone
+	};
+
+	struct FQueuedDamage
+	{
+		TWeakObjectPtr<APickupCube> Cube;
+		FVector Origin = FVector::ZeroVector;
+		/** Impulse for Single, unit direction for Cone */
+		FVector Direction = FVector::ZeroVector;
+		float Radius = 0.0f;
+		float CosHalfAngle = -1.0f;
+		float Damage = 0.0f;
+		float ImpulseStrength = 0.0f;
+		EDamageShape Shape = EDamageShape::Single;
+		TWeakObjectPtr<AController> Instigator;
+		TWeakObjectPtr<AActor> DamageCauser;
+	};
+
+	/** One event's hit on one cube, for the damage notifications sent after the write back */
+	struct FDamageNotify
+	{
+		APickupCube* Cube = nullptr;
+		float Damage = 0.0f;
+		AController* Instigator = nullptr;
+		AActor* DamageCauser = nullptr;
+	};
+
+	bool CanQueue() const;
+
+	/** Resolve ProcessingEvents into the per-cube arrays below */
+	void GatherTargets();
+	void AddTarget(APickupCube* Cube, float Damage, const FVector& Impulse, const FQueuedDamage& Event);
+
+	/** Subtract the summed damage, write health back, then start survivors moving and queue the dead */
+	void ApplyDamage();
+
+	/** Send every hit's OnTakeAnyDamage and instigator notification */
+	void NotifyDamage();
+	void ReleaseDeadCubes();
+
+	TArray<FQueuedDamage> PendingEvents;
+	TArray<FQueuedDamage> ProcessingEvents;
+
+	// Per-cube state for one pass, index-aligned
+	TArray<APickupCube*> Targets;
+	TArray<float> Healths;
+	TArray<float> PendingDamage;
+	TArray<FVector> PendingImpulses;
+	TMap<APickupCube*, int32> TargetIndices;
+	TArray<FDamageNotify> Notifies;
+
+	TArray<TWeakObjectPtr<APickupCube>> PendingReleases;
+
+	// Scratch for shape queries, kept to avoid reallocating every event
+	TArray<AActor*> QueryResults;
+	TArray<APickupCube*> PromotedCubes;
+
+	int32 LastNumEvents = 0;
+	int32 LastNumCubesDamaged = 0;
+	float LastFlushMs = 0.0f;
+};
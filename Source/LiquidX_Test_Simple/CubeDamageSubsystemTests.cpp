@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeDamageSubsystem.h"
+#include "PickupCube.h"
+#include "LiquidXTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CubeDamageTests
+{
+	constexpr int32 NumCubes = 256;
+	constexpr int32 NumEvents = 10000;
+
+	/** A 16 x 16 grid of cubes, 200 units apart */
+	static TArray<APickupCube*> SpawnCubes(UWorld* World)
+	{
+		TArray<APickupCube*> Cubes;
+		for (int32 Index = 0; Index < NumCubes; ++Index)
+		{
+			const FVector Location(Index % 16 * 200.0f, Index / 16 * 200.0f, 0.0f);
+			if (APickupCube* Cube = World->SpawnActor<APickupCube>(Location, FRotator::ZeroRotator))
+			{
+				Cubes.Add(Cube);
+			}
+		}
+		return Cubes;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCubeDamageSingleTargetTest, "LiquidX.Damage.SingleTarget",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/** 10k single-target events are summed per cube and written back in one flush */
+bool FCubeDamageSingleTargetTest::RunTest(const FString& Parameters)
+{
+	using namespace CubeDamageTests;
+
+	FLiquidXTestWorld TestWorld;
+	UWorld* World = TestWorld.Get();
+	UCubeDamageSubsystem* DamageSubsystem = World->GetSubsystem<UCubeDamageSubsystem>();
+	if (!TestNotNull(TEXT("Damage subsystem"), DamageSubsystem))
+	{
+		return false;
+	}
+
+	const TArray<APickupCube*> Cubes = SpawnCubes(World);
+	TestEqual(TEXT("Spawned cubes"), Cubes.Num(), NumCubes);
+
+	constexpr float Damage = 0.01f;
+	for (int32 Index = 0; Index < NumEvents; ++Index)
+	{
+		DamageSubsystem->QueueDamage(Cubes[Index % Cubes.Num()], Damage);
+	}
+	TestEqual(TEXT("Events pending before the flush"), DamageSubsystem->GetNumPendingEvents(), NumEvents);
+
+	TestWorld.Tick(1);
+
+	TestEqual(TEXT("Events in the flush"), DamageSubsystem->GetLastNumEvents(), NumEvents);
+	TestEqual(TEXT("Cubes damaged"), DamageSubsystem->GetLastNumCubesDamaged(), Cubes.Num());
+	TestEqual(TEXT("Events pending after the flush"), DamageSubsystem->GetNumPendingEvents(), 0);
+
+	for (int32 Index = 0; Index < Cubes.Num(); ++Index)
+	{
+		const int32 NumHits = NumEvents / Cubes.Num() + (Index < NumEvents % Cubes.Num() ? 1 : 0);
+		if (!TestEqual(TEXT("Health after the summed hits"), Cubes[Index]->GetHealth(), Cubes[Index]->GetMaxHealth() - NumHits * Damage, 0.001f))
+		{
+			break;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCubeDamageStressTest, "LiquidX.Damage.Stress",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/** 10k mixed single-target and radial events in one frame; logs the cost of the flush */
+bool FCubeDamageStressTest::RunTest(const FString& Parameters)
+{
+	using namespace CubeDamageTests;
+
+	FLiquidXTestWorld TestWorld;
+	UWorld* World = TestWorld.Get();
+	UCubeDamageSubsystem* DamageSubsystem = World->GetSubsystem<UCubeDamageSubsystem>();
+	if (!TestNotNull(TEXT("Damage subsystem"), DamageSubsystem))
+	{
+		return false;
+	}
+
+	const TArray<APickupCube*> Cubes = SpawnCubes(World);
+	TestEqual(TEXT("Spawned cubes"), Cubes.Num(), NumCubes);
+
+	// Every 16th event radial, as a burst of explosions among the punches
+	for (int32 Index = 0; Index < NumEvents; ++Index)
+	{
+		APickupCube* Cube = Cubes[Index % Cubes.Num()];
+		if (Index % 16 == 0)
+		{
+			DamageSubsystem->QueueRadialDamage(Cube->GetActorLocation(), 300.0f, 0.01f);
+		}
+		else
+		{
+			DamageSubsystem->QueueDamage(Cube, 0.01f);
+		}
+	}
+
+	TestWorld.Tick(1);
+
+	TestEqual(TEXT("Events in the flush"), DamageSubsystem->GetLastNumEvents(), NumEvents);
+	TestEqual(TEXT("Cubes damaged"), DamageSubsystem->GetLastNumCubesDamaged(), Cubes.Num());
+
+	int32 NumAlive = 0;
+	for (const APickupCube* Cube : Cubes)
+	{
+		NumAlive += !Cube->IsInPool() && Cube->GetHealth() > 0.0f ? 1 : 0;
+	}
+	TestEqual(TEXT("Cubes alive after chip damage"), NumAlive, Cubes.Num());
+
+	AddInfo(FString::Printf(TEXT("%d events over %d cubes flushed in %.3f ms"), DamageSubsystem->GetLastNumEvents(), DamageSubsystem->GetLastNumCubesDamaged(), DamageSubsystem->GetLastFlushMs()));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeHealthBarSubsystem.h"
+#include "PickupCube.h"
+#include "Components/WidgetComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Canvas.h"
+#include "Engine/World.h"
+#include "GameFramework/HUD.h"
+#include "GameFramework/PlayerController.h"
+
+bool UCubeHealthBarSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Nobody looks at a dedicated server
+	return Super::ShouldCreateSubsystem(Outer) && !IsRunningDedicatedServer();
+}
+
+void UCubeHealthBarSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostRenderHandle = AHUD::OnHUDPostRender.AddUObject(this, &UCubeHealthBarSubsystem::DrawBars);
+}
+
+void UCubeHealthBarSubsystem::Deinitialize()
+{
+	AHUD::OnHUDPostRender.Remove(PostRenderHandle);
+	Bars.Empty();
+	BarIndices.Empty();
+	VisibleBars.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCubeHealthBarSubsystem::RegisterCube(APickupCube* Cube)
+{
+	if (!IsValid(Cube))
+	{
+		return;
+	}
+
+	if (bHideWidgetComponents)
+	{
+		TInlineComponentArray<UWidgetComponent*> Widgets(Cube);
+		for (UWidgetComponent* Widget : Widgets)
+		{
+			Widget->SetVisibility(false);
+			Widget->SetComponentTickEnabled(false);
+		}
+	}
+
+	Cube->OnHealthChanged.AddUniqueDynamic(this, &UCubeHealthBarSubsystem::HandleHealthChanged);
+
+	// Late joiners and promoted cubes can already be damaged
+	HandleHealthChanged(Cube, Cube->GetHealth());
+}
+
+void UCubeHealthBarSubsystem::UnregisterCube(APickupCube* Cube)
+{
+	if (Cube)
+	{
+		Cube->OnHealthChanged.RemoveDynamic(this, &UCubeHealthBarSubsystem::HandleHealthChanged);
+		RemoveBar(Cube);
+	}
+}
+
+void UCubeHealthBarSubsystem::HandleHealthChanged(APickupCube* Cube, float NewHealth)
+{
+	const float MaxHealth = Cube->GetMaxHealth();
+	const float Fraction = MaxHealth > 0.0f ? NewHealth / MaxHealth : 0.0f;
+
+	// Full cubes show no bar and dead ones are about to be recycled
+	if (Fraction >= 1.0f || Fraction <= 0.0f)
+	{
+		RemoveBar(Cube);
+		return;
+	}
+
+	if (const int32* BarIndex = BarIndices.Find(Cube))
+	{
+		Bars[*BarIndex].Fraction = Fraction;
+		return;
+	}
+
+	BarIndices.Add(Cube, Bars.Num());
+	FHealthBar& Bar = Bars.AddDefaulted_GetRef();
+	Bar.Cube = Cube;
+	Bar.Fraction = Fraction;
+}
+
+void UCubeHealthBarSubsystem::RemoveBar(APickupCube* Cube)
+{
+	int32 BarIndex = INDEX_NONE;
+	if (!BarIndices.RemoveAndCopyValue(Cube, BarIndex))
+	{
+		return;
+	}
+
+	Bars.RemoveAtSwap(BarIndex, 1, EAllowShrinking::No);
+	if (Bars.IsValidIndex(BarIndex))
+	{
+		BarIndices.Add(Bars[BarIndex].Cube, BarIndex);
+	}
+}
+
+void UCubeHealthBarSubsystem::DrawBars(AHUD* HUD, UCanvas* Canvas)
+{
+	NumDrawnBars = 0;
+	if (!HUD || !Canvas || HUD->GetWorld() != GetWorld() || Bars.Num() == 0)
+	{
+		return;
+	}
+
+	const APlayerController* PlayerController = HUD->GetOwningPlayerController();
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+	{
+		return;
+	}
+
+	const FVector CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	const FRotationMatrix CameraAxes(PlayerController->PlayerCameraManager->GetCameraRotation());
+	const FVector CameraForward = CameraAxes.GetScaledAxis(EAxis::X);
+	const FVector HalfBar = CameraAxes.GetScaledAxis(EAxis::Y) * (BarWorldWidth * 0.5f);
+	const float MaxDistanceSq = FMath::Square(MaxDrawDistance);
+
+	VisibleBars.Reset();
+	for (const FHealthBar& Bar : Bars)
+	{
+		const APickupCube* Cube = Bar.Cube.Get();
+		if (!Cube || Cube->IsInPool() || Cube->IsHidden())
+		{
+			continue;
+		}
+
+		const FVector BarLocation = Cube->GetActorLocation() + FVector(0.0f, 0.0f, HeightOffset);
+		const FVector ToBar = BarLocation - CameraLocation;
+		const float DistanceSq = ToBar.SizeSquared();
+		if (DistanceSq > MaxDistanceSq || (ToBar | CameraForward) <= 0.0f)
+		{
+			continue;
+		}
+
+		const FVector Left = Canvas->Project(BarLocation - HalfBar);
+		const FVector Right = Canvas->Project(BarLocation + HalfBar);
+		const float Width = Right.X - Left.X;
+		if (Width < MinScreenWidth)
+		{
+			continue;
+		}
+
+		FVisibleBar& Visible = VisibleBars.AddDefaulted_GetRef();
+		Visible.Position = FVector2D(Left.X, Left.Y);
+		Visible.Width = Width;
+		Visible.Fraction = Bar.Fraction;
+		Visible.DistanceSq = DistanceSq;
+	}
+
+	if (VisibleBars.Num() > MaxBars)
+	{
+		VisibleBars.Sort([](const FVisibleBar& A, const FVisibleBar& B) { return A.DistanceSq < B.DistanceSq; });
+		VisibleBars.SetNum(MaxBars, EAllowShrinking::No);
+	}
+
+	// Same texture and blend mode for every tile, so the canvas batches them into one draw
+	for (const FVisibleBar& Visible : VisibleBars)
+	{
+		const float Height = FMath::Max(2.0f, Visible.Width * BarHeightRatio);
+		const float Top = Visible.Position.Y - Height * 0.5f;
+
+		Canvas->SetDrawColor(BackgroundColor);
+		Canvas->DrawTile(Canvas->DefaultTexture, Visible.Position.X, Top, Visible.Width, Height, 0.0f, 0.0f, 1.0f, 1.0f);
+		Canvas->SetDrawColor(FillColor);
+		Canvas->DrawTile(Canvas->DefaultTexture, Visible.Position.X, Top, Visible.Width * Visible.Fraction, Height, 0.0f, 0.0f, 1.0f, 1.0f);
+	}
+
+	NumDrawnBars = VisibleBars.Num();
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CubeHealthBarSubsystem.generated.h"
+
+class AHUD;
+class APickupCube;
+class UCanvas;
+
+/**
+ * Draws cube health bars in one screen-space canvas pass after the HUD, replacing the per-cube
+ * W_CubeHP widget components. Only damaged cubes have a bar; the fill comes from the cube's
+ * OnHealthChanged event and is not polled. Each frame the nearest MaxBars bars within MaxDrawDistance
+ * and at least MinScreenWidth pixels wide are drawn as tiles of one texture, which the canvas
+ * batches into a single draw.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UCubeHealthBarSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Follow Cube's health and take over from its widget components. Called by the cube in BeginPlay. */
+	void RegisterCube(APickupCube* Cube);
+	void UnregisterCube(APickupCube* Cube);
+
+	/** Cubes below full health, whether or not they were drawn */
+	UFUNCTION(BlueprintPure, Category = "Health Bars")
+	int32 GetNumDamagedCubes() const { return Bars.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Health Bars")
+	int32 GetNumDrawnBars() const { return NumDrawnBars; }
+
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	float MaxDrawDistance = 3000.0f;
+
+	/** Bars that would be narrower than this on screen are skipped */
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	float MinScreenWidth = 12.0f;
+
+	/** Upper bound on bars drawn per frame; the nearest win */
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars", meta = (ClampMin = "0"))
+	int32 MaxBars = 64;
+
+	/** Width of a bar in world units at the cube's distance */
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	float BarWorldWidth = 100.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	float BarHeightRatio = 0.12f;
+
+	/** Height of the bar above the cube's origin */
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	float HeightOffset = 80.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	FColor FillColor = FColor(40, 220, 60);
+
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	FColor BackgroundColor = FColor(0, 0, 0, 160);
+
+	/** Hide and stop ticking widget components (W_CubeHP) on registered cubes */
+	UPROPERTY(Config, EditAnywhere, Category = "Health Bars")
+	bool bHideWidgetComponents = true;
+
+private:
+	struct FHealthBar
+	{
+		TWeakObjectPtr<APickupCube> Cube;
+		float Fraction = 1.0f;
+	};
+
+	struct FVisibleBar
+	{
+		FVector2D Position;
+		float Width = 0.0f;
+		float Fraction = 1.0f;
+		float DistanceSq = 0.0f;
+	};
+
+	UFUNCTION()
+	void HandleHealthChanged(APickupCube* Cube, float NewHealth);
+
+	void RemoveBar(APickupCube* Cube);
+	void DrawBars(AHUD* HUD, UCanvas* Canvas);
+
+	TArray<FHealthBar> Bars;
+	TMap<TWeakObjectPtr<APickupCube>, int32> BarIndices;
+	TArray<FVisibleBar> VisibleBars;
+	FDelegateHandle PostRenderHandle;
+	int32 NumDrawnBars = 0;
+};
@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeHealthEffectSubsystem.h"
+#include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "CubeDamageSubsystem.h"
+#include "LiquidXStats.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCubeHealthEffects, Log, All);
+
+void UCubeHealthEffectSubsystem::Deinitialize()
+{
+	Effects.Empty();
+	CubeDeltas.Empty();
+	TouchedCubes.Empty();
+	TouchedIndices.Empty();
+	HealthWrites.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCubeHealthEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCubeHealthEffectSubsystem, STATGROUP_Tickables);
+}
+
+void UCubeHealthEffectSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Effects.Num() == 0)
+	{
+		return;
+	}
+
+	const UCubeStateSubsystem* CubeState = GetWorld()->GetSubsystem<UCubeStateSubsystem>();
+	if (!CubeState)
+	{
+		return;
+	}
+
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_HealthEffects);
+	EvaluateEffects(Effects, CubeState->GetStore(), DeltaTime, EffectsPerTask, bParallelEvaluate);
+	ApplyEffects();
+}
+
+void UCubeHealthEffectSubsystem::AddEffect(APickupCube* Cube, ECubeHealthEffectType Type, float Rate, float Duration)
+{
+	// Health is server authoritative; clients see the result through replication
+	if (!IsValid(Cube) || !Cube->HasAuthority() || !Cube->GetStateHandle().IsSet())
+	{
+		return;
+	}
+
+	FEffect& Effect = Effects.AddDefaulted_GetRef();
+	Effect.Cube = Cube->GetStateHandle();
+	Effect.Type = Type;
+	Effect.Rate = Rate;
+	Effect.Remaining = Duration > 0.0f ? Duration : TNumericLimits<float>::Max();
+
+	// Instancing would pool the actor, and pooled cubes lose their effects
+	Cube->SetStateFlag(ECubeStateFlags::HealthEffects, true);
+}
+
+void UCubeHealthEffectSubsystem::ClearEffects(APickupCube* Cube)
+{
+	if (Cube)
+	{
+		const FCubeHandle Handle = Cube->GetStateHandle();
+		Effects.RemoveAllSwap([&Handle](const FEffect& Effect) { return Effect.Cube == Handle; });
+		Cube->SetStateFlag(ECubeStateFlags::HealthEffects, false);
+	}
+}
+
+void UCubeHealthEffectSubsystem::EvaluateEffects(TArrayView<FEffect> InEffects, const FCubeStateStore& Store, float DeltaTime, int32 InEffectsPerTask, bool bParallel)
+{
+	const int32 NumEffects = InEffects.Num();
+	const int32 ChunkSize = FMath::Max(1, InEffectsPerTask);
+	const int32 NumTasks = FMath::DivideAndRoundUp(NumEffects, ChunkSize);
+
+	// Each task reads the store and writes only its own records, so there is nothing to lock
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		const int32 First = TaskIndex * ChunkSize;
+		const int32 Last = FMath::Min(First + ChunkSize, NumEffects);
+
+		for (int32 Index = First; Index < Last; ++Index)
+		{
+			FEffect& Effect = InEffects[Index];
+			Effect.Delta = 0.0f;
+			Effect.DenseIndex = Store.GetDenseIndex(Effect.Cube);
+
+			// Gone or pooled: the effect ends with the cube
+			if (Effect.DenseIndex == INDEX_NONE || EnumHasAnyFlags(Store.Flags[Effect.DenseIndex], ECubeStateFlags::InPool))
+			{
+				Effect.DenseIndex = INDEX_NONE;
+				continue;
+			}
+
+			const float Step = FMath::Min(DeltaTime, Effect.Remaining);
+			Effect.Remaining -= Step;
+
+			switch (Effect.Type)
+			{
+			case ECubeHealthEffectType::Burn:
+				Effect.Delta = -Effect.Rate * Step;
+				break;
+			case ECubeHealthEffectType::Regen:
+				Effect.Delta = Effect.Rate * Step;
+				break;
+			case ECubeHealthEffectType::Decay:
+				Effect.Delta = -Store.Healths[Effect.DenseIndex] * (1.0f - FMath::Exp(-Effect.Rate * Step));
+				break;
+			}
+		}
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+void UCubeHealthEffectSubsystem::ApplyEffects()
+{
+	const FCubeStateStore& Store = GetWorld()->GetSubsystem<UCubeStateSubsystem>()->GetStore();
+	const int32 NumCubes = Store.Num();
+
+	// Several effects can target one cube; sum them so each cube is written once
+	CubeDeltas.SetNumUninitialized(NumCubes, EAllowShrinking::No);
+	TouchedCubes.Init(false, NumCubes);
+	for (const FEffect& Effect : Effects)
+	{
+		if (Effect.DenseIndex == INDEX_NONE || Effect.Delta == 0.0f)
+		{
+			continue;
+		}
+
+		if (TouchedCubes[Effect.DenseIndex])
+		{
+			CubeDeltas[Effect.DenseIndex] += Effect.Delta;
+		}
+		else
+		{
+			TouchedCubes[Effect.DenseIndex] = true;
+			CubeDeltas[Effect.DenseIndex] = Effect.Delta;
+			TouchedIndices.Add(Effect.DenseIndex);
+		}
+	}
+
+	// Resolve to actors before writing; OnHealthChanged handlers may add or remove cubes and move dense indices
+	for (const int32 DenseIndex : TouchedIndices)
+	{
+		APickupCube* Cube = Store.Cubes[DenseIndex];
+		const float OldHealth = Store.Healths[DenseIndex];
+		const float NewHealth = FMath::Clamp(OldHealth + CubeDeltas[DenseIndex], 0.0f, Store.MaxHealths[DenseIndex]);
+		if (Cube && NewHealth != OldHealth)
+		{
+			HealthWrites.Emplace(Cube, NewHealth);
+		}
+	}
+	TouchedIndices.Reset();
+
+	RemoveFinishedEffects();
+
+	UCubeDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCubeDamageSubsystem>();
+	for (const TPair<TWeakObjectPtr<APickupCube>, float>& Write : HealthWrites)
+	{
+		APickupCube* Cube = Write.Key.Get();
+		if (!Cube)
+		{
+			continue;
+		}
+
+		Cube->SetCurrentHealth(Write.Value);
+		if (Write.Value > 0.0f)
+		{
+			continue;
+		}
+
+		OnCubeDepleted.Broadcast(Cube);
+		if (DamageSubsystem)
+		{
+			DamageSubsystem->QueueRelease(Cube);
+		}
+		else if (UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>())
+		{
+			CubePool->ReleaseCube(Cube);
+		}
+		else
+		{
+			Cube->Destroy();
+		}
+	}
+	HealthWrites.Reset();
+}
+
+void UCubeHealthEffectSubsystem::RemoveFinishedEffects()
+{
+	UCubeStateSubsystem* CubeState = GetWorld()->GetSubsystem<UCubeStateSubsystem>();
+	const int32 NumBefore = Effects.Num();
+
+	for (const FEffect& Effect : Effects)
+	{
+		if (Effect.DenseIndex != INDEX_NONE && Effect.Remaining <= 0.0f)
+		{
+			CubeState->SetFlag(Effect.Cube, ECubeStateFlags::HealthEffects, false);
+		}
+	}
+	Effects.RemoveAllSwap([](const FEffect& Effect) { return Effect.DenseIndex == INDEX_NONE || Effect.Remaining <= 0.0f; });
+
+	// A cube whose last effect ended may still have others running; put their flags back
+	if (Effects.Num() != NumBefore)
+	{
+		for (const FEffect& Effect : Effects)
+		{
+			CubeState->SetFlag(Effect.Cube, ECubeStateFlags::HealthEffects, true);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Soak benchmark
+
+static void BenchHealthEffects(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogCubeHealthEffects, Warning, TEXT("Usage: LiquidX.HealthEffects.Bench <NumCubes> [EffectsPerCube]"));
+		return;
+	}
+
+	const int32 NumCubes = FMath::Max(1, FCString::Atoi(*Args[0]));
+	const int32 EffectsPerCube = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2;
+	const UCubeHealthEffectSubsystem* Settings = GetDefault<UCubeHealthEffectSubsystem>();
+
+	FCubeStateStore Store;
+	Store.Reserve(NumCubes);
+	TArray<FCubeHandle> Handles;
+	Handles.Reserve(NumCubes);
+	for (int32 Index = 0; Index < NumCubes; ++Index)
+	{
+		Handles.Add(Store.Add(nullptr, 100.0f, 100.0f));
+	}
+
+	TArray<UCubeHealthEffectSubsystem::FEffect> Effects;
+	Effects.Reserve(NumCubes * EffectsPerCube);
+	for (int32 Index = 0; Index < NumCubes * EffectsPerCube; ++Index)
+	{
+		UCubeHealthEffectSubsystem::FEffect& Effect = Effects.AddDefaulted_GetRef();
+		Effect.Cube = Handles[Index % NumCubes];
+		Effect.Type = ECubeHealthEffectType(Index % 3);
+		Effect.Rate = 1.0f;
+		Effect.Remaining = TNumericLimits<float>::Max();
+	}
+
+	constexpr int32 NumPasses = 5;
+	double TimedMs[2] = { TNumericLimits<double>::Max(), TNumericLimits<double>::Max() };
+	for (int32 Mode = 0; Mode < 2; ++Mode)
+	{
+		for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			UCubeHealthEffectSubsystem::EvaluateEffects(Effects, Store, 1.0f / 60.0f, Settings->EffectsPerTask, /*bParallel*/ Mode == 1);
+			TimedMs[Mode] = FMath::Min(TimedMs[Mode], FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+	}
+
+	UE_LOG(LogCubeHealthEffects, Display, TEXT("HealthEffects bench: %d effects on %d cubes, %d workers, best of %d: single %.3f ms, parallel %.3f ms (%.1fx)"),
+		Effects.Num(), NumCubes, FTaskGraphInterface::Get().GetNumWorkerThreads(), NumPasses, TimedMs[0], TimedMs[1], TimedMs[1] > 0.0 ? TimedMs[0] / TimedMs[1] : 0.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchHealthEffectsCommand(
+	TEXT("LiquidX.HealthEffects.Bench"),
+	TEXT("Time the health-effect pass over <NumCubes> cubes with [EffectsPerCube] effects each, single-threaded and in parallel"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchHealthEffects));
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CubeStateSubsystem.h"
+#include "CubeHealthEffectSubsystem.generated.h"
+
+class APickupCube;
+
+UENUM(BlueprintType)
+enum class ECubeHealthEffectType : uint8
+{
+	/** Loses Rate health per second */
+	Burn,
+	/** Gains Rate health per second, up to max health */
+	Regen,
+	/** Loses Rate of its current health per second (0.5 halves it roughly every 1.4 s) */
+	Decay
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCubeDepleted, APickupCube*, Cube);
+
+/**
+ * Server-side damage-over-time and regeneration for pickup cubes. Effects are small records against
+ * a cube's state-store handle. Each frame they are evaluated with ParallelFor in chunks of
+ * EffectsPerTask, reading health from UCubeStateSubsystem and writing only their own delta, so the
+ * pass has no shared writes and scales with worker count. The deltas are then summed per cube and
+ * written back on the game thread in one sync point, which is where OnHealthChanged (HUD updates)
+ * and OnCubeDepleted fire and depleted cubes are queued for release. Cubes with effects running
+ * carry ECubeStateFlags::HealthEffects, which keeps them out of instancing until the effects end.
+ *
+ * LiquidX.HealthEffects.Bench <NumCubes> [EffectsPerCube] times the parallel pass against a
+ * single-threaded one for soak-test sizing.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UCubeHealthEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start an effect on Cube. A Duration of 0 or less lasts until ClearEffects. */
+	UFUNCTION(BlueprintCallable, Category = "Health")
+	void AddEffect(APickupCube* Cube, ECubeHealthEffectType Type, float Rate, float Duration);
+
+	UFUNCTION(BlueprintCallable, Category = "Health")
+	void ClearEffects(APickupCube* Cube);
+
+	UFUNCTION(BlueprintPure, Category = "Health")
+	int32 GetNumEffects() const { return Effects.Num(); }
+
+	/** Fires at the sync point for each cube whose effects took it to zero health */
+	UPROPERTY(BlueprintAssignable, Category = "Health")
+	FOnCubeDepleted OnCubeDepleted;
+
+	/** Effects evaluated per ParallelFor task; smaller spreads better, larger costs less scheduling */
+	UPROPERTY(Config, EditAnywhere, Category = "Health", meta = (ClampMin = "1"))
+	int32 EffectsPerTask = 2048;
+
+	/** Evaluate on worker threads; off runs the same pass on the game thread */
+	UPROPERTY(Config, EditAnywhere, Category = "Health")
+	bool bParallelEvaluate = true;
+
+	struct FEffect
+	{
+		FCubeHandle Cube;
+		float Rate = 0.0f;
+		float Remaining = 0.0f;
+		/** Written by the parallel pass: health change this frame and the cube's store index */
+		float Delta = 0.0f;
+		int32 DenseIndex = INDEX_NONE;
+		ECubeHealthEffectType Type = ECubeHealthEffectType::Burn;
+	};
+
+	/** The parallel pass: fill in Delta and DenseIndex of every effect and count down its duration */
+	static void EvaluateEffects(TArrayView<FEffect> InEffects, const FCubeStateStore& Store, float DeltaTime, int32 InEffectsPerTask, bool bParallel);
+
+private:
+	/** The game-thread sync point: sum deltas per cube, write health back, fire events, drop expired effects */
+	void ApplyEffects();
+
+	/** Drop expired effects and effects on gone cubes, clearing HealthEffects on cubes left with none */
+	void RemoveFinishedEffects();
+
+	TArray<FEffect> Effects;
+
+	// Sync-point scratch, indexed by state-store dense index
+	TArray<float> CubeDeltas;
+	TBitArray<> TouchedCubes;
+	TArray<int32> TouchedIndices;
+	TArray<TPair<TWeakObjectPtr<APickupCube>, float>> HealthWrites;
+};
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "CubeMassFragments.generated.h"
+
+/** Health of a cube entity. Damage is added to PendingDamage and applied by UCubeMassDamageProcessor. */
+USTRUCT()
+struct FCubeHealthFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	float Health = 0.0f;
+	float MaxHealth = 0.0f;
+	float PendingDamage = 0.0f;
+};
+
+/** Velocity of a knocked cube entity; entities fall back to RestZ and slide to a stop */
+USTRUCT()
+struct FCubeMotionFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Velocity = FVector::ZeroVector;
+	float RestZ = 0.0f;
+	int32 FramesBelowSpeed = 0;
+};
+
+/** Where the entity is drawn and looked up: its ISM instance and its UCubeMassSubsystem grid cell */
+USTRUCT()
+struct FCubeVisualFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	int32 BatchIndex = INDEX_NONE;
+	int32 InstanceIndex = INDEX_NONE;
+	FIntVector Cell = FIntVector::ZeroValue;
+};
+
+/** Not moving; skipped by the settle and visualization processors */
+USTRUCT()
+struct FCubeRestingTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/** Has PendingDamage to apply this frame */
+USTRUCT()
+struct FCubeDamagedTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/** Health reached zero; the visualization processor frees its instance and destroys it */
+USTRUCT()
+struct FCubeDeadTag : public FMassTag
+{
+	GENERATED_BODY()
+};
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeMassProcessors.h"
+#include "CubeMassFragments.h"
+#include "CubeMassSubsystem.h"
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "Engine/World.h"
+
+//////////////////////////////////////////////////////////////////////////
+// UCubeMassDamageProcessor
+
+UCubeMassDamageProcessor::UCubeMassDamageProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+}
+
+void UCubeMassDamageProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FCubeHealthFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FCubeDamagedTag>(EMassFragmentPresence::All);
+	EntityQuery.AddTagRequirement<FCubeDeadTag>(EMassFragmentPresence::None);
+}
+
+void UCubeMassDamageProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context)
+	{
+		const TArrayView<FCubeHealthFragment> Healths = Context.GetMutableFragmentView<FCubeHealthFragment>();
+
+		for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+		{
+			FCubeHealthFragment& Health = Healths[Index];
+			Health.Health = FMath::Max(0.0f, Health.Health - Health.PendingDamage);
+			Health.PendingDamage = 0.0f;
+
+			const FMassEntityHandle Entity = Context.GetEntity(Index);
+			Context.Defer().RemoveTag<FCubeDamagedTag>(Entity);
+			if (Health.Health <= 0.0f)
+			{
+				Context.Defer().AddTag<FCubeDeadTag>(Entity);
+			}
+		}
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UCubeMassSettleProcessor
+
+UCubeMassSettleProcessor::UCubeMassSettleProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+}
+
+void UCubeMassSettleProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FCubeMotionFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FCubeRestingTag>(EMassFragmentPresence::None);
+	EntityQuery.AddTagRequirement<FCubeDeadTag>(EMassFragmentPresence::None);
+}
+
+void UCubeMassSettleProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const UWorld* World = EntityManager.GetWorld();
+	const UCubeMassSubsystem* CubeMass = World ? World->GetSubsystem<UCubeMassSubsystem>() : nullptr;
+	if (!CubeMass)
+	{
+		return;
+	}
+
+	const float DeltaTime = Context.GetDeltaTimeSeconds();
+	const float GravityZ = World->GetGravityZ();
+	const float SettleSpeedSq = FMath::Square(CubeMass->SettleSpeed);
+	const int32 SettleFrames = CubeMass->SettleFrames;
+	const float FrictionScale = FMath::Max(0.0f, 1.0f - CubeMass->GroundFriction * DeltaTime);
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context)
+	{
+		const TArrayView<FTransformFragment> Transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FCubeMotionFragment> Motions = Context.GetMutableFragmentView<FCubeMotionFragment>();
+
+		for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+		{
+			FTransform& Transform = Transforms[Index].GetMutableTransform();
+			FCubeMotionFragment& Motion = Motions[Index];
+
+			Motion.Velocity.Z += GravityZ * DeltaTime;
+			FVector Location = Transform.GetLocation() + Motion.Velocity * DeltaTime;
+
+			const bool bOnGround = Location.Z <= Motion.RestZ;
+			if (bOnGround)
+			{
+				Location.Z = Motion.RestZ;
+				Motion.Velocity.Z = 0.0f;
+				Motion.Velocity *= FrictionScale;
+			}
+			Transform.SetLocation(Location);
+
+			Motion.FramesBelowSpeed = bOnGround && Motion.Velocity.SizeSquared() <= SettleSpeedSq ? Motion.FramesBelowSpeed + 1 : 0;
+			if (Motion.FramesBelowSpeed >= SettleFrames)
+			{
+				Motion.Velocity = FVector::ZeroVector;
+				Motion.FramesBelowSpeed = 0;
+				Context.Defer().AddTag<FCubeRestingTag>(Context.GetEntity(Index));
+			}
+		}
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UCubeMassVisualizationProcessor
+
+UCubeMassVisualizationProcessor::UCubeMassVisualizationProcessor()
+	: MovingQuery(*this)
+	, DeadQuery(*this)
+{
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteAfter.Add(UCubeMassDamageProcessor::StaticClass()->GetFName());
+	ExecutionOrder.ExecuteAfter.Add(UCubeMassSettleProcessor::StaticClass()->GetFName());
+
+	// Touches instanced mesh components and the subsystem's grid
+	bRequiresGameThreadExecution = true;
+}
+
+void UCubeMassVisualizationProcessor::ConfigureQueries()
+{
+	MovingQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	MovingQuery.AddRequirement<FCubeVisualFragment>(EMassFragmentAccess::ReadWrite);
+	MovingQuery.AddTagRequirement<FCubeRestingTag>(EMassFragmentPresence::None);
+	MovingQuery.AddTagRequirement<FCubeDeadTag>(EMassFragmentPresence::None);
+
+	DeadQuery.AddRequirement<FCubeVisualFragment>(EMassFragmentAccess::ReadWrite);
+	DeadQuery.AddTagRequirement<FCubeDeadTag>(EMassFragmentPresence::All);
+}
+
+void UCubeMassVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const UWorld* World = EntityManager.GetWorld();
+	UCubeMassSubsystem* CubeMass = World ? World->GetSubsystem<UCubeMassSubsystem>() : nullptr;
+	if (!CubeMass)
+	{
+		return;
+	}
+
+	MovingQuery.ForEachEntityChunk(EntityManager, Context, [CubeMass](FMassExecutionContext& Context)
+	{
+		const TConstArrayView<FTransformFragment> Transforms = Context.GetFragmentView<FTransformFragment>();
+		const TArrayView<FCubeVisualFragment> Visuals = Context.GetMutableFragmentView<FCubeVisualFragment>();
+
+		for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+		{
+			CubeMass->UpdateEntityVisual(Context.GetEntity(Index), Visuals[Index], Transforms[Index].GetTransform());
+		}
+	});
+
+	DeadQuery.ForEachEntityChunk(EntityManager, Context, [CubeMass](FMassExecutionContext& Context)
+	{
+		const TArrayView<FCubeVisualFragment> Visuals = Context.GetMutableFragmentView<FCubeVisualFragment>();
+
+		for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+		{
+			const FMassEntityHandle Entity = Context.GetEntity(Index);
+			CubeMass->RemoveEntityVisual(Entity, Visuals[Index]);
+			Context.Defer().DestroyEntity(Entity);
+		}
+	});
+
+	CubeMass->FlushVisualUpdates();
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "CubeMassProcessors.generated.h"
+
+/** Applies pending damage to cube entities and marks the ones that reach zero as dead. Runs on worker threads. */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API UCubeMassDamageProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UCubeMassDamageProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+/** Moves knocked cube entities under gravity and ground friction and tags them resting once they stop. Runs on worker threads. */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API UCubeMassSettleProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UCubeMassSettleProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+/** Pushes moving entities' transforms to their ISM instances and removes dead entities. Game thread only. */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API UCubeMassVisualizationProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UCubeMassVisualizationProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery MovingQuery;
+	FMassEntityQuery DeadQuery;
+};
@@ -0,0 +1,545 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeMassSubsystem.h"
+#include "CubeMassFragments.h"
+#include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "PickupCubeInstanceSubsystem.h"
+#include "MassEntitySubsystem.h"
+#include "MassCommonFragments.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Algo/StableSort.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCubeMass, Log, All);
+
+void UCubeMassSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Collection.InitializeDependency(UMassEntitySubsystem::StaticClass());
+
+	if (FMassEntityManager* EntityManager = GetEntityManager())
+	{
+		// New entities start resting; knocks remove the tag and settling adds it back
+		Archetype = EntityManager->CreateArchetype({
+			FTransformFragment::StaticStruct(),
+			FCubeHealthFragment::StaticStruct(),
+			FCubeMotionFragment::StaticStruct(),
+			FCubeVisualFragment::StaticStruct(),
+			FCubeRestingTag::StaticStruct() });
+	}
+}
+
+void UCubeMassSubsystem::Deinitialize()
+{
+	Grid.Empty();
+	Batches.Empty();
+	HostActor = nullptr;
+	NumEntities = 0;
+
+	Super::Deinitialize();
+}
+
+FMassEntityManager* UCubeMassSubsystem::GetEntityManager() const
+{
+	UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	return EntitySubsystem ? &EntitySubsystem->GetMutableEntityManager() : nullptr;
+}
+
+FIntVector UCubeMassSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+bool UCubeMassSubsystem::DemoteCube(APickupCube* Cube)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || !Archetype.IsValid() || !IsValid(Cube))
+	{
+		return false;
+	}
+
+	const int32 BatchIndex = FindOrCreateBatch(Cube->GetClass());
+	if (BatchIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FTransform Transform = Cube->GetActorTransform();
+	const FMassEntityHandle Entity = EntityManager->CreateEntity(Archetype);
+	InitEntity(*EntityManager, Entity, BatchIndex, AcquireInstance(Batches[BatchIndex], Transform), Transform, Cube->GetHealth(), Cube->GetMaxHealth());
+
+	if (UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>())
+	{
+		CubePool->ReleaseCube(Cube);
+	}
+	else
+	{
+		Cube->Destroy();
+	}
+	return true;
+}
+
+int32 UCubeMassSubsystem::SpawnCubeEntities(TSubclassOf<APickupCube> CubeClass, const TArray<FTransform>& Transforms)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || !Archetype.IsValid() || !CubeClass || Transforms.Num() == 0)
+	{
+		return 0;
+	}
+
+	// Entities and their instances only exist on the machine that made them
+	if (GetWorld()->GetNetMode() != NM_Standalone)
+	{
+		return 0;
+	}
+
+	const int32 BatchIndex = FindOrCreateBatch(CubeClass);
+	if (BatchIndex == INDEX_NONE)
+	{
+		return 0;
+	}
+
+	const float MaxHealth = CubeClass->GetDefaultObject<APickupCube>()->GetMaxHealth();
+	const TArray<int32> InstanceIndices = Batches[BatchIndex].Component->AddInstances(Transforms, /*bShouldReturnIndices*/ true, /*bWorldSpace*/ true);
+
+	TArray<FMassEntityHandle> Entities;
+	{
+		// Observers run when the creation context goes out of scope, after the fragments are filled in
+		TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext = EntityManager->BatchCreateEntities(Archetype, Transforms.Num(), Entities);
+		for (int32 Index = 0; Index < Entities.Num(); ++Index)
+		{
+			InitEntity(*EntityManager, Entities[Index], BatchIndex, InstanceIndices[Index], Transforms[Index], MaxHealth, MaxHealth);
+		}
+	}
+	return Entities.Num();
+}
+
+void UCubeMassSubsystem::InitEntity(FMassEntityManager& EntityManager, FMassEntityHandle Entity, int32 BatchIndex, int32 InstanceIndex, const FTransform& Transform, float Health, float MaxHealth)
+{
+	EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).SetTransform(Transform);
+
+	FCubeHealthFragment& HealthFragment = EntityManager.GetFragmentDataChecked<FCubeHealthFragment>(Entity);
+	HealthFragment.Health = Health;
+	HealthFragment.MaxHealth = MaxHealth;
+
+	EntityManager.GetFragmentDataChecked<FCubeMotionFragment>(Entity).RestZ = Transform.GetLocation().Z;
+
+	FCubeVisualFragment& Visual = EntityManager.GetFragmentDataChecked<FCubeVisualFragment>(Entity);
+	Visual.BatchIndex = BatchIndex;
+	Visual.InstanceIndex = InstanceIndex;
+	Visual.Cell = GetCell(Transform.GetLocation());
+	Grid.FindOrAdd(Visual.Cell).Add(Entity);
+
+	NumEntities++;
+}
+
+int32 UCubeMassSubsystem::PromoteInRadius(const FVector& Location, float Radius, TArray<APickupCube*>& OutCubes)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || NumEntities == 0)
+	{
+		return 0;
+	}
+
+	float MaxMeshRadius = 0.0f;
+	for (const FCubeMassBatch& Batch : Batches)
+	{
+		MaxMeshRadius = FMath::Max(MaxMeshRadius, Batch.MeshRadius);
+	}
+
+	TArray<FMassEntityHandle> Candidates;
+	GatherEntitiesInBounds(FBox::BuildAABB(Location, FVector(Radius + MaxMeshRadius)), Candidates);
+	Candidates.RemoveAllSwap([&](FMassEntityHandle Entity)
+	{
+		const FTransform& Transform = EntityManager->GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform();
+		const FCubeVisualFragment& Visual = EntityManager->GetFragmentDataChecked<FCubeVisualFragment>(Entity);
+		const float ReachRadius = Radius + Batches[Visual.BatchIndex].MeshRadius * Transform.GetMaximumAxisScale();
+		return FVector::DistSquared(Transform.GetLocation(), Location) > FMath::Square(ReachRadius);
+	});
+	return PromoteEntities(Candidates, OutCubes);
+}
+
+int32 UCubeMassSubsystem::PromoteAlongSegment(const FVector& Start, const FVector& End, float Radius, TArray<APickupCube*>& OutCubes)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || NumEntities == 0)
+	{
+		return 0;
+	}
+
+	float MaxMeshRadius = 0.0f;
+	for (const FCubeMassBatch& Batch : Batches)
+	{
+		MaxMeshRadius = FMath::Max(MaxMeshRadius, Batch.MeshRadius);
+	}
+
+	FBox SegmentBounds(ForceInit);
+	SegmentBounds += Start;
+	SegmentBounds += End;
+
+	TArray<FMassEntityHandle> Candidates;
+	GatherEntitiesInBounds(SegmentBounds.ExpandBy(Radius + MaxMeshRadius), Candidates);
+	Candidates.RemoveAllSwap([&](FMassEntityHandle Entity)
+	{
+		const FTransform& Transform = EntityManager->GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform();
+		const FCubeVisualFragment& Visual = EntityManager->GetFragmentDataChecked<FCubeVisualFragment>(Entity);
+		const float ReachRadius = Radius + Batches[Visual.BatchIndex].MeshRadius * Transform.GetMaximumAxisScale();
+		return FMath::PointDistToSegment(Transform.GetLocation(), Start, End) > ReachRadius;
+	});
+	return PromoteEntities(Candidates, OutCubes);
+}
+
+int32 UCubeMassSubsystem::PromoteEntities(TArray<FMassEntityHandle>& Entities, TArray<APickupCube*>& OutCubes)
+{
+	int32 NumPromoted = 0;
+	for (const FMassEntityHandle Entity : Entities)
+	{
+		if (APickupCube* Cube = PromoteEntity(Entity))
+		{
+			OutCubes.Add(Cube);
+			NumPromoted++;
+		}
+	}
+	return NumPromoted;
+}
+
+APickupCube* UCubeMassSubsystem::PromoteEntity(FMassEntityHandle Entity)
+{
+	FMassEntityManager& EntityManager = *GetEntityManager();
+	if (!EntityManager.IsEntityValid(Entity))
+	{
+		return nullptr;
+	}
+
+	FCubeVisualFragment& Visual = EntityManager.GetFragmentDataChecked<FCubeVisualFragment>(Entity);
+	if (Visual.InstanceIndex == INDEX_NONE)
+	{
+		// Already removed this frame and waiting for its deferred destroy
+		return nullptr;
+	}
+
+	const FTransform Transform = EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform();
+	const FCubeHealthFragment Health = EntityManager.GetFragmentDataChecked<FCubeHealthFragment>(Entity);
+	const TSubclassOf<APickupCube> CubeClass = Batches[Visual.BatchIndex].CubeClass;
+
+	// Damage queued this frame that the processor hasn't applied yet still counts
+	const float CurrentHealth = Health.Health - Health.PendingDamage;
+
+	APickupCube* Cube = nullptr;
+	if (CurrentHealth > 0.0f)
+	{
+		// Take the actor first; if the pool can't hand one out the entity stays as it is
+		UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>();
+		Cube = CubePool ? CubePool->AcquireCube(CubeClass, Transform) : nullptr;
+		if (!Cube)
+		{
+			return nullptr;
+		}
+	}
+
+	// Acquiring can spawn, so look the fragment up again rather than trusting the earlier reference
+	RemoveEntityVisual(Entity, EntityManager.GetFragmentDataChecked<FCubeVisualFragment>(Entity));
+	if (EntityManager.IsProcessing())
+	{
+		EntityManager.Defer().DestroyEntity(Entity);
+	}
+	else
+	{
+		EntityManager.DestroyEntity(Entity);
+	}
+
+	if (Cube)
+	{
+		Cube->SetHealthState(CurrentHealth, Health.MaxHealth);
+		if (UPickupCubeInstanceSubsystem* Instancing = GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>())
+		{
+			Instancing->QueueDemotion(Cube, Instancing->PromotedIdleDelay);
+		}
+	}
+	return Cube;
+}
+
+int32 UCubeMassSubsystem::ApplyAreaDamage(const FVector& Origin, const FVector& Direction, float Radius, float CosHalfAngle, float Damage, float ImpulseStrength)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || NumEntities == 0 || Radius <= 0.0f)
+	{
+		return 0;
+	}
+
+	TArray<FMassEntityHandle> Candidates;
+	GatherEntitiesInBounds(FBox::BuildAABB(Origin, FVector(Radius)), Candidates);
+
+	const FVector UnitDirection = Direction.GetSafeNormal();
+	const float RadiusSq = FMath::Square(Radius);
+	const float VelocityChange = ImpulseStrength / EntityMassKg;
+
+	int32 NumHit = 0;
+	for (const FMassEntityHandle Entity : Candidates)
+	{
+		const FVector ToEntity = EntityManager->GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform().GetLocation() - Origin;
+		if (ToEntity.SizeSquared() > RadiusSq || (ToEntity | UnitDirection) < CosHalfAngle * ToEntity.Size())
+		{
+			continue;
+		}
+
+		EntityManager->GetFragmentDataChecked<FCubeHealthFragment>(Entity).PendingDamage += Damage;
+		EntityManager->Defer().AddTag<FCubeDamagedTag>(Entity);
+
+		if (VelocityChange > 0.0f)
+		{
+			FCubeMotionFragment& Motion = EntityManager->GetFragmentDataChecked<FCubeMotionFragment>(Entity);
+			Motion.Velocity += ToEntity.GetSafeNormal() * VelocityChange;
+			Motion.FramesBelowSpeed = 0;
+			EntityManager->Defer().RemoveTag<FCubeRestingTag>(Entity);
+		}
+		NumHit++;
+	}
+
+	if (!EntityManager->IsProcessing())
+	{
+		EntityManager->FlushCommands();
+	}
+	return NumHit;
+}
+
+void UCubeMassSubsystem::GatherEntitiesInBounds(const FBox& Bounds, TArray<FMassEntityHandle>& OutEntities) const
+{
+	const FIntVector MinCell = GetCell(Bounds.Min);
+	const FIntVector MaxCell = GetCell(Bounds.Max);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				if (const TArray<FMassEntityHandle>* CellEntities = Grid.Find(FIntVector(X, Y, Z)))
+				{
+					OutEntities.Append(*CellEntities);
+				}
+			}
+		}
+	}
+}
+
+void UCubeMassSubsystem::UpdateEntityVisual(FMassEntityHandle Entity, FCubeVisualFragment& Visual, const FTransform& Transform)
+{
+	if (Visual.InstanceIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	Batches[Visual.BatchIndex].PendingTransforms.Emplace(Visual.InstanceIndex, Transform);
+
+	const FIntVector NewCell = GetCell(Transform.GetLocation());
+	if (NewCell != Visual.Cell)
+	{
+		if (TArray<FMassEntityHandle>* OldCell = Grid.Find(Visual.Cell))
+		{
+			OldCell->RemoveSwap(Entity, EAllowShrinking::No);
+		}
+		Grid.FindOrAdd(NewCell).Add(Entity);
+		Visual.Cell = NewCell;
+	}
+}
+
+void UCubeMassSubsystem::RemoveEntityVisual(FMassEntityHandle Entity, FCubeVisualFragment& Visual)
+{
+	if (Visual.InstanceIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Hide the instance and keep it for the next entity rather than paying for swap-removal fix-ups
+	FCubeMassBatch& Batch = Batches[Visual.BatchIndex];
+	FTransform HiddenTransform;
+	Batch.Component->GetInstanceTransform(Visual.InstanceIndex, HiddenTransform, /*bWorldSpace*/ true);
+	HiddenTransform.SetScale3D(FVector::ZeroVector);
+	Batch.PendingTransforms.Emplace(Visual.InstanceIndex, HiddenTransform);
+	Batch.FreeInstances.Add(Visual.InstanceIndex);
+	Visual.InstanceIndex = INDEX_NONE;
+
+	if (TArray<FMassEntityHandle>* CellEntities = Grid.Find(Visual.Cell))
+	{
+		CellEntities->RemoveSwap(Entity, EAllowShrinking::No);
+		if (CellEntities->Num() == 0)
+		{
+			Grid.Remove(Visual.Cell);
+		}
+	}
+
+	NumEntities--;
+}
+
+void UCubeMassSubsystem::FlushVisualUpdates()
+{
+	TArray<FTransform> RunTransforms;
+
+	for (FCubeMassBatch& Batch : Batches)
+	{
+		TArray<TPair<int32, FTransform>>& Pending = Batch.PendingTransforms;
+		if (Pending.Num() == 0 || !Batch.Component)
+		{
+			Pending.Reset();
+			continue;
+		}
+
+		// Stable, so an instance written twice this frame (moved, then hidden) keeps its last transform
+		Algo::StableSortBy(Pending, [](const TPair<int32, FTransform>& Update) { return Update.Key; });
+
+		int32 RunStart = 0;
+		while (RunStart < Pending.Num())
+		{
+			const int32 StartInstance = Pending[RunStart].Key;
+			RunTransforms.Reset();
+			RunTransforms.Add(Pending[RunStart].Value);
+
+			int32 Next = RunStart + 1;
+			for (; Next < Pending.Num(); ++Next)
+			{
+				const int32 Instance = Pending[Next].Key;
+				if (Instance == StartInstance + RunTransforms.Num() - 1)
+				{
+					RunTransforms.Last() = Pending[Next].Value;
+				}
+				else if (Instance == StartInstance + RunTransforms.Num())
+				{
+					RunTransforms.Add(Pending[Next].Value);
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			const bool bLastRun = Next == Pending.Num();
+			Batch.Component->BatchUpdateInstancesTransforms(StartInstance, RunTransforms, /*bWorldSpace*/ true, /*bMarkRenderStateDirty*/ bLastRun, /*bTeleport*/ true);
+			RunStart = Next;
+		}
+
+		Pending.Reset();
+	}
+}
+
+int32 UCubeMassSubsystem::FindOrCreateBatch(TSubclassOf<APickupCube> CubeClass)
+{
+	for (int32 BatchIndex = 0; BatchIndex < Batches.Num(); ++BatchIndex)
+	{
+		if (Batches[BatchIndex].CubeClass == CubeClass)
+		{
+			return BatchIndex;
+		}
+	}
+
+	const APickupCube* CubeDefaults = CubeClass->GetDefaultObject<APickupCube>();
+	const UStaticMeshComponent* Template = CubeDefaults->GetStaticMeshComponent();
+	if (!Template || !Template->GetStaticMesh())
+	{
+		UE_LOG(LogCubeMass, Warning, TEXT("%s has no static mesh, its cubes will stay actors"), *GetNameSafe(CubeClass));
+		return INDEX_NONE;
+	}
+
+	if (!HostActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		HostActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		USceneComponent* Root = NewObject<USceneComponent>(HostActor, TEXT("Root"));
+		HostActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	// Entities are found through the grid, not collision, so the instances need no physics bodies
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(HostActor);
+	Component->SetStaticMesh(Template->GetStaticMesh());
+	for (int32 MaterialIndex = 0; MaterialIndex < Template->GetNumMaterials(); ++MaterialIndex)
+	{
+		Component->SetMaterial(MaterialIndex, Template->GetMaterial(MaterialIndex));
+	}
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetupAttachment(HostActor->GetRootComponent());
+	Component->RegisterComponent();
+
+	FCubeMassBatch& Batch = Batches.AddDefaulted_GetRef();
+	Batch.CubeClass = CubeClass;
+	Batch.Component = Component;
+	Batch.MeshRadius = Template->GetStaticMesh()->GetBounds().SphereRadius;
+	return Batches.Num() - 1;
+}
+
+int32 UCubeMassSubsystem::AcquireInstance(FCubeMassBatch& Batch, const FTransform& Transform)
+{
+	if (Batch.FreeInstances.Num() > 0)
+	{
+		const int32 InstanceIndex = Batch.FreeInstances.Pop(EAllowShrinking::No);
+
+		// Freed this frame: drop the queued hide so the flush doesn't undo the reuse
+		Batch.PendingTransforms.RemoveAllSwap([InstanceIndex](const TPair<int32, FTransform>& Update) { return Update.Key == InstanceIndex; }, EAllowShrinking::No);
+		Batch.Component->UpdateInstanceTransform(InstanceIndex, Transform, /*bWorldSpace*/ true, /*bMarkRenderStateDirty*/ true, /*bTeleport*/ true);
+		return InstanceIndex;
+	}
+	return Batch.Component->AddInstance(Transform, /*bWorldSpace*/ true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Debris field commands
+
+static void SpawnMassCubes(const TArray<FString>& Args, UWorld* World)
+{
+	UCubeMassSubsystem* CubeMass = World ? World->GetSubsystem<UCubeMassSubsystem>() : nullptr;
+	if (!CubeMass || Args.Num() < 1)
+	{
+		UE_LOG(LogCubeMass, Warning, TEXT("Usage: LiquidX.Mass.SpawnCubes <Count> [Spacing]"));
+		return;
+	}
+
+	const int32 Count = FCString::Atoi(*Args[0]);
+	const float Spacing = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 120.0f;
+
+	// Use the level's cube class (the Blueprint with a mesh) when there is one
+	TSubclassOf<APickupCube> CubeClass = APickupCube::StaticClass();
+	for (TActorIterator<APickupCube> It(World); It; ++It)
+	{
+		CubeClass = It->GetClass();
+		break;
+	}
+
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt(float(Count)));
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location((Index % Side - Side / 2) * Spacing, (Index / Side - Side / 2) * Spacing, 50.0f);
+		Transforms.Add(FTransform(Location));
+	}
+
+	const int32 NumSpawned = CubeMass->SpawnCubeEntities(CubeClass, Transforms);
+	UE_LOG(LogCubeMass, Log, TEXT("Spawned %d %s entities (%d total)"), NumSpawned, *GetNameSafe(CubeClass), CubeMass->GetNumEntities());
+}
+
+static void ReportMassCubes(const TArray<FString>& Args, UWorld* World)
+{
+	if (const UCubeMassSubsystem* CubeMass = World ? World->GetSubsystem<UCubeMassSubsystem>() : nullptr)
+	{
+		UE_LOG(LogCubeMass, Display, TEXT("CubeMass: %d entities"), CubeMass->GetNumEntities());
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnMassCubesCommand(
+	TEXT("LiquidX.Mass.SpawnCubes"),
+	TEXT("Spawn <Count> [Spacing] cube entities in a grid around the origin"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SpawnMassCubes));
+
+static FAutoConsoleCommandWithWorldAndArgs ReportMassCubesCommand(
+	TEXT("LiquidX.Mass.Report"),
+	TEXT("Log the number of cube entities"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReportMassCubes));
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "CubeMassSubsystem.generated.h"
+
+class APickupCube;
+class UInstancedStaticMeshComponent;
+struct FCubeVisualFragment;
+struct FMassEntityManager;
+
+/** Cube entities of one APickupCube class, drawn by one instanced mesh. Hidden instances are reused. */
+USTRUCT()
+struct FCubeMassBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<APickupCube> CubeClass;
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> Component;
+
+	float MeshRadius = 0.0f;
+	TArray<int32> FreeInstances;
+
+	/** Instance transforms written this frame, applied in index runs by FlushVisualUpdates */
+	TArray<TPair<int32, FTransform>> PendingTransforms;
+};
+
+/**
+ * Debris-field backend: cubes as Mass entities (transform, health, motion and visual fragments)
+ * drawn through one instanced static mesh per cube class, for populations far beyond what pooled
+ * actors can carry. Damage and settling run in Mass processors on worker threads; only the
+ * instance updates for moving or dead entities touch the game thread.
+ *
+ * Entities are promoted to real APickupCube actors when a pickup or punch reaches them and, with
+ * bDemoteToMass, resting actors are demoted back into entities instead of plain instances. Area
+ * damage from UCubeDamageSubsystem reaches entities in place without promoting them. Like the
+ * instance subsystem this is local state, so it is used in standalone games only.
+ *
+ * LiquidX.Mass.SpawnCubes <Count> [Spacing] fills a debris field; LiquidX.Mass.Report logs its size.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UCubeMassSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	bool ShouldDemoteToMass() const { return bDemoteToMass; }
+
+	/** Replace a resting cube actor with an entity and return the actor to the pool */
+	bool DemoteCube(APickupCube* Cube);
+
+	/** Create one resting entity per transform. Returns the number created. */
+	int32 SpawnCubeEntities(TSubclassOf<APickupCube> CubeClass, const TArray<FTransform>& Transforms);
+
+	/** Promote every entity within Radius of Location. Promoted actors are appended to OutCubes. */
+	int32 PromoteInRadius(const FVector& Location, float Radius, TArray<APickupCube*>& OutCubes);
+
+	/** Promote every entity within Radius of the segment. Promoted actors are appended to OutCubes. */
+	int32 PromoteAlongSegment(const FVector& Start, const FVector& End, float Radius, TArray<APickupCube*>& OutCubes);
+
+	/**
+	 * Queue Damage on every entity within Radius of Origin whose direction from Origin is within the
+	 * cone CosHalfAngle of Direction (-1 for a full sphere), and push them away from Origin.
+	 */
+	int32 ApplyAreaDamage(const FVector& Origin, const FVector& Direction, float Radius, float CosHalfAngle, float Damage, float ImpulseStrength);
+
+	int32 GetNumEntities() const { return NumEntities; }
+
+	// Called by UCubeMassVisualizationProcessor on the game thread
+	void UpdateEntityVisual(FMassEntityHandle Entity, FCubeVisualFragment& Visual, const FTransform& Transform);
+	void RemoveEntityVisual(FMassEntityHandle Entity, FCubeVisualFragment& Visual);
+
+	/**
+	 * Apply the frame's instance transforms: contiguous instance indices go through one
+	 * BatchUpdateInstancesTransforms call each, and only the last update of a batch marks its
+	 * instances dirty, so the render state is not rebuilt for every moving cube.
+	 */
+	void FlushVisualUpdates();
+
+	/** Resting cube actors become entities rather than mesh instances */
+	UPROPERTY(Config, EditAnywhere, Category = "Mass")
+	bool bDemoteToMass = false;
+
+	/** Edge length of the lookup grid used for promotion and area damage */
+	UPROPERTY(Config, EditAnywhere, Category = "Mass", meta = (ClampMin = "1"))
+	float CellSize = 400.0f;
+
+	/** Speed below which a knocked entity counts as settled */
+	UPROPERTY(Config, EditAnywhere, Category = "Mass")
+	float SettleSpeed = 10.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Mass", meta = (ClampMin = "1"))
+	int32 SettleFrames = 5;
+
+	/** Fraction of horizontal speed lost per second while on the ground */
+	UPROPERTY(Config, EditAnywhere, Category = "Mass")
+	float GroundFriction = 4.0f;
+
+	/** Mass used to turn impulses into entity velocity */
+	UPROPERTY(Config, EditAnywhere, Category = "Mass", meta = (ClampMin = "0.01"))
+	float EntityMassKg = 10.0f;
+
+private:
+	FMassEntityManager* GetEntityManager() const;
+	FIntVector GetCell(const FVector& Location) const;
+
+	int32 FindOrCreateBatch(TSubclassOf<APickupCube> CubeClass);
+	int32 AcquireInstance(FCubeMassBatch& Batch, const FTransform& Transform);
+
+	void InitEntity(FMassEntityManager& EntityManager, FMassEntityHandle Entity, int32 BatchIndex, int32 InstanceIndex, const FTransform& Transform, float Health, float MaxHealth);
+	/** Swap an entity for a pooled actor; the entity is kept if the pool has none to give. Dead entities are just removed. */
+	APickupCube* PromoteEntity(FMassEntityHandle Entity);
+	int32 PromoteEntities(TArray<FMassEntityHandle>& Entities, TArray<APickupCube*>& OutCubes);
+
+	/** Entities whose grid cell overlaps Bounds; callers filter by exact shape */
+	void GatherEntitiesInBounds(const FBox& Bounds, TArray<FMassEntityHandle>& OutEntities) const;
+
+	UPROPERTY()
+	TArray<FCubeMassBatch> Batches;
+
+	/** Actor that owns the instanced components. Kept at the origin so instance transforms are world space. */
+	UPROPERTY()
+	TObjectPtr<AActor> HostActor;
+
+	FMassArchetypeHandle Archetype;
+	TMap<FIntVector, TArray<FMassEntityHandle>> Grid;
+	int32 NumEntities = 0;
+};
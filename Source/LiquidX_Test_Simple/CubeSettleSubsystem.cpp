@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeSettleSubsystem.h"
+#include "PickupCube.h"
+#include "PickupCubeInstanceSubsystem.h"
+#include "LiquidXStats.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+void UCubeSettleSubsystem::Deinitialize()
+{
+	SimulatingCubes.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCubeSettleSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCubeSettleSubsystem, STATGROUP_Tickables);
+}
+
+void UCubeSettleSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float SettleSpeedSq = FMath::Square(SettleSpeed);
+
+	for (int32 Index = SimulatingCubes.Num() - 1; Index >= 0; --Index)
+	{
+		FSimulatingCube& Entry = SimulatingCubes[Index];
+		APickupCube* Cube = Entry.Cube.Get();
+
+		// Picked up, pooled or stopped by someone else: no longer ours to settle
+		if (!Cube || Cube->IsInPool() || Cube->IsHeld() || !Cube->GetStaticMeshComponent()->IsSimulatingPhysics())
+		{
+			if (Cube)
+			{
+				Cube->SetStateFlag(ECubeStateFlags::Simulating, false);
+			}
+			SimulatingCubes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		UStaticMeshComponent* Mesh = Cube->GetStaticMeshComponent();
+		const bool bSlow = Mesh->GetPhysicsLinearVelocity().SizeSquared() <= SettleSpeedSq;
+		Entry.FramesBelowSpeed = bSlow ? Entry.FramesBelowSpeed + 1 : 0;
+
+		// A cube is slow at the top of its arc too; only one lying on something counts as resting
+		Entry.bResting = bSlow && IsGrounded(Cube);
+
+		const bool bAsleep = !Mesh->IsAnyRigidBodyAwake();
+		const bool bSettled = Entry.bResting && Entry.FramesBelowSpeed >= SettleFrames;
+		const bool bTimedOut = Entry.bResting && MaxSimulateSeconds > 0.0f && Now - Entry.StartTime >= MaxSimulateSeconds;
+		if (bAsleep || bSettled || bTimedOut)
+		{
+			FreezeCube(Cube);
+			SimulatingCubes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		}
+	}
+}
+
+void UCubeSettleSubsystem::AddSimulatingCube(APickupCube* Cube)
+{
+	if (!IsValid(Cube))
+	{
+		return;
+	}
+
+	for (FSimulatingCube& Entry : SimulatingCubes)
+	{
+		if (Entry.Cube == Cube)
+		{
+			// Knocked again while still moving: give it the full settle window again
+			Entry.StartTime = GetWorld()->GetTimeSeconds();
+			Entry.FramesBelowSpeed = 0;
+			return;
+		}
+	}
+
+	while (SimulatingCubes.Num() >= FMath::Max(1, MaxSimulatingCubes))
+	{
+		const int32 VictimIndex = PickOverflowVictim();
+		if (VictimIndex == INDEX_NONE)
+		{
+			break;
+		}
+		if (APickupCube* Victim = SimulatingCubes[VictimIndex].Cube.Get())
+		{
+			FreezeCube(Victim);
+			NumFrozenByCap++;
+		}
+		SimulatingCubes.RemoveAtSwap(VictimIndex, 1, EAllowShrinking::No);
+	}
+
+	UStaticMeshComponent* Mesh = Cube->GetStaticMeshComponent();
+	Mesh->SetSimulatePhysics(true);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	Cube->SetNetActive(true);
+	Cube->SetStateFlag(ECubeStateFlags::Simulating, true);
+
+	FSimulatingCube& Entry = SimulatingCubes.AddDefaulted_GetRef();
+	Entry.Cube = Cube;
+	Entry.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+bool UCubeSettleSubsystem::IsGrounded(const APickupCube* Cube) const
+{
+	const FBoxSphereBounds Bounds = Cube->GetStaticMeshComponent()->Bounds;
+	const FVector Start = Bounds.Origin;
+	const FVector End = Start - FVector(0.0f, 0.0f, Bounds.BoxExtent.Z + GroundProbeDistance);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CubeSettleGround), false, Cube);
+	LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_SettleQueries, 1);
+	return GetWorld()->LineTraceTestByChannel(Start, End, ECC_Visibility, QueryParams);
+}
+
+void UCubeSettleSubsystem::FreezeCube(APickupCube* Cube) const
+{
+	Cube->GetStaticMeshComponent()->SetSimulatePhysics(false);
+	Cube->SetNetActive(false);
+	Cube->SetStateFlag(ECubeStateFlags::Simulating, false);
+
+	if (UPickupCubeInstanceSubsystem* Instancing = GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>())
+	{
+		Instancing->QueueDemotion(Cube, Instancing->IdleDelay);
+	}
+}
+
+int32 UCubeSettleSubsystem::PickOverflowVictim() const
+{
+	int32 VictimIndex = INDEX_NONE;
+
+	// Dead entries go first; of the live ones only resting cubes can be frozen
+	for (int32 Index = 0; Index < SimulatingCubes.Num(); ++Index)
+	{
+		if (!SimulatingCubes[Index].Cube.IsValid())
+		{
+			return Index;
+		}
+	}
+
+	if (OverflowPolicy == ECubeSettleOverflowPolicy::Farthest)
+	{
+		TArray<FVector, TInlineAllocator<8>> ViewLocations;
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			if (const APlayerController* PlayerController = It->Get())
+			{
+				FVector ViewLocation;
+				FRotator ViewRotation;
+				PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+				ViewLocations.Add(ViewLocation);
+			}
+		}
+
+		if (ViewLocations.Num() > 0)
+		{
+			float FarthestDistSq = -1.0f;
+			for (int32 Index = 0; Index < SimulatingCubes.Num(); ++Index)
+			{
+				if (!SimulatingCubes[Index].bResting)
+				{
+					continue;
+				}
+
+				const APickupCube* Cube = SimulatingCubes[Index].Cube.Get();
+				float NearestViewDistSq = TNumericLimits<float>::Max();
+				for (const FVector& ViewLocation : ViewLocations)
+				{
+					NearestViewDistSq = FMath::Min(NearestViewDistSq, FVector::DistSquared(ViewLocation, Cube->GetActorLocation()));
+				}
+
+				if (NearestViewDistSq > FarthestDistSq)
+				{
+					FarthestDistSq = NearestViewDistSq;
+					VictimIndex = Index;
+				}
+			}
+			return VictimIndex;
+		}
+	}
+
+	// Oldest, and the fallback when there is nobody to measure distance from
+	for (int32 Index = 0; Index < SimulatingCubes.Num(); ++Index)
+	{
+		if (SimulatingCubes[Index].bResting && (VictimIndex == INDEX_NONE || SimulatingCubes[Index].StartTime < SimulatingCubes[VictimIndex].StartTime))
+		{
+			VictimIndex = Index;
+		}
+	}
+	return VictimIndex;
+}
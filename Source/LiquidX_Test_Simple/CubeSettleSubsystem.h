@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CubeSettleSubsystem.generated.h"
+
+class APickupCube;
+
+/** Which simulating cube gives way when MaxSimulatingCubes is reached */
+UENUM()
+enum class ECubeSettleOverflowPolicy : uint8
+{
+	/** The cube that has been simulating longest */
+	Oldest,
+	/** The cube farthest from every player view */
+	Farthest
+};
+
+/**
+ * Owns thrown and knocked cubes while they simulate. A cube is frozen (physics off, net dormant,
+ * queued for instancing) once the solver puts it to sleep, or once it rests on the ground below
+ * SettleSpeed for SettleFrames frames. Physics is never turned off under a moving cube, so timeouts
+ * and the MaxSimulatingCubes cap only freeze cubes that are already resting. When every simulating
+ * cube is still in flight the cap gives way until one lands.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UCubeSettleSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start physics on Cube and keep it simulating until it settles */
+	UFUNCTION(BlueprintCallable, Category = "Physics")
+	void AddSimulatingCube(APickupCube* Cube);
+
+	UFUNCTION(BlueprintPure, Category = "Physics")
+	int32 GetNumSimulatingCubes() const { return SimulatingCubes.Num(); }
+
+	/** Cubes frozen early because the cap was reached, since the world started */
+	UFUNCTION(BlueprintPure, Category = "Physics")
+	int32 GetNumFrozenByCap() const { return NumFrozenByCap; }
+
+	/** Speed below which a cube counts as settled */
+	UPROPERTY(Config, EditAnywhere, Category = "Physics")
+	float SettleSpeed = 10.0f;
+
+	/** Consecutive frames below SettleSpeed before a cube is frozen */
+	UPROPERTY(Config, EditAnywhere, Category = "Physics", meta = (ClampMin = "1"))
+	int32 SettleFrames = 5;
+
+	/** Cubes that are slow and grounded after this long are frozen without waiting for SettleFrames, 0 disables */
+	UPROPERTY(Config, EditAnywhere, Category = "Physics")
+	float MaxSimulateSeconds = 10.0f;
+
+	/** How far below its bounds a slow cube looks for ground before it may be frozen */
+	UPROPERTY(Config, EditAnywhere, Category = "Physics", meta = (ClampMin = "0"))
+	float GroundProbeDistance = 5.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Physics", meta = (ClampMin = "1"))
+	int32 MaxSimulatingCubes = 128;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Physics")
+	ECubeSettleOverflowPolicy OverflowPolicy = ECubeSettleOverflowPolicy::Oldest;
+
+private:
+	struct FSimulatingCube
+	{
+		TWeakObjectPtr<APickupCube> Cube;
+		double StartTime = 0.0;
+		int32 FramesBelowSpeed = 0;
+
+		/** Below SettleSpeed and on the ground as of the last tick; only these may be frozen early */
+		bool bResting = false;
+	};
+
+	/** True when something blocks just below Cube. Traces, so only call it for slow cubes. */
+	bool IsGrounded(const APickupCube* Cube) const;
+
+	/** Turn physics off and hand the cube back to dormancy and instancing */
+	void FreezeCube(APickupCube* Cube) const;
+
+	/** Index of the resting cube to freeze when the cap is reached, or INDEX_NONE when every cube is in flight */
+	int32 PickOverflowVictim() const;
+
+	TArray<FSimulatingCube> SimulatingCubes;
+	int32 NumFrozenByCap = 0;
+};
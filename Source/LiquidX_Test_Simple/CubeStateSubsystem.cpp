@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeStateSubsystem.h"
+#include "PickupCube.h"
+#include "LiquidXStats.h"
+#include "Engine/World.h"
+
+#if STATS && LIQUIDX_STATS
+/** The cube-count stat a cube with these flags counts towards; each cube counts towards exactly one */
+static FName GetCubeStateStat(ECubeStateFlags Flags)
+{
+	if (EnumHasAnyFlags(Flags, ECubeStateFlags::InPool))
+	{
+		return GET_STATFNAME(STAT_LiquidX_CubesPooled);
+	}
+	if (EnumHasAnyFlags(Flags, ECubeStateFlags::Held))
+	{
+		return GET_STATFNAME(STAT_LiquidX_CubesHeld);
+	}
+	if (EnumHasAnyFlags(Flags, ECubeStateFlags::Simulating))
+	{
+		return GET_STATFNAME(STAT_LiquidX_CubesSimulating);
+	}
+	return GET_STATFNAME(STAT_LiquidX_CubesIdle);
+}
+
+static void CountCubeState(ECubeStateFlags Flags, bool bAdd)
+{
+	const FName Stat = GetCubeStateStat(Flags);
+	if (bAdd)
+	{
+		INC_DWORD_STAT_FNAME_BY(Stat, 1);
+	}
+	else
+	{
+		DEC_DWORD_STAT_FNAME_BY(Stat, 1);
+	}
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// FCubeStateStore
+
+FCubeHandle FCubeStateStore::Add(APickupCube* Cube, float Health, float MaxHealth)
+{
+	const int32 SlotIndex = FreeSlots.Num() > 0 ? FreeSlots.Pop(EAllowShrinking::No) : Slots.AddDefaulted();
+	FSlot& Slot = Slots[SlotIndex];
+	Slot.DenseIndex = Healths.Num();
+
+	DenseToSlot.Add(SlotIndex);
+	Healths.Add(Health);
+	MaxHealths.Add(MaxHealth);
+	Flags.Add(ECubeStateFlags::None);
+	Cubes.Add(Cube);
+
+	FCubeHandle Handle;
+	Handle.Index = SlotIndex;
+	Handle.Generation = Slot.Generation;
+	return Handle;
+}
+
+void FCubeStateStore::Remove(FCubeHandle Handle)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Keep the arrays dense: move the last cube into the gap and repoint its slot
+	const int32 LastIndex = Healths.Num() - 1;
+	if (DenseIndex != LastIndex)
+	{
+		Healths[DenseIndex] = Healths[LastIndex];
+		MaxHealths[DenseIndex] = MaxHealths[LastIndex];
+		Flags[DenseIndex] = Flags[LastIndex];
+		Cubes[DenseIndex] = Cubes[LastIndex];
+		DenseToSlot[DenseIndex] = DenseToSlot[LastIndex];
+		Slots[DenseToSlot[DenseIndex]].DenseIndex = DenseIndex;
+	}
+
+	Healths.Pop(EAllowShrinking::No);
+	MaxHealths.Pop(EAllowShrinking::No);
+	Flags.Pop(EAllowShrinking::No);
+	Cubes.Pop(EAllowShrinking::No);
+	DenseToSlot.Pop(EAllowShrinking::No);
+
+	FSlot& Slot = Slots[Handle.Index];
+	Slot.DenseIndex = INDEX_NONE;
+	Slot.Generation++;
+	FreeSlots.Add(Handle.Index);
+}
+
+void FCubeStateStore::Reserve(int32 Number)
+{
+	Healths.Reserve(Number);
+	MaxHealths.Reserve(Number);
+	Flags.Reserve(Number);
+	Cubes.Reserve(Number);
+	DenseToSlot.Reserve(Number);
+	Slots.Reserve(Number);
+}
+
+void FCubeStateStore::Reset()
+{
+	Healths.Empty();
+	MaxHealths.Empty();
+	Flags.Empty();
+	Cubes.Empty();
+	Slots.Empty();
+	DenseToSlot.Empty();
+	FreeSlots.Empty();
+}
+
+int32 FCubeStateStore::GetDenseIndex(FCubeHandle Handle) const
+{
+	if (!Slots.IsValidIndex(Handle.Index) || Slots[Handle.Index].Generation != Handle.Generation)
+	{
+		return INDEX_NONE;
+	}
+	return Slots[Handle.Index].DenseIndex;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UCubeStateSubsystem
+
+void UCubeStateSubsystem::Deinitialize()
+{
+#if STATS && LIQUIDX_STATS
+	for (const ECubeStateFlags Flags : Store.Flags)
+	{
+		CountCubeState(Flags, false);
+	}
+#endif
+	Store.Reset();
+
+	Super::Deinitialize();
+}
+
+FCubeHandle UCubeStateSubsystem::RegisterCube(APickupCube* Cube, float Health, float MaxHealth)
+{
+#if STATS && LIQUIDX_STATS
+	CountCubeState(ECubeStateFlags::None, true);
+#endif
+	return Store.Add(Cube, Health, MaxHealth);
+}
+
+void UCubeStateSubsystem::UnregisterCube(FCubeHandle Handle)
+{
+#if STATS && LIQUIDX_STATS
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	if (DenseIndex != INDEX_NONE)
+	{
+		CountCubeState(Store.Flags[DenseIndex], false);
+	}
+#endif
+	Store.Remove(Handle);
+}
+
+float UCubeStateSubsystem::GetHealth(FCubeHandle Handle) const
+{
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? Store.Healths[DenseIndex] : 0.0f;
+}
+
+void UCubeStateSubsystem::SetHealth(FCubeHandle Handle, float Health)
+{
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	if (DenseIndex != INDEX_NONE)
+	{
+		Store.Healths[DenseIndex] = Health;
+	}
+}
+
+float UCubeStateSubsystem::GetMaxHealth(FCubeHandle Handle) const
+{
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? Store.MaxHealths[DenseIndex] : 0.0f;
+}
+
+void UCubeStateSubsystem::SetMaxHealth(FCubeHandle Handle, float MaxHealth)
+{
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	if (DenseIndex != INDEX_NONE)
+	{
+		Store.MaxHealths[DenseIndex] = MaxHealth;
+	}
+}
+
+bool UCubeStateSubsystem::HasFlag(FCubeHandle Handle, ECubeStateFlags Flag) const
+{
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE && EnumHasAnyFlags(Store.Flags[DenseIndex], Flag);
+}
+
+void UCubeStateSubsystem::SetFlag(FCubeHandle Handle, ECubeStateFlags Flag, bool bSet)
+{
+	const int32 DenseIndex = Store.GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+#if STATS && LIQUIDX_STATS
+	const ECubeStateFlags OldFlags = Store.Flags[DenseIndex];
+#endif
+
+	if (bSet)
+	{
+		EnumAddFlags(Store.Flags[DenseIndex], Flag);
+	}
+	else
+	{
+		EnumRemoveFlags(Store.Flags[DenseIndex], Flag);
+	}
+
+#if STATS && LIQUIDX_STATS
+	if (GetCubeStateStat(OldFlags) != GetCubeStateStat(Store.Flags[DenseIndex]))
+	{
+		CountCubeState(OldFlags, false);
+		CountCubeState(Store.Flags[DenseIndex], true);
+	}
+#endif
+}
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeStateSubsystem.h"
+#include "PickupCube.h"
+#include "LiquidXTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCubeStateStoreHandlesTest, "LiquidX.CubeState.StoreHandles",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/** Removing from the middle swaps the last cube into the gap; its handle must still find it */
+bool FCubeStateStoreHandlesTest::RunTest(const FString& Parameters)
+{
+	FCubeStateStore Store;
+	const FCubeHandle First = Store.Add(nullptr, 10.0f, 100.0f);
+	const FCubeHandle Middle = Store.Add(nullptr, 20.0f, 100.0f);
+	const FCubeHandle Last = Store.Add(nullptr, 30.0f, 100.0f);
+
+	Store.Remove(Middle);
+
+	TestEqual(TEXT("Cubes left"), Store.Num(), 2);
+	TestFalse(TEXT("Removed handle is stale"), Store.IsValid(Middle));
+	TestEqual(TEXT("First cube's health"), Store.Healths[Store.GetDenseIndex(First)], 10.0f);
+	TestEqual(TEXT("Moved cube's health"), Store.Healths[Store.GetDenseIndex(Last)], 30.0f);
+
+	// The freed slot is reused with a new generation, so the old handle stays stale
+	const FCubeHandle Reused = Store.Add(nullptr, 40.0f, 100.0f);
+	TestEqual(TEXT("Freed slot reused"), Reused.Index, Middle.Index);
+	TestFalse(TEXT("Old handle stale after reuse"), Store.IsValid(Middle));
+	TestEqual(TEXT("Reused slot's health"), Store.Healths[Store.GetDenseIndex(Reused)], 40.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCubeStateHealthSourceTest, "LiquidX.CubeState.HealthSource",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/** Cube health reads and writes go to the store entry */
+bool FCubeStateHealthSourceTest::RunTest(const FString& Parameters)
+{
+	FLiquidXTestWorld TestWorld;
+	UWorld* World = TestWorld.Get();
+	UCubeStateSubsystem* CubeState = World->GetSubsystem<UCubeStateSubsystem>();
+	APickupCube* Cube = World->SpawnActor<APickupCube>(FVector::ZeroVector, FRotator::ZeroRotator);
+	if (!TestNotNull(TEXT("Cube state subsystem"), CubeState) || !TestNotNull(TEXT("Cube"), Cube))
+	{
+		return false;
+	}
+
+	const FCubeHandle Handle = Cube->GetStateHandle();
+	TestTrue(TEXT("Cube registered"), CubeState->GetStore().IsValid(Handle));
+	TestEqual(TEXT("Starts at max health"), CubeState->GetHealth(Handle), Cube->GetMaxHealth());
+
+	Cube->SetCurrentHealth(25.0f);
+	TestEqual(TEXT("SetCurrentHealth writes the store"), CubeState->GetHealth(Handle), 25.0f);
+
+	CubeState->SetHealth(Handle, 60.0f);
+	TestEqual(TEXT("GetHealth reads the store"), Cube->GetHealth(), 60.0f);
+
+	Cube->SetHealthState(500.0f, 200.0f);
+	TestEqual(TEXT("Max health stored"), CubeState->GetMaxHealth(Handle), 200.0f);
+	TestEqual(TEXT("Health clamped to the new max"), CubeState->GetHealth(Handle), 200.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCubeStateHealthPassTest, "LiquidX.CubeState.HealthPass",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * One regen pass over 100k cubes in a store against the same pass made through 100k spawned cube
+ * actors, each reading and writing its health by itself. Best of ten passes each.
+ */
+bool FCubeStateHealthPassTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumCubes = 100000;
+	constexpr int32 NumPasses = 10;
+	constexpr float RegenAmount = 0.5f;
+
+	FLiquidXTestWorld TestWorld;
+	UWorld* World = TestWorld.Get();
+
+	// Store version: one dense pass over the arrays
+	FCubeStateStore Store;
+	Store.Reserve(NumCubes);
+	for (int32 Index = 0; Index < NumCubes; ++Index)
+	{
+		Store.Add(nullptr, 50.0f, 100.0f);
+	}
+
+	double StoreMs = TNumericLimits<double>::Max();
+	for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		float* Healths = Store.Healths.GetData();
+		const float* MaxHealths = Store.MaxHealths.GetData();
+		const ECubeStateFlags* Flags = Store.Flags.GetData();
+		for (int32 Index = 0; Index < NumCubes; ++Index)
+		{
+			if (!EnumHasAnyFlags(Flags[Index], ECubeStateFlags::InPool))
+			{
+				Healths[Index] = FMath::Min(MaxHealths[Index], Healths[Index] + RegenAmount);
+			}
+		}
+
+		StoreMs = FMath::Min(StoreMs, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+
+	// Actor version: the same pass cube by cube through the actor's own health calls
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<APickupCube*> Cubes;
+	Cubes.Reserve(NumCubes);
+	for (int32 Index = 0; Index < NumCubes; ++Index)
+	{
+		if (APickupCube* Cube = World->SpawnActor<APickupCube>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams))
+		{
+			Cube->SetHealthState(50.0f, 100.0f);
+			Cubes.Add(Cube);
+		}
+	}
+	if (!TestEqual(TEXT("Cubes spawned"), Cubes.Num(), NumCubes))
+	{
+		return false;
+	}
+
+	double ActorMs = TNumericLimits<double>::Max();
+	for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (APickupCube* Cube : Cubes)
+		{
+			if (!Cube->IsInPool())
+			{
+				Cube->SetCurrentHealth(FMath::Min(Cube->GetMaxHealth(), Cube->GetHealth() + RegenAmount));
+			}
+		}
+
+		ActorMs = FMath::Min(ActorMs, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+
+	for (APickupCube* Cube : Cubes)
+	{
+		World->DestroyActor(Cube);
+	}
+
+	AddInfo(FString::Printf(TEXT("%d cubes, best health pass: store %.3f ms, actors %.3f ms (%.1fx)"),
+		NumCubes, StoreMs, ActorMs, StoreMs > 0.0 ? ActorMs / StoreMs : 0.0));
+	TestTrue(TEXT("The store pass is faster than the actor pass"), StoreMs < ActorMs);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
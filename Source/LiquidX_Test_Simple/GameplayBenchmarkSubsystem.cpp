@@ -0,0 +1,501 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayBenchmarkSubsystem.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "PickupCube.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Engine/World.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "Dom/JsonObject.h"
+#include "Misc/CommandLine.h"
+#include "UObject/UObjectArray.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGameplayBenchmark, Log, All);
+
+static bool ParseScenario(const FString& Name, EGameplayBenchmarkScenario& OutScenario)
+{
+	const int64 Value = StaticEnum<EGameplayBenchmarkScenario>()->GetValueByNameString(Name);
+	if (Value == INDEX_NONE)
+	{
+		return false;
+	}
+	OutScenario = EGameplayBenchmarkScenario(Value);
+	return true;
+}
+
+static FString GetScenarioName(EGameplayBenchmarkScenario Scenario)
+{
+	return StaticEnum<EGameplayBenchmarkScenario>()->GetNameStringByValue(int64(Scenario));
+}
+
+void UGameplayBenchmarkSubsystem::Deinitialize()
+{
+	if (IsRunning())
+	{
+		StopBenchmark();
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UGameplayBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UGameplayBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString ScenarioName;
+	if (!CommandLineRun.Claim(InWorld, TEXT("LiquidXBench"), ScenarioName))
+	{
+		return;
+	}
+
+	EGameplayBenchmarkScenario CommandLineScenario;
+	if (!ParseScenario(ScenarioName, CommandLineScenario))
+	{
+		UE_LOG(LogGameplayBenchmark, Error, TEXT("-LiquidXBench: unknown scenario '%s'"), *ScenarioName);
+		CommandLineRun.Finish(false);
+		return;
+	}
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	int32 CommandLineCharacters = DefaultNumCharacters;
+	int32 CommandLineCubes = DefaultNumCubes;
+	int32 CommandLineFrames = DefaultMeasureFrames;
+	FParse::Value(CommandLine, TEXT("BenchCharacters="), CommandLineCharacters);
+	FParse::Value(CommandLine, TEXT("BenchCubes="), CommandLineCubes);
+	FParse::Value(CommandLine, TEXT("BenchFrames="), CommandLineFrames);
+	FParse::Value(CommandLine, TEXT("BenchMaxGameThreadMs="), MaxGameThreadMs);
+	FParse::Value(CommandLine, TEXT("BenchMaxPhysicsMs="), MaxPhysicsMs);
+	FParse::Value(CommandLine, TEXT("BenchMaxTraces="), MaxTracesPerFrame);
+	FParse::Value(CommandLine, TEXT("BenchMaxMemoryGrowthMB="), MaxMemoryGrowthMB);
+
+	if (!StartBenchmark(CommandLineScenario, CommandLineCharacters, CommandLineCubes, CommandLineFrames))
+	{
+		CommandLineRun.Finish(false);
+	}
+}
+
+bool UGameplayBenchmarkSubsystem::StartBenchmark(EGameplayBenchmarkScenario InScenario, int32 InNumCharacters, int32 InNumCubes, int32 InMeasureFrames)
+{
+	UWorld* World = GetWorld();
+	if (IsRunning() || World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogGameplayBenchmark, Warning, TEXT("Benchmark not started: %s"), IsRunning() ? TEXT("a run is in progress") : TEXT("clients can't spawn the scenario"));
+		return false;
+	}
+
+	Scenario = InScenario;
+	bLastRunPassed = false;
+	NumCharacters = FMath::Max(1, InNumCharacters);
+	NumCubes = FMath::Max(0, InNumCubes);
+	MeasureFrames = FMath::Max(1, InMeasureFrames);
+	FrameInPhase = 0;
+	Samples.Reset(MeasureFrames);
+
+	SpawnScenario();
+
+	Sampler.Start(World,
+		[this](float DeltaSeconds) { PhysicsMsThisFrame = 0.0f; },
+		[this](const FPerfFrameTiming& Timing) { HandleFrame(Timing); });
+	GUObjectArray.AddUObjectCreateListener(&ObjectCreateCounter);
+	if (FPhysScene* PhysScene = World->GetPhysicsScene())
+	{
+		PhysicsPreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &UGameplayBenchmarkSubsystem::HandlePhysicsPreTick);
+		PhysicsPostTickHandle = PhysScene->OnPhysScenePostTick.AddUObject(this, &UGameplayBenchmarkSubsystem::HandlePhysicsPostTick);
+	}
+
+	Phase = EPhase::Warmup;
+	UE_LOG(LogGameplayBenchmark, Display, TEXT("Benchmark %s: %d characters, %d cubes, %d warmup + %d measured frames"),
+		*GetScenarioName(Scenario), NumCharacters, NumCubes, WarmupFrames, MeasureFrames);
+	return true;
+}
+
+void UGameplayBenchmarkSubsystem::StopBenchmark()
+{
+	if (IsRunning())
+	{
+		FinishBenchmark();
+	}
+}
+
+void UGameplayBenchmarkSubsystem::SpawnScenario()
+{
+	UWorld* World = GetWorld();
+
+	UClass* SpawnCharacterClass = CharacterClass.LoadSynchronous();
+	if (!SpawnCharacterClass)
+	{
+		SpawnCharacterClass = ALiquidX_Test_SimpleCharacter::StaticClass();
+	}
+
+	UClass* SpawnCubeClass = CubeClass.LoadSynchronous();
+	if (!SpawnCubeClass)
+	{
+		SpawnCubeClass = APickupCube::StaticClass();
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt(float(NumCharacters)));
+	TArray<FVector> CubeRingCentres;
+
+	ScriptedCharacters.Reset(NumCharacters);
+	for (int32 Index = 0; Index < NumCharacters; ++Index)
+	{
+		const FVector Location = Origin + FVector((Index % Side - Side / 2) * CharacterSpacing, (Index / Side - Side / 2) * CharacterSpacing, 0.0f);
+		const FTransform Transform(Location);
+
+		ALiquidX_Test_SimpleCharacter* Character = World->SpawnActor<ALiquidX_Test_SimpleCharacter>(SpawnCharacterClass, Transform, SpawnParams);
+		if (!Character)
+		{
+			continue;
+		}
+
+		// Nobody possesses them; movement has to run without a controller
+		Character->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+		Arena.Add(Character);
+
+		FScriptedCharacter& Scripted = ScriptedCharacters.AddDefaulted_GetRef();
+		Scripted.Character = Character;
+		Scripted.Start = Transform;
+		Scripted.Scenario = Scenario == EGameplayBenchmarkScenario::Mixed ? EGameplayBenchmarkScenario(Index % 4) : Scenario;
+
+		switch (Scripted.Scenario)
+		{
+		case EGameplayBenchmarkScenario::WallRun:
+		{
+			// A wall along the run, close enough on the right for the wall probes to reach
+			const float WallLength = CharacterSpacing * 0.9f;
+			const FVector WallLocation = Location + FVector(WallLength * 0.5f - 50.0f, 60.0f, 0.0f);
+			Arena.SpawnWall(World, WallLocation, FRotator::ZeroRotator, FVector(WallLength / 100.0f, 0.2f, 4.0f));
+			break;
+		}
+		case EGameplayBenchmarkScenario::Punch:
+		case EGameplayBenchmarkScenario::PickupThrow:
+			CubeRingCentres.Add(Location);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (NumCubes == 0)
+	{
+		return;
+	}
+
+	// Rings around the characters that use cubes, otherwise a field beside the characters as background load
+	TArray<FTransform> CubeTransforms;
+	CubeTransforms.Reserve(NumCubes);
+	if (CubeRingCentres.Num() > 0)
+	{
+		const int32 CubesPerRing = FMath::DivideAndRoundUp(NumCubes, CubeRingCentres.Num());
+		for (int32 Index = 0; Index < NumCubes; ++Index)
+		{
+			const int32 Ring = Index / CubesPerRing;
+			const int32 Slot = Index % CubesPerRing;
+			const float Angle = 2.0f * PI * Slot / CubesPerRing;
+			const float Radius = 120.0f + 60.0f * (Slot % 2);
+			CubeTransforms.Add(FTransform(CubeRingCentres[Ring] + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0f)));
+		}
+	}
+	else
+	{
+		const int32 CubeSide = FMath::CeilToInt32(FMath::Sqrt(float(NumCubes)));
+		const FVector FieldOrigin = Origin + FVector(0.0f, (Side / 2 + 1) * CharacterSpacing, 0.0f);
+		for (int32 Index = 0; Index < NumCubes; ++Index)
+		{
+			CubeTransforms.Add(FTransform(FieldOrigin + FVector((Index % CubeSide - CubeSide / 2) * 150.0f, (Index / CubeSide) * 150.0f, 0.0f)));
+		}
+	}
+
+	// Warmup covers the spawn cost
+	for (const FTransform& CubeTransform : CubeTransforms)
+	{
+		Arena.AcquireCube(World, SpawnCubeClass, CubeTransform);
+	}
+}
+
+void UGameplayBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	if (Phase == EPhase::Measure && Samples.Num() >= MeasureFrames)
+	{
+		FinishBenchmark();
+		return;
+	}
+
+	// Inputs given here are consumed by the movement and abilities next frame
+	const int32 Frame = Phase == EPhase::Warmup ? FrameInPhase : WarmupFrames + FrameInPhase;
+	for (int32 Index = 0; Index < ScriptedCharacters.Num(); ++Index)
+	{
+		// Offset each character so their actions don't all land on the same frame
+		DriveCharacter(ScriptedCharacters[Index], Frame + Index * 7);
+	}
+
+	++FrameInPhase;
+	if (Phase == EPhase::Warmup && FrameInPhase >= WarmupFrames)
+	{
+		Phase = EPhase::Measure;
+		FrameInPhase = 0;
+		MeasureStartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+		ObjectCreateCounter.NumCreated = 0;
+		LastUsedPhysical = MeasureStartUsedPhysical;
+	}
+}
+
+void UGameplayBenchmarkSubsystem::DriveCharacter(FScriptedCharacter& Scripted, int32 CharacterFrame)
+{
+	ALiquidX_Test_SimpleCharacter* Character = Scripted.Character.Get();
+	if (!Character)
+	{
+		return;
+	}
+
+	const bool bAction = CharacterFrame % ActionInterval == 0;
+	switch (Scripted.Scenario)
+	{
+	case EGameplayBenchmarkScenario::WallRun:
+		// Back to the start of the wall and jump at it again
+		if (bAction)
+		{
+			Character->SetActorTransform(Scripted.Start, false, nullptr, ETeleportType::ResetPhysics);
+			Character->GetCharacterMovement()->StopMovementImmediately();
+			Character->Jump();
+		}
+		Character->AddMovementInput(Scripted.Start.GetUnitAxis(EAxis::X));
+		break;
+
+	case EGameplayBenchmarkScenario::Jetpack:
+	{
+		// Jump, burn for two intervals, then land and refuel for one
+		const int32 Cycle = CharacterFrame % (ActionInterval * 4);
+		if (Cycle == 0)
+		{
+			Character->Jump();
+		}
+		else if (Cycle > 5 && Cycle < ActionInterval * 3)
+		{
+			Character->ActivateJetpack();
+		}
+		else if (Cycle == ActionInterval * 3)
+		{
+			Character->DeactivateJetpack();
+		}
+		Character->AddMovementInput(FRotator(0.0f, CharacterFrame * 2.0f, 0.0f).Vector());
+		break;
+	}
+
+	case EGameplayBenchmarkScenario::Punch:
+		Character->SetActorRotation(FRotator(0.0f, CharacterFrame * 4.0f, 0.0f));
+		if (bAction)
+		{
+			Character->PunchCube();
+		}
+		break;
+
+	case EGameplayBenchmarkScenario::PickupThrow:
+		Character->SetActorRotation(FRotator(0.0f, CharacterFrame * 2.0f, 0.0f));
+		if (bAction)
+		{
+			if (Character->GetHeldCube())
+			{
+				Character->ThrowCube();
+			}
+			else
+			{
+				Character->PickupCube();
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UGameplayBenchmarkSubsystem::FinishBenchmark()
+{
+	Sampler.Stop();
+	GUObjectArray.RemoveUObjectCreateListener(&ObjectCreateCounter);
+	if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+	{
+		PhysScene->OnPhysScenePreTick.Remove(PhysicsPreTickHandle);
+		PhysScene->OnPhysScenePostTick.Remove(PhysicsPostTickHandle);
+	}
+
+	const bool bPassed = WriteResults();
+	bLastRunPassed = bPassed;
+
+	Arena.Clear(GetWorld());
+	ScriptedCharacters.Empty();
+	Samples.Empty();
+	Phase = EPhase::Idle;
+
+	CommandLineRun.Finish(bPassed);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Measurement
+
+void UGameplayBenchmarkSubsystem::HandleFrame(const FPerfFrameTiming& Timing)
+{
+	if (Phase != EPhase::Measure || !Timing.bHasFrameMs)
+	{
+		return;
+	}
+
+	FFrameSample& Sample = Samples.AddDefaulted_GetRef();
+	Sample.GameThreadMs = Timing.GameThreadMs;
+	Sample.FrameMs = Timing.FrameMs;
+	Sample.PhysicsMs = PhysicsMsThisFrame;
+	Sample.NumTraces = Timing.NumTraces;
+
+	const uint64 UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	Sample.MemoryDeltaKB = float((int64(UsedPhysical) - int64(LastUsedPhysical)) / 1024.0);
+	LastUsedPhysical = UsedPhysical;
+	Sample.NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	Sample.NumObjectsCreated = ObjectCreateCounter.NumCreated.exchange(0);
+}
+
+void UGameplayBenchmarkSubsystem::HandlePhysicsPreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds)
+{
+	PhysicsStartCycles = FPlatformTime::Cycles64();
+}
+
+void UGameplayBenchmarkSubsystem::HandlePhysicsPostTick(FPhysScene_Chaos* PhysScene)
+{
+	// Start to end of the physics frame on the game thread, including waiting for the solver
+	PhysicsMsThisFrame += float(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - PhysicsStartCycles));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Results
+
+bool UGameplayBenchmarkSubsystem::WriteResults()
+{
+	const FString ScenarioName = GetScenarioName(Scenario);
+	const FString OutputPath = FPerfReport::GetOutputPath(TEXT("BenchOutput"), TEXT("Benchmarks"), ScenarioName);
+
+	// Per-frame CSV
+	FString Csv = TEXT("Frame,FrameMs,GameThreadMs,PhysicsMs,Traces,MemoryDeltaKB,UObjects,UObjectsCreated\n");
+	for (int32 Index = 0; Index < Samples.Num(); ++Index)
+	{
+		const FFrameSample& Sample = Samples[Index];
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%d,%.1f,%d,%d\n"),
+			Index, Sample.FrameMs, Sample.GameThreadMs, Sample.PhysicsMs, Sample.NumTraces, Sample.MemoryDeltaKB, Sample.NumObjects, Sample.NumObjectsCreated);
+	}
+
+	// Summary JSON
+	const FPerfPercentiles FrameMs = FPerfPercentiles::Compute(Samples, [](const FFrameSample& Sample) { return Sample.FrameMs; });
+	const FPerfPercentiles GameThreadMs = FPerfPercentiles::Compute(Samples, [](const FFrameSample& Sample) { return Sample.GameThreadMs; });
+	const FPerfPercentiles PhysicsMs = FPerfPercentiles::Compute(Samples, [](const FFrameSample& Sample) { return Sample.PhysicsMs; });
+	const FPerfPercentiles Traces = FPerfPercentiles::Compute(Samples, [](const FFrameSample& Sample) { return Sample.NumTraces; });
+	const FPerfPercentiles MemoryDeltaKB = FPerfPercentiles::Compute(Samples, [](const FFrameSample& Sample) { return Sample.MemoryDeltaKB; });
+	const FPerfPercentiles ObjectsCreated = FPerfPercentiles::Compute(Samples, [](const FFrameSample& Sample) { return Sample.NumObjectsCreated; });
+
+	TSharedRef<FJsonObject> Metrics = MakeShared<FJsonObject>();
+	Metrics->SetObjectField(TEXT("frameMs"), FrameMs.ToJson());
+	Metrics->SetObjectField(TEXT("gameThreadMs"), GameThreadMs.ToJson());
+	Metrics->SetObjectField(TEXT("physicsMs"), PhysicsMs.ToJson());
+	Metrics->SetObjectField(TEXT("traces"), Traces.ToJson());
+	Metrics->SetObjectField(TEXT("memoryDeltaKB"), MemoryDeltaKB.ToJson());
+	Metrics->SetObjectField(TEXT("uobjectsCreated"), ObjectsCreated.ToJson());
+
+	const double MemoryGrowthMB = (int64(LastUsedPhysical) - int64(MeasureStartUsedPhysical)) / (1024.0 * 1024.0);
+	Metrics->SetNumberField(TEXT("memoryGrowthMB"), MemoryGrowthMB);
+	Metrics->SetNumberField(TEXT("uobjects"), Samples.Num() > 0 ? Samples.Last().NumObjects : 0);
+
+	TArray<TSharedPtr<FJsonValue>> Failures;
+	auto CheckThreshold = [&Failures](const TCHAR* Name, double Value, float Limit)
+	{
+		if (Limit > 0.0f && Value > Limit)
+		{
+			Failures.Add(MakeShared<FJsonValueString>(FString::Printf(TEXT("%s %.3f > %.3f"), Name, Value, Limit)));
+		}
+	};
+	CheckThreshold(TEXT("gameThreadMs p95"), GameThreadMs.P95, MaxGameThreadMs);
+	CheckThreshold(TEXT("physicsMs p95"), PhysicsMs.P95, MaxPhysicsMs);
+	CheckThreshold(TEXT("traces avg"), Traces.Average, MaxTracesPerFrame);
+	CheckThreshold(TEXT("memoryGrowthMB"), MemoryGrowthMB, MaxMemoryGrowthMB);
+	if (Samples.Num() < MeasureFrames)
+	{
+		Failures.Add(MakeShared<FJsonValueString>(FString::Printf(TEXT("stopped after %d of %d frames"), Samples.Num(), MeasureFrames)));
+	}
+
+	TSharedRef<FJsonObject> Thresholds = MakeShared<FJsonObject>();
+	Thresholds->SetNumberField(TEXT("gameThreadMsP95"), MaxGameThreadMs);
+	Thresholds->SetNumberField(TEXT("physicsMsP95"), MaxPhysicsMs);
+	Thresholds->SetNumberField(TEXT("tracesAvg"), MaxTracesPerFrame);
+	Thresholds->SetNumberField(TEXT("memoryGrowthMB"), MaxMemoryGrowthMB);
+
+	TSharedRef<FJsonObject> Root = FPerfReport::MakeJson(GetWorld());
+	Root->SetStringField(TEXT("scenario"), ScenarioName);
+	Root->SetNumberField(TEXT("characters"), ScriptedCharacters.Num());
+	Root->SetNumberField(TEXT("cubes"), NumCubes);
+	Root->SetNumberField(TEXT("warmupFrames"), WarmupFrames);
+	Root->SetNumberField(TEXT("frames"), Samples.Num());
+	Root->SetObjectField(TEXT("metrics"), Metrics);
+	Root->SetObjectField(TEXT("thresholds"), Thresholds);
+	Root->SetArrayField(TEXT("failures"), Failures);
+	Root->SetBoolField(TEXT("passed"), Failures.Num() == 0);
+	FPerfReport::Write(OutputPath, Csv, Root);
+
+	UE_LOG(LogGameplayBenchmark, Display, TEXT("Benchmark %s: %d frames, frame %.2f ms, game thread avg %.2f p95 %.2f ms, physics avg %.2f p95 %.2f ms, traces %.1f/frame, memory %+.1f MB -> %s.json"),
+		*ScenarioName, Samples.Num(), FrameMs.Average, GameThreadMs.Average, GameThreadMs.P95, PhysicsMs.Average, PhysicsMs.P95, Traces.Average, MemoryGrowthMB, *OutputPath);
+	for (const TSharedPtr<FJsonValue>& Failure : Failures)
+	{
+		UE_LOG(LogGameplayBenchmark, Error, TEXT("Benchmark threshold failed: %s"), *Failure->AsString());
+	}
+
+	return Failures.Num() == 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void RunGameplayBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	UGameplayBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<UGameplayBenchmarkSubsystem>() : nullptr;
+	EGameplayBenchmarkScenario Scenario;
+	if (!Benchmark || Args.Num() < 1 || !ParseScenario(Args[0], Scenario))
+	{
+		UE_LOG(LogGameplayBenchmark, Warning, TEXT("Usage: LiquidX.Bench.Run <WallRun|Jetpack|Punch|PickupThrow|Mixed> [Characters] [Cubes] [Frames]"));
+		return;
+	}
+
+	Benchmark->StartBenchmark(Scenario,
+		Args.Num() > 1 ? FCString::Atoi(*Args[1]) : Benchmark->DefaultNumCharacters,
+		Args.Num() > 2 ? FCString::Atoi(*Args[2]) : Benchmark->DefaultNumCubes,
+		Args.Num() > 3 ? FCString::Atoi(*Args[3]) : Benchmark->DefaultMeasureFrames);
+}
+
+static void StopGameplayBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (UGameplayBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<UGameplayBenchmarkSubsystem>() : nullptr)
+	{
+		Benchmark->StopBenchmark();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RunBenchmarkCommand(
+	TEXT("LiquidX.Bench.Run"),
+	TEXT("Spawn a scripted gameplay scenario, measure it and write the results to Saved/Benchmarks"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunGameplayBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs StopBenchmarkCommand(
+	TEXT("LiquidX.Bench.Stop"),
+	TEXT("End the running gameplay benchmark early and write what was measured"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopGameplayBenchmark));
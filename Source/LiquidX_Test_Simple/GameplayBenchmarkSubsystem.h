@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LiquidXPerfRun.h"
+#include "UObject/UObjectArray.h"
+#include <atomic>
+#include "GameplayBenchmarkSubsystem.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+class APickupCube;
+class FPhysScene_Chaos;
+
+/** What the benchmark characters do every frame */
+UENUM()
+enum class EGameplayBenchmarkScenario : uint8
+{
+	/** Run and jump along a wall next to each character */
+	WallRun,
+	/** Jump and hold the jetpack until the fuel runs out, then land and refuel */
+	Jetpack,
+	/** Turn on the spot and punch the ring of cubes around each character */
+	Punch,
+	/** Pick up and throw the cubes around each character */
+	PickupThrow,
+	/** Every fourth character does each of the above */
+	Mixed
+};
+
+/**
+ * Scripted gameplay benchmark for headless CI runs. Spawns NumCharacters characters driven by a
+ * scenario and NumCubes cubes around them, lets the scene warm up, then records every frame's
+ * frame time, world tick (game thread) time, physics frame time, gameplay trace count, memory growth,
+ * UObjects created and live UObjects. Results go to Saved/Benchmarks as a per-frame CSV and a JSON summary with
+ * average, median, 95th percentile and max. Any configured threshold that is exceeded fails the run.
+ * Trace counts come from the LiquidXStats.h query counters and read 0 in Shipping.
+ *
+ * Started from the command line, the process exits when the run finishes, with exit code 1 on a
+ * failed threshold:
+ *   LiquidX_Test_Simple -nullrhi -unattended -nosound -LiquidXBench=Mixed [-BenchCharacters=N]
+ *     [-BenchCubes=M] [-BenchFrames=F] [-BenchOutput=<Path>] [-BenchMaxGameThreadMs=X]
+ *     [-BenchMaxPhysicsMs=X] [-BenchMaxTraces=X] [-BenchMaxMemoryGrowthMB=X]
+ * or from the console with LiquidX.Bench.Run <Scenario> [Characters] [Cubes] [Frames]. The
+ * LiquidX.Benchmark.<Scenario> automation tests run each scenario against the shipped thresholds.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UGameplayBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Spawn the scenario and start warming up. Fails while a run is in progress or on a network client. */
+	bool StartBenchmark(EGameplayBenchmarkScenario InScenario, int32 InNumCharacters, int32 InNumCubes, int32 InMeasureFrames);
+
+	/** End the run now, write what was measured and remove the spawned characters */
+	void StopBenchmark();
+
+	bool IsRunning() const { return Phase != EPhase::Idle; }
+
+	/** Whether the last finished run measured every frame and stayed within every threshold */
+	bool DidLastRunPass() const { return bLastRunPassed; }
+
+	/** Character spawned for the benchmark; the plain native class when this doesn't load */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark")
+	TSoftClassPtr<ALiquidX_Test_SimpleCharacter> CharacterClass;
+
+	/** Cube spawned for the benchmark; the plain native class when this doesn't load */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark")
+	TSoftClassPtr<APickupCube> CubeClass;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark", meta = (ClampMin = "1"))
+	int32 DefaultNumCharacters = 16;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark", meta = (ClampMin = "0"))
+	int32 DefaultNumCubes = 512;
+
+	/** Frames run before measuring, long enough for the cube pool to finish spawning */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark", meta = (ClampMin = "0"))
+	int32 WarmupFrames = 180;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark", meta = (ClampMin = "1"))
+	int32 DefaultMeasureFrames = 600;
+
+	/** Grid spacing between benchmark characters */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark")
+	float CharacterSpacing = 500.0f;
+
+	/** Centre of the character grid */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark")
+	FVector Origin = FVector(0.0f, 0.0f, 200.0f);
+
+	/** Frames between jumps, punches and pickups/throws of one character */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark", meta = (ClampMin = "1"))
+	int32 ActionInterval = 45;
+
+	// Thresholds, 0 disables; each can be overridden on the command line
+	/** 95th percentile world tick time in ms (-BenchMaxGameThreadMs); half a 60 Hz frame */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark|Thresholds")
+	float MaxGameThreadMs = 8.0f;
+
+	/** 95th percentile physics frame time in ms (-BenchMaxPhysicsMs) */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark|Thresholds")
+	float MaxPhysicsMs = 4.0f;
+
+	/** Average gameplay traces per frame (-BenchMaxTraces) */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark|Thresholds")
+	float MaxTracesPerFrame = 128.0f;
+
+	/** Physical memory growth over the measured frames in MB (-BenchMaxMemoryGrowthMB) */
+	UPROPERTY(Config, EditAnywhere, Category = "Benchmark|Thresholds")
+	float MaxMemoryGrowthMB = 64.0f;
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		Warmup,
+		Measure
+	};
+
+	struct FFrameSample
+	{
+		float FrameMs = 0.0f;
+		float GameThreadMs = 0.0f;
+		float PhysicsMs = 0.0f;
+		int32 NumTraces = 0;
+		float MemoryDeltaKB = 0.0f;
+		int32 NumObjects = 0;
+		int32 NumObjectsCreated = 0;
+	};
+
+	/** Counts UObject allocations; objects can be created off the game thread by async loading */
+	struct FObjectCreateCounter : public FUObjectArray::FUObjectCreateListener
+	{
+		virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override { NumCreated.fetch_add(1, std::memory_order_relaxed); }
+		virtual void OnUObjectArrayShutdown() override { GUObjectArray.RemoveUObjectCreateListener(this); }
+
+		std::atomic<int32> NumCreated = 0;
+	};
+
+	struct FScriptedCharacter
+	{
+		TWeakObjectPtr<ALiquidX_Test_SimpleCharacter> Character;
+		FTransform Start;
+		EGameplayBenchmarkScenario Scenario = EGameplayBenchmarkScenario::WallRun;
+	};
+
+	void SpawnScenario();
+	void DriveCharacter(FScriptedCharacter& Scripted, int32 CharacterFrame);
+	void FinishBenchmark();
+
+	/** Write the CSV and JSON and return whether every threshold held */
+	bool WriteResults();
+
+	void HandleFrame(const FPerfFrameTiming& Timing);
+	void HandlePhysicsPreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds);
+	void HandlePhysicsPostTick(FPhysScene_Chaos* PhysScene);
+
+	EPhase Phase = EPhase::Idle;
+	EGameplayBenchmarkScenario Scenario = EGameplayBenchmarkScenario::Mixed;
+	int32 NumCharacters = 0;
+	int32 NumCubes = 0;
+	int32 MeasureFrames = 0;
+	int32 FrameInPhase = 0;
+
+	/** -LiquidXBench; exit with the result when done */
+	FPerfCommandLineRun CommandLineRun;
+
+	bool bLastRunPassed = false;
+
+	TArray<FScriptedCharacter> ScriptedCharacters;
+
+	/** Characters, walls and pooled cubes of the scenario, removed when the run ends */
+	FPerfArena Arena;
+
+	FPerfFrameSampler Sampler;
+	TArray<FFrameSample> Samples;
+
+	// Physics timing, in FPlatformTime cycles
+	uint64 PhysicsStartCycles = 0;
+	float PhysicsMsThisFrame = 0.0f;
+	uint64 LastUsedPhysical = 0;
+	uint64 MeasureStartUsedPhysical = 0;
+	FObjectCreateCounter ObjectCreateCounter;
+
+	FDelegateHandle PhysicsPreTickHandle;
+	FDelegateHandle PhysicsPostTickHandle;
+};
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayBenchmarkSubsystem.h"
+#include "LiquidXTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GameplayBenchmarkTests
+{
+	/**
+	 * Run Scenario at the configured character, cube and frame counts, failing on the thresholds in
+	 * [GameplayBenchmarkSubsystem]. Results are written to Saved/Benchmarks like a -LiquidXBench run.
+	 */
+	static bool RunScenario(FAutomationTestBase& Test, EGameplayBenchmarkScenario Scenario)
+	{
+		FLiquidXTestWorld TestWorld;
+		UGameplayBenchmarkSubsystem* Benchmark = TestWorld.Get()->GetSubsystem<UGameplayBenchmarkSubsystem>();
+		if (!Test.TestNotNull(TEXT("Benchmark subsystem"), Benchmark))
+		{
+			return false;
+		}
+
+		if (!Test.TestTrue(TEXT("Benchmark started"), Benchmark->StartBenchmark(Scenario,
+			Benchmark->DefaultNumCharacters, Benchmark->DefaultNumCubes, Benchmark->DefaultMeasureFrames)))
+		{
+			return false;
+		}
+
+		// Warmup and measured frames, plus the frame that finishes the run
+		const int32 NumFrames = Benchmark->WarmupFrames + Benchmark->DefaultMeasureFrames + 2;
+		const double FrameMs = TestWorld.Tick(NumFrames);
+		if (Benchmark->IsRunning())
+		{
+			Test.AddError(FString::Printf(TEXT("Benchmark still running after %d frames"), NumFrames));
+			Benchmark->StopBenchmark();
+			return false;
+		}
+
+		Test.AddInfo(FString::Printf(TEXT("%d frames at %.3f ms/frame"), NumFrames, FrameMs));
+		Test.TestTrue(TEXT("Every threshold held"), Benchmark->DidLastRunPass());
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayBenchmarkWallRunTest, "LiquidX.Benchmark.WallRun",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameplayBenchmarkWallRunTest::RunTest(const FString& Parameters)
+{
+	return GameplayBenchmarkTests::RunScenario(*this, EGameplayBenchmarkScenario::WallRun);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayBenchmarkJetpackTest, "LiquidX.Benchmark.Jetpack",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameplayBenchmarkJetpackTest::RunTest(const FString& Parameters)
+{
+	return GameplayBenchmarkTests::RunScenario(*this, EGameplayBenchmarkScenario::Jetpack);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayBenchmarkPunchTest, "LiquidX.Benchmark.Punch",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameplayBenchmarkPunchTest::RunTest(const FString& Parameters)
+{
+	return GameplayBenchmarkTests::RunScenario(*this, EGameplayBenchmarkScenario::Punch);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayBenchmarkPickupThrowTest, "LiquidX.Benchmark.PickupThrow",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameplayBenchmarkPickupThrowTest::RunTest(const FString& Parameters)
+{
+	return GameplayBenchmarkTests::RunScenario(*this, EGameplayBenchmarkScenario::PickupThrow);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayBenchmarkMixedTest, "LiquidX.Benchmark.Mixed",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameplayBenchmarkMixedTest::RunTest(const FString& Parameters)
+{
+	return GameplayBenchmarkTests::RunScenario(*this, EGameplayBenchmarkScenario::Mixed);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
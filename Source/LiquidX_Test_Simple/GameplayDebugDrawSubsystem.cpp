@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayDebugDrawSubsystem.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<bool> CVarDebugPickup(
+	TEXT("LiquidX.Debug.Pickup"), false,
+	TEXT("Draw the cube pickup sweep and trace"));
+
+static TAutoConsoleVariable<bool> CVarDebugInteract(
+	TEXT("LiquidX.Debug.Interact"), false,
+	TEXT("Draw the interaction trace"));
+
+static TAutoConsoleVariable<bool> CVarDebugPunch(
+	TEXT("LiquidX.Debug.Punch"), false,
+	TEXT("Draw the punch trace"));
+
+static TAutoConsoleVariable<bool> CVarDebugWallRun(
+	TEXT("LiquidX.Debug.WallRun"), false,
+	TEXT("Draw the wall-run probes and wall confirmation traces, green on a hit"));
+
+static TAutoConsoleVariable<float> CVarDebugDuration(
+	TEXT("LiquidX.Debug.Duration"), 1.0f,
+	TEXT("Seconds each LiquidX debug primitive stays on screen"));
+
+bool UGameplayDebugDrawSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if LIQUIDX_DEBUG_DRAW
+	return Super::ShouldCreateSubsystem(Outer) && !IsRunningDedicatedServer();
+#else
+	return false;
+#endif
+}
+
+void UGameplayDebugDrawSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Ring.SetNum(FMath::Max(1, RingCapacity));
+	Lines.Reserve(RingCapacity);
+}
+
+void UGameplayDebugDrawSubsystem::Deinitialize()
+{
+	Ring.Empty();
+	Lines.Empty();
+	RingHead = 0;
+	RingNum = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UGameplayDebugDrawSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayDebugDrawSubsystem, STATGROUP_Tickables);
+}
+
+bool UGameplayDebugDrawSubsystem::IsCategoryEnabled(EGameplayDebugCategory Category)
+{
+	switch (Category)
+	{
+	case EGameplayDebugCategory::Pickup:
+		return CVarDebugPickup.GetValueOnGameThread();
+	case EGameplayDebugCategory::Interact:
+		return CVarDebugInteract.GetValueOnGameThread();
+	case EGameplayDebugCategory::Punch:
+		return CVarDebugPunch.GetValueOnGameThread();
+	case EGameplayDebugCategory::WallRun:
+		return CVarDebugWallRun.GetValueOnGameThread();
+	default:
+		return false;
+	}
+}
+
+void UGameplayDebugDrawSubsystem::AddLine(const UWorld* World, const FVector& Start, const FVector& End, const FColor& Color)
+{
+	if (UGameplayDebugDrawSubsystem* DebugDraw = World ? World->GetSubsystem<UGameplayDebugDrawSubsystem>() : nullptr)
+	{
+		FPrimitive& Line = DebugDraw->AddPrimitive();
+		Line.Start = Start;
+		Line.End = End;
+		Line.Color = Color;
+		Line.bSphere = false;
+	}
+}
+
+void UGameplayDebugDrawSubsystem::AddSphere(const UWorld* World, const FVector& Center, float Radius, const FColor& Color)
+{
+	if (UGameplayDebugDrawSubsystem* DebugDraw = World ? World->GetSubsystem<UGameplayDebugDrawSubsystem>() : nullptr)
+	{
+		FPrimitive& Sphere = DebugDraw->AddPrimitive();
+		Sphere.Start = Center;
+		Sphere.Radius = Radius;
+		Sphere.Color = Color;
+		Sphere.bSphere = true;
+	}
+}
+
+UGameplayDebugDrawSubsystem::FPrimitive& UGameplayDebugDrawSubsystem::AddPrimitive()
+{
+	// Full: overwrite the oldest
+	const int32 Index = (RingHead + RingNum) % Ring.Num();
+	if (RingNum < Ring.Num())
+	{
+		++RingNum;
+	}
+	else
+	{
+		RingHead = (RingHead + 1) % Ring.Num();
+	}
+
+	FPrimitive& Primitive = Ring[Index];
+	Primitive.ExpireTime = GetWorld()->GetTimeSeconds() + CVarDebugDuration.GetValueOnGameThread();
+	return Primitive;
+}
+
+void UGameplayDebugDrawSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Drop expired entries from the front; with a fixed duration that is all of them
+	while (RingNum > 0 && Ring[RingHead].ExpireTime <= Now)
+	{
+		RingHead = (RingHead + 1) % Ring.Num();
+		--RingNum;
+	}
+
+	ULineBatchComponent* LineBatcher = GetWorld()->LineBatcher;
+	if (RingNum == 0 || !LineBatcher)
+	{
+		return;
+	}
+
+	Lines.Reset();
+	for (int32 Offset = 0; Offset < RingNum; ++Offset)
+	{
+		const FPrimitive& Primitive = Ring[(RingHead + Offset) % Ring.Num()];
+		if (Primitive.ExpireTime <= Now)
+		{
+			continue;
+		}
+
+		if (Primitive.bSphere)
+		{
+			AppendSphereLines(Primitive);
+		}
+		else
+		{
+			Lines.Emplace(Primitive.Start, Primitive.End, FLinearColor(Primitive.Color), 0.0f, 0.0f, SDPG_World);
+		}
+	}
+
+	// The world's line batcher is cleared every frame, so redrawing live entries each frame gives them their duration
+	LineBatcher->DrawLines(Lines);
+}
+
+void UGameplayDebugDrawSubsystem::AppendSphereLines(const FPrimitive& Sphere)
+{
+	const FLinearColor Color(Sphere.Color);
+	const float AngleStep = 2.0f * PI / SphereSegments;
+	const FVector Axes[3][2] = {
+		{ FVector::XAxisVector, FVector::YAxisVector },
+		{ FVector::XAxisVector, FVector::ZAxisVector },
+		{ FVector::YAxisVector, FVector::ZAxisVector }
+	};
+
+	for (const FVector (&Plane)[2] : Axes)
+	{
+		FVector Previous = Sphere.Start + Plane[0] * Sphere.Radius;
+		for (int32 Segment = 1; Segment <= SphereSegments; ++Segment)
+		{
+			float Sin, Cos;
+			FMath::SinCos(&Sin, &Cos, Segment * AngleStep);
+			const FVector Next = Sphere.Start + (Plane[0] * Cos + Plane[1] * Sin) * Sphere.Radius;
+			Lines.Emplace(Previous, Next, Color, 0.0f, 0.0f, SDPG_World);
+			Previous = Next;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/LineBatchComponent.h"
+#include "GameplayDebugDrawSubsystem.generated.h"
+
+/** Debug-draw categories, each switched by its own LiquidX.Debug.* console variable */
+enum class EGameplayDebugCategory : uint8
+{
+	/** LiquidX.Debug.Pickup: pickup sweep sphere and trace */
+	Pickup,
+	/** LiquidX.Debug.Interact: interaction trace */
+	Interact,
+	/** LiquidX.Debug.Punch: punch trace */
+	Punch,
+	/** LiquidX.Debug.WallRun: wall-run probes and wall confirmation, green on a hit */
+	WallRun,
+	Num
+};
+
+/**
+ * Debug visualization for gameplay code. Primitives are only recorded while their category's console
+ * variable is on, into a ring of RingCapacity preallocated entries (the oldest is overwritten when
+ * it is full). Once per frame the live ones are flushed to the world's line batcher in a single
+ * call, and each stays for LiquidX.Debug.Duration seconds. Call sites use the LIQUIDX_DEBUG_* macros,
+ * which cost one console variable read when their category is off and compile out in Shipping.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UGameplayDebugDrawSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static bool IsCategoryEnabled(EGameplayDebugCategory Category);
+
+	static void AddLine(const UWorld* World, const FVector& Start, const FVector& End, const FColor& Color);
+	static void AddSphere(const UWorld* World, const FVector& Center, float Radius, const FColor& Color);
+
+	/** Primitives kept at once */
+	UPROPERTY(Config, EditAnywhere, Category = "Debug", meta = (ClampMin = "1"))
+	int32 RingCapacity = 2048;
+
+	/** Line segments per circle of a sphere; a sphere is three circles */
+	UPROPERTY(Config, EditAnywhere, Category = "Debug", meta = (ClampMin = "4"))
+	int32 SphereSegments = 16;
+
+private:
+	struct FPrimitive
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		double ExpireTime = 0.0;
+		float Radius = 0.0f;
+		FColor Color = FColor::White;
+		bool bSphere = false;
+	};
+
+	FPrimitive& AddPrimitive();
+	void AppendSphereLines(const FPrimitive& Sphere);
+
+	TArray<FPrimitive> Ring;
+	int32 RingHead = 0;
+	int32 RingNum = 0;
+
+	/** Flush scratch, reused every frame */
+	TArray<FBatchedLine> Lines;
+};
+
+#define LIQUIDX_DEBUG_DRAW (ENABLE_DRAW_DEBUG && !UE_BUILD_SHIPPING)
+
+#if LIQUIDX_DEBUG_DRAW
+
+#define LIQUIDX_DEBUG_LINE(World, Category, Start, End, Color) \
+	do { if (UGameplayDebugDrawSubsystem::IsCategoryEnabled(EGameplayDebugCategory::Category)) { UGameplayDebugDrawSubsystem::AddLine(World, Start, End, Color); } } while (0)
+
+#define LIQUIDX_DEBUG_SPHERE(World, Category, Center, Radius, Color) \
+	do { if (UGameplayDebugDrawSubsystem::IsCategoryEnabled(EGameplayDebugCategory::Category)) { UGameplayDebugDrawSubsystem::AddSphere(World, Center, Radius, Color); } } while (0)
+
+#else
+
+#define LIQUIDX_DEBUG_LINE(World, Category, Start, End, Color) do { } while (0)
+#define LIQUIDX_DEBUG_SPHERE(World, Category, Center, Radius, Color) do { } while (0)
+
+#endif
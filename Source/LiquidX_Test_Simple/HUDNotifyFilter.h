@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Quantizes a value the HUD shows, so its owner only publishes a change notification when the
+ * display would visibly move: by at least Step of the range since the last notification, or onto
+ * either end of it. Keeps per-tick values like jetpack fuel from invalidating widgets every frame.
+ */
+struct FHUDNotifyFilter
+{
+	/** Value of the last notification; negative until the first */
+	float LastValue = -1.0f;
+
+	/** True, and remembers Value, when a notification is due */
+	bool Update(float Value, float Max, float Step)
+	{
+		if (LastValue >= 0.0f)
+		{
+			if (Value == LastValue)
+			{
+				return false;
+			}
+
+			const bool bAtEnd = Value <= 0.0f || Value >= Max;
+			if (!bAtEnd && FMath::Abs(Value - LastValue) < Step * Max)
+			{
+				return false;
+			}
+		}
+
+		LastValue = Value;
+		return true;
+	}
+
+	/** Make the next Update notify whatever the value */
+	void Reset() { LastValue = -1.0f; }
+};
@@ -0,0 +1,629 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InputRecordingSubsystem.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogInputRecording, Log, All);
+
+namespace InputRecording
+{
+	static constexpr uint32 Magic = 0x5249584C; // "LXIR"
+	static constexpr uint16 Version = 1;
+
+	/** Move axes as two signed bytes */
+	static uint32 QuantizeMove(const FVector2D& Value)
+	{
+		const int8 X = int8(FMath::RoundToInt(FMath::Clamp(Value.X, -1.0, 1.0) * 127.0));
+		const int8 Y = int8(FMath::RoundToInt(FMath::Clamp(Value.Y, -1.0, 1.0) * 127.0));
+		return uint32(uint8(X)) | (uint32(uint8(Y)) << 8);
+	}
+
+	static FVector2D DequantizeMove(uint32 Quantized)
+	{
+		return FVector2D(int8(Quantized & 0xFF) / 127.0, int8((Quantized >> 8) & 0xFF) / 127.0);
+	}
+
+	/** Pitch and yaw as two shorts */
+	static uint32 QuantizeRotation(const FRotator& Rotation)
+	{
+		return uint32(FRotator::CompressAxisToShort(Rotation.Pitch)) | (uint32(FRotator::CompressAxisToShort(Rotation.Yaw)) << 16);
+	}
+
+	static FVector2D DequantizeRotation(uint32 Quantized)
+	{
+		return FVector2D(FRotator::DecompressAxisFromShort(uint16(Quantized & 0xFFFF)), FRotator::DecompressAxisFromShort(uint16(Quantized >> 16)));
+	}
+}
+
+void UInputRecordingSubsystem::FRecordingHeader::Serialize(FArchive& Ar)
+{
+	Ar << MapName;
+	Ar << CharacterClass;
+	Ar << StartLocation;
+	Ar << StartRotation;
+	Ar << StartControlRotation;
+	Ar << Duration;
+	Ar << NumFrames;
+}
+
+void UInputRecordingSubsystem::Deinitialize()
+{
+	if (IsRecording())
+	{
+		StopRecording();
+	}
+	if (IsReplaying())
+	{
+		StopReplay();
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UInputRecordingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInputRecordingSubsystem, STATGROUP_Tickables);
+}
+
+void UInputRecordingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// A recording doesn't end the process, so it only needs the claim
+	FPerfCommandLineRun RecordCommandLineRun;
+	FString Path;
+	if (ReplayCommandLineRun.Claim(InWorld, TEXT("LiquidXReplay"), Path))
+	{
+		FParse::Value(FCommandLine::Get(), TEXT("ReplayFixedHz="), ReplayFixedHz);
+		if (!StartReplay(Path))
+		{
+			ReplayCommandLineRun.Finish(false);
+		}
+	}
+	else if (RecordCommandLineRun.Claim(InWorld, TEXT("LiquidXRecord"), Path))
+	{
+		// The local player's character usually isn't possessed yet
+		RecordingPath = Path;
+		bRecordWhenPossessed = true;
+	}
+}
+
+void UInputRecordingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bRecordWhenPossessed)
+	{
+		const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+		if (ALiquidX_Test_SimpleCharacter* Character = PlayerController ? Cast<ALiquidX_Test_SimpleCharacter>(PlayerController->GetPawn()) : nullptr)
+		{
+			bRecordWhenPossessed = false;
+			StartRecording(Character, RecordingPath);
+		}
+	}
+
+	if (IsRecording())
+	{
+		if (RecordedCharacter.IsValid())
+		{
+			FlushRecordedFrame();
+		}
+		else
+		{
+			StopRecording();
+		}
+	}
+
+	if (IsReplaying())
+	{
+		if (!IsValid(ReplayCharacter))
+		{
+			UE_LOG(LogInputRecording, Warning, TEXT("Replay %s: the replayed character was destroyed"), *ReplayName);
+			FinishReplay();
+			return;
+		}
+
+		// This frame's events were applied by AdvanceReplay as it started
+		if (NextReplayFrame >= ReplayFrames.Num() && ReplayTime >= ReplayHeader.Duration)
+		{
+			FinishReplay();
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Recording
+
+bool UInputRecordingSubsystem::StartRecording(ALiquidX_Test_SimpleCharacter* Character, const FString& Path)
+{
+	if (!Character || IsRecording() || IsReplaying())
+	{
+		UE_LOG(LogInputRecording, Warning, TEXT("Recording not started: %s"), !Character ? TEXT("no character") : TEXT("already recording or replaying"));
+		return false;
+	}
+
+	UWorld* World = GetWorld();
+	const FString MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+	RecordingPath = Path.IsEmpty()
+		? FPaths::ProjectSavedDir() / TEXT("InputRecordings") / FString::Printf(TEXT("%s-%s.lxinput"), *MapName, *FDateTime::Now().ToString())
+		: Path;
+
+	RecordingHeader = FRecordingHeader();
+	RecordingHeader.MapName = MapName;
+	RecordingHeader.CharacterClass = Character->GetClass()->GetPathName();
+	RecordingHeader.StartLocation = FVector3f(Character->GetActorLocation());
+	RecordingHeader.StartRotation = FRotator3f(Character->GetActorRotation());
+	RecordingHeader.StartControlRotation = FRotator3f(Character->GetControlRotation());
+
+	bRecording = true;
+	RecordedCharacter = Character;
+	RecordingStartTime = World->GetTimeSeconds();
+	LastFlushedMicroseconds = 0;
+	RecordedData.Reset();
+	PendingEvents.Reset();
+	MoveThisFrame = FVector2D::ZeroVector;
+	LastMove = InputRecording::QuantizeMove(FVector2D::ZeroVector);
+	LastControlRotation = InputRecording::QuantizeRotation(Character->GetControlRotation());
+
+	UE_LOG(LogInputRecording, Display, TEXT("Recording %s to %s"), *Character->GetName(), *RecordingPath);
+	return true;
+}
+
+void UInputRecordingSubsystem::StopRecording()
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	if (RecordedCharacter.IsValid())
+	{
+		FlushRecordedFrame();
+	}
+	RecordingHeader.Duration = GetWorld()->GetTimeSeconds() - RecordingStartTime;
+
+	TArray<uint8> FileData;
+	FileData.Reserve(RecordedData.Num() + 256);
+	FMemoryWriter Writer(FileData);
+	uint32 Magic = InputRecording::Magic;
+	uint16 Version = InputRecording::Version;
+	Writer << Magic;
+	Writer << Version;
+	RecordingHeader.Serialize(Writer);
+	Writer.Serialize(RecordedData.GetData(), RecordedData.Num());
+
+	if (FFileHelper::SaveArrayToFile(FileData, *RecordingPath))
+	{
+		UE_LOG(LogInputRecording, Display, TEXT("Recorded %.1f s, %d frames with input, %d bytes to %s"),
+			RecordingHeader.Duration, RecordingHeader.NumFrames, FileData.Num(), *RecordingPath);
+	}
+	else
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("Failed to write the input recording %s"), *RecordingPath);
+	}
+
+	bRecording = false;
+	RecordedCharacter.Reset();
+	RecordedData.Empty();
+	PendingEvents.Empty();
+}
+
+void UInputRecordingSubsystem::RecordInput(const ALiquidX_Test_SimpleCharacter* Character, ERecordedInput Input, const FVector2D& Value)
+{
+	if (Character != RecordedCharacter.Get())
+	{
+		return;
+	}
+
+	switch (Input)
+	{
+	case ERecordedInput::Move:
+		// Stored at the end of the frame, when it differs from the last stored value
+		MoveThisFrame = Value;
+		break;
+	case ERecordedInput::Look:
+		// Stored as the control rotation at the end of the frame
+		break;
+	default:
+		PendingEvents.Add({ Input, FVector2D::ZeroVector });
+		break;
+	}
+}
+
+void UInputRecordingSubsystem::FlushRecordedFrame()
+{
+	const uint32 Move = InputRecording::QuantizeMove(MoveThisFrame);
+	MoveThisFrame = FVector2D::ZeroVector;
+	if (Move != LastMove)
+	{
+		PendingEvents.Add({ ERecordedInput::Move, InputRecording::DequantizeMove(Move) });
+		LastMove = Move;
+	}
+
+	const uint32 ControlRotation = InputRecording::QuantizeRotation(RecordedCharacter->GetControlRotation());
+	if (ControlRotation != LastControlRotation)
+	{
+		PendingEvents.Add({ ERecordedInput::ControlRotation, InputRecording::DequantizeRotation(ControlRotation) });
+		LastControlRotation = ControlRotation;
+	}
+
+	if (PendingEvents.IsEmpty())
+	{
+		return;
+	}
+
+	const int64 Microseconds = FMath::RoundToInt64((GetWorld()->GetTimeSeconds() - RecordingStartTime) * 1000000.0);
+	uint32 TimeDelta = uint32(Microseconds - LastFlushedMicroseconds);
+	uint32 NumEvents = uint32(PendingEvents.Num());
+	LastFlushedMicroseconds = Microseconds;
+
+	// Appends to RecordedData
+	FMemoryWriter Writer(RecordedData, false, true);
+	Writer.SerializeIntPacked(TimeDelta);
+	Writer.SerializeIntPacked(NumEvents);
+	for (const FRecordedEvent& Event : PendingEvents)
+	{
+		uint8 Input = uint8(Event.Input);
+		Writer << Input;
+		if (Event.Input == ERecordedInput::Move)
+		{
+			uint16 Value = uint16(InputRecording::QuantizeMove(Event.Value));
+			Writer << Value;
+		}
+		else if (Event.Input == ERecordedInput::ControlRotation)
+		{
+			uint32 Value = InputRecording::QuantizeRotation(FRotator(Event.Value.X, Event.Value.Y, 0.0));
+			Writer << Value;
+		}
+	}
+
+	++RecordingHeader.NumFrames;
+	PendingEvents.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Replay
+
+bool UInputRecordingSubsystem::LoadRecording(const FString& Path)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *Path))
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("Can't read the input recording %s"), *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(FileData);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Magic != InputRecording::Magic || Version != InputRecording::Version)
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("%s is not a version %d input recording"), *Path, InputRecording::Version);
+		return false;
+	}
+
+	ReplayHeader = FRecordingHeader();
+	ReplayHeader.Serialize(Reader);
+
+	// Every stored frame takes at least a byte for its time delta and one for its event count
+	if (Reader.IsError() || ReplayHeader.NumFrames < 0 || ReplayHeader.NumFrames > (Reader.TotalSize() - Reader.Tell()) / 2)
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("The input recording %s is corrupt: %d frames don't fit in its %lld bytes"), *Path, ReplayHeader.NumFrames, Reader.TotalSize());
+		return false;
+	}
+
+	ReplayFrames.Reset(ReplayHeader.NumFrames);
+	ReplayEvents.Reset(ReplayHeader.NumFrames * 2);
+	int64 Microseconds = 0;
+	for (int32 FrameIndex = 0; FrameIndex < ReplayHeader.NumFrames && !Reader.IsError(); ++FrameIndex)
+	{
+		uint32 TimeDelta = 0;
+		uint32 NumEvents = 0;
+		Reader.SerializeIntPacked(TimeDelta);
+		Reader.SerializeIntPacked(NumEvents);
+		Microseconds += TimeDelta;
+
+		FRecordedFrame& Frame = ReplayFrames.AddDefaulted_GetRef();
+		Frame.Time = Microseconds / 1000000.0;
+		Frame.FirstEvent = ReplayEvents.Num();
+		Frame.NumEvents = int32(NumEvents);
+
+		for (uint32 EventIndex = 0; EventIndex < NumEvents && !Reader.IsError(); ++EventIndex)
+		{
+			uint8 Input = 0;
+			Reader << Input;
+
+			FRecordedEvent& Event = ReplayEvents.AddDefaulted_GetRef();
+			Event.Input = ERecordedInput(FMath::Min<uint8>(Input, uint8(ERecordedInput::Num)));
+			if (Event.Input == ERecordedInput::Move)
+			{
+				uint16 Value = 0;
+				Reader << Value;
+				Event.Value = InputRecording::DequantizeMove(Value);
+			}
+			else if (Event.Input == ERecordedInput::ControlRotation)
+			{
+				uint32 Value = 0;
+				Reader << Value;
+				Event.Value = InputRecording::DequantizeRotation(Value);
+			}
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("The input recording %s is truncated"), *Path);
+		ReplayFrames.Empty();
+		ReplayEvents.Empty();
+		return false;
+	}
+
+	ReplayName = FPaths::GetBaseFilename(Path);
+	return true;
+}
+
+bool UInputRecordingSubsystem::StartReplay(const FString& Path)
+{
+	UWorld* World = GetWorld();
+	if (IsReplaying() || IsRecording() || World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogInputRecording, Warning, TEXT("Replay not started: %s"), World->GetNetMode() == NM_Client ? TEXT("clients can't spawn the replayed character") : TEXT("already recording or replaying"));
+		return false;
+	}
+
+	if (!LoadRecording(Path))
+	{
+		return false;
+	}
+
+	const FString MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+	if (ReplayHeader.MapName != MapName)
+	{
+		UE_LOG(LogInputRecording, Warning, TEXT("Replay %s was recorded on %s, not %s; it won't play out the same"), *ReplayName, *ReplayHeader.MapName, *MapName);
+	}
+
+	UClass* CharacterClass = LoadClass<ALiquidX_Test_SimpleCharacter>(nullptr, *ReplayHeader.CharacterClass);
+	if (!CharacterClass)
+	{
+		CharacterClass = ALiquidX_Test_SimpleCharacter::StaticClass();
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	ReplayCharacter = World->SpawnActor<ALiquidX_Test_SimpleCharacter>(CharacterClass, FVector(ReplayHeader.StartLocation), FRotator(ReplayHeader.StartRotation), SpawnParams);
+	if (!ReplayCharacter)
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("Replay %s: failed to spawn %s"), *ReplayName, *CharacterClass->GetName());
+		return false;
+	}
+
+	ReplayController = World->SpawnActor<AInputReplayController>(SpawnParams);
+	ReplayController->Possess(ReplayCharacter);
+	ReplayActors.Add(ReplayCharacter);
+	ReplayActors.Add(ReplayController);
+	ReplayController->SetControlRotation(FRotator(ReplayHeader.StartControlRotation));
+
+	// Same timestep and random streams on every run
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FMath::Max(1.0f, ReplayFixedHz));
+	FMath::RandInit(0);
+	FMath::SRandInit(0);
+
+	NextReplayFrame = 0;
+	ReplayTime = 0.0;
+	ReplayMove = FVector2D::ZeroVector;
+	ReplayTimings.Reset(FMath::CeilToInt32(ReplayHeader.Duration * ReplayFixedHz) + 1);
+
+	ReplaySampler.Start(World, [this](float DeltaSeconds) { AdvanceReplay(DeltaSeconds); }, [this](const FPerfFrameTiming& Timing) { ReplayTimings.Add(Timing); });
+
+	UE_LOG(LogInputRecording, Display, TEXT("Replaying %s: %.1f s, %d frames with input, at %.0f Hz"), *ReplayName, ReplayHeader.Duration, ReplayFrames.Num(), ReplayFixedHz);
+	return true;
+}
+
+void UInputRecordingSubsystem::StopReplay()
+{
+	if (IsReplaying())
+	{
+		FinishReplay();
+	}
+}
+
+void UInputRecordingSubsystem::AdvanceReplay(float DeltaSeconds)
+{
+	// Tick ends the replay once the character is gone
+	if (!IsValid(ReplayCharacter))
+	{
+		return;
+	}
+
+	// Events are applied once their time is reached; at a fixed timestep that is the same frame on every run
+	ReplayTime += DeltaSeconds;
+	while (ReplayFrames.IsValidIndex(NextReplayFrame) && ReplayFrames[NextReplayFrame].Time <= ReplayTime)
+	{
+		ApplyReplayEvents(ReplayFrames[NextReplayFrame++]);
+	}
+
+	// Enhanced Input triggers Move every frame it is held
+	if (!ReplayMove.IsZero())
+	{
+		ReplayCharacter->HandleInput(ERecordedInput::Move, ReplayMove);
+	}
+}
+
+void UInputRecordingSubsystem::ApplyReplayEvents(const FRecordedFrame& Frame)
+{
+	for (int32 Index = Frame.FirstEvent; Index < Frame.FirstEvent + Frame.NumEvents; ++Index)
+	{
+		const FRecordedEvent& Event = ReplayEvents[Index];
+		switch (Event.Input)
+		{
+		case ERecordedInput::Move:
+			ReplayMove = Event.Value;
+			break;
+		case ERecordedInput::ControlRotation:
+			ReplayController->SetControlRotation(FRotator(Event.Value.X, Event.Value.Y, 0.0));
+			break;
+		default:
+			ReplayCharacter->HandleInput(Event.Input, Event.Value);
+			break;
+		}
+	}
+}
+
+void UInputRecordingSubsystem::FinishReplay()
+{
+	ReplaySampler.Stop();
+
+	const bool bCompleted = NextReplayFrame >= ReplayFrames.Num();
+	WriteReplayTiming();
+
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	ReplayActors.Clear(GetWorld());
+	ReplayController = nullptr;
+	ReplayCharacter = nullptr;
+	ReplayFrames.Empty();
+	ReplayEvents.Empty();
+	ReplayTimings.Empty();
+
+	ReplayCommandLineRun.Finish(bCompleted);
+}
+
+void UInputRecordingSubsystem::WriteReplayTiming()
+{
+	const FString OutputPath = FPerfReport::GetOutputPath(TEXT("ReplayOutput"), TEXT("InputRecordings"), ReplayName);
+
+	// Game thread times of an earlier run of the same recording, by frame
+	TArray<float> Baseline;
+	FString BaselinePath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ReplayBaseline="), BaselinePath))
+	{
+		TArray<FString> Lines;
+		if (FFileHelper::LoadFileToStringArray(Lines, *BaselinePath))
+		{
+			Baseline.Reserve(Lines.Num());
+			TArray<FString> Columns;
+			for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+			{
+				Lines[LineIndex].ParseIntoArray(Columns, TEXT(","));
+				Baseline.Add(Columns.Num() > 2 ? FCString::Atof(*Columns[2]) : 0.0f);
+			}
+		}
+		else
+		{
+			UE_LOG(LogInputRecording, Warning, TEXT("Can't read the replay baseline %s"), *BaselinePath);
+		}
+	}
+
+	const double FrameTime = 1.0 / FMath::Max(1.0f, ReplayFixedHz);
+	FString Csv = Baseline.Num() > 0 ? TEXT("Frame,Time,GameThreadMs,Traces,BaselineGameThreadMs,DeltaMs\n") : TEXT("Frame,Time,GameThreadMs,Traces\n");
+	double TotalMs = 0.0;
+	double TotalDeltaMs = 0.0;
+	int32 NumCompared = 0;
+	int32 WorstFrame = INDEX_NONE;
+	float WorstDeltaMs = 0.0f;
+	for (int32 Index = 0; Index < ReplayTimings.Num(); ++Index)
+	{
+		const FPerfFrameTiming& Timing = ReplayTimings[Index];
+		TotalMs += Timing.GameThreadMs;
+		Csv += FString::Printf(TEXT("%d,%.4f,%.3f,%d"), Index, Index * FrameTime, Timing.GameThreadMs, Timing.NumTraces);
+		if (Baseline.IsValidIndex(Index))
+		{
+			const float DeltaMs = Timing.GameThreadMs - Baseline[Index];
+			Csv += FString::Printf(TEXT(",%.3f,%.3f"), Baseline[Index], DeltaMs);
+			TotalDeltaMs += DeltaMs;
+			++NumCompared;
+			if (WorstFrame == INDEX_NONE || DeltaMs > WorstDeltaMs)
+			{
+				WorstFrame = Index;
+				WorstDeltaMs = DeltaMs;
+			}
+		}
+		Csv += TEXT("\n");
+	}
+	FPerfReport::Write(OutputPath, Csv);
+
+	UE_LOG(LogInputRecording, Display, TEXT("Replay %s: %d frames, game thread avg %.2f ms -> %s.csv"),
+		*ReplayName, ReplayTimings.Num(), ReplayTimings.Num() > 0 ? TotalMs / ReplayTimings.Num() : 0.0, *OutputPath);
+	if (NumCompared > 0)
+	{
+		UE_LOG(LogInputRecording, Display, TEXT("Replay %s against %s: avg %+.3f ms/frame over %d frames, worst frame %d at %+.3f ms"),
+			*ReplayName, *BaselinePath, TotalDeltaMs / NumCompared, NumCompared, WorstFrame, WorstDeltaMs);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void StartInputRecording(const TArray<FString>& Args, UWorld* World)
+{
+	UInputRecordingSubsystem* Recording = World ? World->GetSubsystem<UInputRecordingSubsystem>() : nullptr;
+	const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	ALiquidX_Test_SimpleCharacter* Character = PlayerController ? Cast<ALiquidX_Test_SimpleCharacter>(PlayerController->GetPawn()) : nullptr;
+	if (Recording && Character)
+	{
+		Recording->StartRecording(Character, Args.Num() > 0 ? Args[0] : FString());
+	}
+}
+
+static void StopInputRecording(const TArray<FString>& Args, UWorld* World)
+{
+	if (UInputRecordingSubsystem* Recording = World ? World->GetSubsystem<UInputRecordingSubsystem>() : nullptr)
+	{
+		Recording->StopRecording();
+	}
+}
+
+static void StartInputReplay(const TArray<FString>& Args, UWorld* World)
+{
+	UInputRecordingSubsystem* Recording = World ? World->GetSubsystem<UInputRecordingSubsystem>() : nullptr;
+	if (!Recording || Args.Num() < 1)
+	{
+		UE_LOG(LogInputRecording, Warning, TEXT("Usage: LiquidX.Input.Replay <File>"));
+		return;
+	}
+
+	Recording->StartReplay(Args[0]);
+}
+
+static void StopInputReplay(const TArray<FString>& Args, UWorld* World)
+{
+	if (UInputRecordingSubsystem* Recording = World ? World->GetSubsystem<UInputRecordingSubsystem>() : nullptr)
+	{
+		Recording->StopReplay();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs StartInputRecordingCommand(
+	TEXT("LiquidX.Input.Record"),
+	TEXT("Record the local player's character input to [File], Saved/InputRecordings by default"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartInputRecording));
+
+static FAutoConsoleCommandWithWorldAndArgs StopInputRecordingCommand(
+	TEXT("LiquidX.Input.StopRecord"),
+	TEXT("Stop recording input and write the file"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopInputRecording));
+
+static FAutoConsoleCommandWithWorldAndArgs StartInputReplayCommand(
+	TEXT("LiquidX.Input.Replay"),
+	TEXT("Spawn a character and replay the input recording <File> into it at a fixed timestep, writing per-frame timing to Saved/InputRecordings"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartInputReplay));
+
+static FAutoConsoleCommandWithWorldAndArgs StopInputReplayCommand(
+	TEXT("LiquidX.Input.StopReplay"),
+	TEXT("End the running input replay early and write the timing so far"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopInputReplay));
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "LiquidXPerfRun.h"
+#include "InputRecordingSubsystem.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+
+/** Input events of ALiquidX_Test_SimpleCharacter, one per Enhanced Input binding, plus the recorded control rotation */
+enum class ERecordedInput : uint8
+{
+	/** Move axis; recorded as the held value whenever it changes, 0 when released */
+	Move,
+	/** Look axis; never recorded, its result is recorded as ControlRotation */
+	Look,
+	JumpStarted,
+	JumpCompleted,
+	Jetpack,
+	JetpackCompleted,
+	PickupThrow,
+	PickupThrowCompleted,
+	Interact,
+	Punch,
+	Sprint,
+	SprintCompleted,
+	/** Control rotation (pitch, yaw) after the frame's look input */
+	ControlRotation,
+	Num
+};
+
+/** Stands in for the player controller of a replayed character; on a server a player controller would wait for client moves */
+UCLASS(notplaceable, NotBlueprintable)
+class LIQUIDX_TEST_SIMPLE_API AInputReplayController : public AController
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Records a local character's input into a compact binary file and replays it deterministically.
+ *
+ * Recording captures the same events the character's Enhanced Input bindings fire, stamped with the
+ * time since the recording started. Only frames with an event are stored: a packed time delta, the
+ * event count and one byte per event, plus a quantized value for Move and ControlRotation, which
+ * are stored only when they change. Look is stored as the control rotation it produced, so a replay
+ * doesn't depend on input scaling or the controller type.
+ *
+ * A replay spawns the recorded character class at the recorded start, possesses it with an
+ * AInputReplayController and runs the engine at a fixed timestep, applying each recorded event as the
+ * first frame its time is reached starts, before the actors tick. The same recording then produces
+ * the same frames on every run and build, and the per-frame timing goes to a CSV in
+ * Saved/InputRecordings that can be diffed against a baseline:
+ *   LiquidX_Test_Simple <Map> -nullrhi -unattended -nosound -LiquidXReplay=<File> [-ReplayFixedHz=60]
+ *     [-ReplayOutput=<Path>] [-ReplayBaseline=<Csv>]
+ * Record with -LiquidXRecord[=<File>] or LiquidX.Input.Record; replay from the console with
+ * LiquidX.Input.Replay <File>.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UInputRecordingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start recording Character's input, to be written to Path (Saved/InputRecordings when empty) */
+	bool StartRecording(ALiquidX_Test_SimpleCharacter* Character, const FString& Path = FString());
+
+	/** Stop recording and write the file */
+	void StopRecording();
+
+	bool IsRecording() const { return bRecording; }
+
+	/** Called by the character for every input event it handles */
+	void RecordInput(const ALiquidX_Test_SimpleCharacter* Character, ERecordedInput Input, const FVector2D& Value);
+
+	/** Load the recording at Path and start replaying it; fails on a network client or while recording or replaying */
+	bool StartReplay(const FString& Path);
+
+	/** End the replay now, write the timing of the frames replayed so far and remove the replayed character */
+	void StopReplay();
+
+	bool IsReplaying() const { return ReplayCharacter != nullptr; }
+
+	/** Timestep replays run at, overridden by -ReplayFixedHz */
+	UPROPERTY(Config, EditAnywhere, Category = "Input Recording", meta = (ClampMin = "1"))
+	float ReplayFixedHz = 60.0f;
+
+private:
+	struct FRecordedEvent
+	{
+		ERecordedInput Input = ERecordedInput::Move;
+		FVector2D Value = FVector2D::ZeroVector;
+	};
+
+	struct FRecordedFrame
+	{
+		double Time = 0.0;
+		int32 FirstEvent = 0;
+		int32 NumEvents = 0;
+	};
+
+	struct FRecordingHeader
+	{
+		FString MapName;
+		FString CharacterClass;
+		FVector3f StartLocation = FVector3f::ZeroVector;
+		FRotator3f StartRotation = FRotator3f::ZeroRotator;
+		FRotator3f StartControlRotation = FRotator3f::ZeroRotator;
+		double Duration = 0.0;
+		int32 NumFrames = 0;
+
+		void Serialize(FArchive& Ar);
+	};
+
+	/** Write the events of the frame that just ended */
+	void FlushRecordedFrame();
+
+	bool LoadRecording(const FString& Path);
+
+	/** Apply the events due by this frame as the world tick starts, before the actors tick, as player input would be */
+	void AdvanceReplay(float DeltaSeconds);
+	void ApplyReplayEvents(const FRecordedFrame& Frame);
+	void FinishReplay();
+	void WriteReplayTiming();
+
+	// Recording
+	bool bRecording = false;
+	TWeakObjectPtr<ALiquidX_Test_SimpleCharacter> RecordedCharacter;
+	FString RecordingPath;
+	FRecordingHeader RecordingHeader;
+	double RecordingStartTime = 0.0;
+	int64 LastFlushedMicroseconds = 0;
+	TArray<uint8> RecordedData;
+	TArray<FRecordedEvent> PendingEvents;
+	FVector2D MoveThisFrame = FVector2D::ZeroVector;
+	uint32 LastMove = 0;
+	uint32 LastControlRotation = 0;
+
+	/** Started by -LiquidXRecord; starts once the first local player has a character */
+	bool bRecordWhenPossessed = false;
+
+	// Replay
+	FString ReplayName;
+	FRecordingHeader ReplayHeader;
+	TArray<FRecordedFrame> ReplayFrames;
+	TArray<FRecordedEvent> ReplayEvents;
+	int32 NextReplayFrame = 0;
+	double ReplayTime = 0.0;
+	FVector2D ReplayMove = FVector2D::ZeroVector;
+	FPerfFrameSampler ReplaySampler;
+	TArray<FPerfFrameTiming> ReplayTimings;
+
+	UPROPERTY(Transient)
+	TObjectPtr<ALiquidX_Test_SimpleCharacter> ReplayCharacter;
+
+	UPROPERTY(Transient)
+	TObjectPtr<AInputReplayController> ReplayController;
+
+	/** The replayed character and its controller, removed when the replay ends */
+	FPerfArena ReplayActors;
+
+	/** -LiquidXReplay; exit when done */
+	FPerfCommandLineRun ReplayCommandLineRun;
+
+	// Engine timestep before the replay switched it
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+};
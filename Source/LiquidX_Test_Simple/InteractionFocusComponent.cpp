@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionFocusComponent.h"
+#include "InteractionIndexSubsystem.h"
+#include "InteractiveActor.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+
+UInteractionFocusComponent::UInteractionFocusComponent()
+{
+	// The tick only compares the owner's cell and yaw bucket with last frame's; evaluation is event driven
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+	PrimaryComponentTick.bAllowTickOnDedicatedServer = false;
+}
+
+void UInteractionFocusComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UInteractionIndexSubsystem* Index = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+	{
+		InteractionIndex = Index;
+		CellChangedHandle = Index->OnCellChanged.AddUObject(this, &UInteractionFocusComponent::OnCellChanged);
+	}
+}
+
+void UInteractionFocusComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UInteractionIndexSubsystem* Index = InteractionIndex.Get())
+	{
+		Index->OnCellChanged.Remove(CellChangedHandle);
+	}
+	InteractionIndex.Reset();
+
+	SetFocusedActor(nullptr);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UInteractionFocusComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Prompts are only shown to the local player
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	const UInteractionIndexSubsystem* Index = InteractionIndex.Get();
+	if (!Pawn || !Pawn->IsLocallyControlled() || !Index)
+	{
+		return;
+	}
+
+	const FIntVector Cell = Index->GetCell(Pawn->GetActorLocation());
+	const float Yaw = FRotator::ClampAxis(Pawn->GetActorRotation().Yaw);
+	const int32 YawBucket = FMath::FloorToInt32(Yaw / 360.0f * FMath::Max(1, YawBuckets));
+
+	if (Cell != OwnerCell || YawBucket != OwnerYawBucket)
+	{
+		OwnerCell = Cell;
+		OwnerYawBucket = YawBucket;
+		bFocusDirty = true;
+	}
+
+	// A focused actor that vanished without telling the index (e.g. garbage collected) still loses focus
+	if (bFocusDirty || FocusedActor.IsStale())
+	{
+		EvaluateFocus();
+	}
+}
+
+void UInteractionFocusComponent::EvaluateFocus()
+{
+	bFocusDirty = false;
+	NumEvaluations++;
+
+	const UInteractionIndexSubsystem* Index = InteractionIndex.Get();
+	const AActor* Owner = GetOwner();
+	if (!Index || !Owner)
+	{
+		SetFocusedActor(nullptr);
+		return;
+	}
+
+	const FVector Origin = Owner->GetActorLocation();
+	const FVector Forward = Owner->GetActorForwardVector();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FocusConeHalfAngle));
+
+	Candidates.Reset();
+	Index->QueryRadius(Origin, FocusRange, nullptr, Candidates);
+
+	AActor* BestActor = nullptr;
+	float BestDistSq = TNumericLimits<float>::Max();
+	for (AActor* Candidate : Candidates)
+	{
+		if (Candidate == Owner)
+		{
+			continue;
+		}
+
+		const AInteractiveActor* InteractiveActor = Cast<AInteractiveActor>(Candidate);
+		if (InteractiveActor && !InteractiveActor->IsInteractable())
+		{
+			continue;
+		}
+
+		const FVector ToCandidate = Candidate->GetActorLocation() - Origin;
+		const float DistSq = ToCandidate.SizeSquared();
+		if (DistSq >= BestDistSq || FVector::DotProduct(ToCandidate, Forward) < CosHalfAngle * FMath::Sqrt(DistSq))
+		{
+			continue;
+		}
+
+		BestActor = Candidate;
+		BestDistSq = DistSq;
+	}
+
+	SetFocusedActor(BestActor);
+}
+
+void UInteractionFocusComponent::SetFocusedActor(AActor* NewFocus)
+{
+	AActor* OldFocus = FocusedActor.Get();
+	if (NewFocus == OldFocus && !FocusedActor.IsStale())
+	{
+		return;
+	}
+
+	FocusedActor = NewFocus;
+
+	if (OldFocus)
+	{
+		OnFocusLost.Broadcast(OldFocus);
+	}
+	if (NewFocus)
+	{
+		OnFocusGained.Broadcast(NewFocus);
+	}
+}
+
+void UInteractionFocusComponent::OnCellChanged(const FIntVector& Cell)
+{
+	if (bFocusDirty || !InteractionIndex.IsValid())
+	{
+		return;
+	}
+
+	// Only changes that could bring something into or out of range matter
+	const int32 CellRadius = FMath::CeilToInt32(FocusRange / InteractionIndex->CellSize);
+	const FIntVector Offset = Cell - OwnerCell;
+	if (FMath::Abs(Offset.X) <= CellRadius && FMath::Abs(Offset.Y) <= CellRadius && FMath::Abs(Offset.Z) <= CellRadius)
+	{
+		bFocusDirty = true;
+	}
+}
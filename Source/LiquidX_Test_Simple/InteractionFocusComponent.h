@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "InteractionFocusComponent.generated.h"
+
+class UInteractionIndexSubsystem;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInteractionFocusChanged, AActor*, FocusActor);
+
+/**
+ * Keeps the best interactable in front of a locally controlled character, for interaction prompts.
+ * Candidates come from UInteractionIndexSubsystem, never from a scene query. The focus is only
+ * re-evaluated when the owner crosses a grid cell, turns into another yaw bucket, or the index
+ * reports a change in a cell within FocusRange.
+ */
+UCLASS(ClassGroup = (Interaction), meta = (BlueprintSpawnableComponent))
+class LIQUIDX_TEST_SIMPLE_API UInteractionFocusComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInteractionFocusComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	UFUNCTION(BlueprintPure, Category = "Interaction")
+	AActor* GetFocusedActor() const { return FocusedActor.Get(); }
+
+	/** Re-evaluate the focus on the next tick */
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void InvalidateFocus() { bFocusDirty = true; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FOnInteractionFocusChanged OnFocusGained;
+
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FOnInteractionFocusChanged OnFocusLost;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+	float FocusRange = 200.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction", meta = (ClampMin = "0", ClampMax = "180"))
+	float FocusConeHalfAngle = 30.0f;
+
+	/** Number of yaw buckets per full turn; turning into a new bucket re-evaluates the focus */
+	UPROPERTY(EditAnywhere, Category = "Interaction", meta = (ClampMin = "1"))
+	int32 YawBuckets = 16;
+
+	UFUNCTION(BlueprintPure, Category = "Interaction")
+	int32 GetNumEvaluations() const { return NumEvaluations; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void EvaluateFocus();
+	void SetFocusedActor(AActor* NewFocus);
+	void OnCellChanged(const FIntVector& Cell);
+
+	TWeakObjectPtr<AActor> FocusedActor;
+	TWeakObjectPtr<UInteractionIndexSubsystem> InteractionIndex;
+	FDelegateHandle CellChangedHandle;
+
+	FIntVector OwnerCell = FIntVector(TNumericLimits<int32>::Max());
+	int32 OwnerYawBucket = INDEX_NONE;
+	bool bFocusDirty = true;
+
+	/** Scratch candidate list, kept to avoid reallocating on every evaluation */
+	TArray<AActor*> Candidates;
+
+	int32 NumEvaluations = 0;
+};
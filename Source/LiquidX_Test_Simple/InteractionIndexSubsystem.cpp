@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionIndexSubsystem.h"
+#include "GameFramework/Actor.h"
+
+void UInteractionIndexSubsystem::Deinitialize()
+{
+	for (const FInteractableEntry& Entry : Entries)
+	{
+		if (AActor* Actor = Entry.Actor.Get())
+		{
+			if (USceneComponent* Root = Actor->GetRootComponent())
+			{
+				Root->TransformUpdated.Remove(Entry.TransformUpdatedHandle);
+			}
+		}
+	}
+
+	Entries.Empty();
+	FreeEntries.Empty();
+	EntryIndexByActor.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void UInteractionIndexSubsystem::RegisterInteractable(AActor* Actor)
+{
+	if (!Actor || !Actor->GetRootComponent())
+	{
+		return;
+	}
+
+	if (const int32* ExistingIndex = EntryIndexByActor.Find(Actor))
+	{
+		MoveEntry(*ExistingIndex, Actor->GetActorLocation());
+		OnCellChanged.Broadcast(Entries[*ExistingIndex].Cell);
+		return;
+	}
+
+	const int32 EntryIndex = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+	FInteractableEntry& Entry = Entries[EntryIndex];
+	Entry.Actor = Actor;
+	Entry.Location = Actor->GetActorLocation();
+	Entry.Cell = GetCell(Entry.Location);
+	Entry.bAttached = Actor->GetAttachParentActor() != nullptr;
+	Entry.TransformUpdatedHandle = Actor->GetRootComponent()->TransformUpdated.AddUObject(this, &UInteractionIndexSubsystem::OnTransformUpdated, EntryIndex);
+
+	Cells.FindOrAdd(Entry.Cell).Add(EntryIndex);
+	EntryIndexByActor.Add(Actor, EntryIndex);
+
+	OnCellChanged.Broadcast(Entry.Cell);
+}
+
+void UInteractionIndexSubsystem::UnregisterInteractable(AActor* Actor)
+{
+	int32 EntryIndex = INDEX_NONE;
+	if (!EntryIndexByActor.RemoveAndCopyValue(Actor, EntryIndex))
+	{
+		return;
+	}
+
+	FInteractableEntry& Entry = Entries[EntryIndex];
+	if (USceneComponent* Root = Actor->GetRootComponent())
+	{
+		Root->TransformUpdated.Remove(Entry.TransformUpdatedHandle);
+	}
+
+	if (TArray<int32>* Cell = Cells.Find(Entry.Cell))
+	{
+		Cell->RemoveSwap(EntryIndex, EAllowShrinking::No);
+		if (Cell->Num() == 0)
+		{
+			Cells.Remove(Entry.Cell);
+		}
+	}
+
+	const FIntVector OldCell = Entry.Cell;
+	Entry = FInteractableEntry();
+	FreeEntries.Add(EntryIndex);
+
+	OnCellChanged.Broadcast(OldCell);
+}
+
+void UInteractionIndexSubsystem::NotifyInteractableChanged(AActor* Actor)
+{
+	if (const int32* EntryIndex = EntryIndexByActor.Find(Actor))
+	{
+		OnCellChanged.Broadcast(Entries[*EntryIndex].Cell);
+	}
+}
+
+template<typename VisitorType>
+void UInteractionIndexSubsystem::ForEachInRange(const FVector& Location, float Range, TSubclassOf<AActor> Type, VisitorType&& Visitor) const
+{
+	const float RangeSq = FMath::Square(Range);
+	const FIntVector MinCell = GetCell(Location - FVector(Range));
+	const FIntVector MaxCell = GetCell(Location + FVector(Range));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (!Cell)
+				{
+					continue;
+				}
+
+				for (const int32 EntryIndex : *Cell)
+				{
+					const FInteractableEntry& Entry = Entries[EntryIndex];
+					const float DistSq = FVector::DistSquared(Location, Entry.Location);
+					if (DistSq > RangeSq)
+					{
+						continue;
+					}
+
+					AActor* Actor = Entry.Actor.Get();
+					if (!Actor || (Type && !Actor->IsA(Type)) || Actor->GetAttachParentActor())
+					{
+						continue;
+					}
+
+					Visitor(Actor, Entry.Location, DistSq);
+				}
+			}
+		}
+	}
+}
+
+AActor* UInteractionIndexSubsystem::FindNearest(const FVector& Location, float Range, TSubclassOf<AActor> Type) const
+{
+	AActor* Nearest = nullptr;
+	float NearestDistSq = TNumericLimits<float>::Max();
+	ForEachInRange(Location, Range, Type, [&Nearest, &NearestDistSq](AActor* Actor, const FVector& ActorLocation, float DistSq)
+	{
+		if (DistSq < NearestDistSq)
+		{
+			Nearest = Actor;
+			NearestDistSq = DistSq;
+		}
+	});
+	return Nearest;
+}
+
+AActor* UInteractionIndexSubsystem::FindNearestInCone(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees, TSubclassOf<AActor> Type) const
+{
+	const FVector ConeDirection = Direction.GetSafeNormal();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.0f, 180.0f)));
+
+	AActor* Nearest = nullptr;
+	float NearestDistSq = TNumericLimits<float>::Max();
+	ForEachInRange(Origin, Range, Type, [&](AActor* Actor, const FVector& ActorLocation, float DistSq)
+	{
+		if (DistSq >= NearestDistSq)
+		{
+			return;
+		}
+
+		// cos(angle to actor) >= cos(half angle), without normalizing; an actor at the origin is always inside
+		const float Along = FVector::DotProduct(ActorLocation - Origin, ConeDirection);
+		if (Along < CosHalfAngle * FMath::Sqrt(DistSq))
+		{
+			return;
+		}
+
+		Nearest = Actor;
+		NearestDistSq = DistSq;
+	});
+	return Nearest;
+}
+
+int32 UInteractionIndexSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees, TSubclassOf<AActor> Type, TArray<AActor*>& OutActors) const
+{
+	const FVector ConeDirection = Direction.GetSafeNormal();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.0f, 180.0f)));
+
+	TArray<TPair<float, AActor*>, TInlineAllocator<16>> Found;
+	ForEachInRange(Origin, Range, Type, [&](AActor* Actor, const FVector& ActorLocation, float DistSq)
+	{
+		const float Along = FVector::DotProduct(ActorLocation - Origin, ConeDirection);
+		if (Along >= CosHalfAngle * FMath::Sqrt(DistSq))
+		{
+			Found.Emplace(DistSq, Actor);
+		}
+	});
+
+	Found.Sort([](const TPair<float, AActor*>& A, const TPair<float, AActor*>& B) { return A.Key < B.Key; });
+	for (const TPair<float, AActor*>& Entry : Found)
+	{
+		OutActors.Add(Entry.Value);
+	}
+	return Found.Num();
+}
+
+int32 UInteractionIndexSubsystem::QueryRadius(const FVector& Location, float Range, TSubclassOf<AActor> Type, TArray<AActor*>& OutActors) const
+{
+	const int32 NumBefore = OutActors.Num();
+	ForEachInRange(Location, Range, Type, [&OutActors](AActor* Actor, const FVector& ActorLocation, float DistSq)
+	{
+		OutActors.Add(Actor);
+	});
+	return OutActors.Num() - NumBefore;
+}
+
+FIntVector UInteractionIndexSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void UInteractionIndexSubsystem::MoveEntry(int32 EntryIndex, const FVector& NewLocation)
+{
+	FInteractableEntry& Entry = Entries[EntryIndex];
+	Entry.Location = NewLocation;
+
+	const FIntVector NewCell = GetCell(NewLocation);
+	if (NewCell == Entry.Cell)
+	{
+		return;
+	}
+
+	if (TArray<int32>* OldCell = Cells.Find(Entry.Cell))
+	{
+		OldCell->RemoveSwap(EntryIndex, EAllowShrinking::No);
+		if (OldCell->Num() == 0)
+		{
+			Cells.Remove(Entry.Cell);
+		}
+	}
+
+	const FIntVector OldCellCoords = Entry.Cell;
+	Entry.Cell = NewCell;
+	Cells.FindOrAdd(NewCell).Add(EntryIndex);
+
+	OnCellChanged.Broadcast(OldCellCoords);
+	OnCellChanged.Broadcast(NewCell);
+}
+
+void UInteractionIndexSubsystem::OnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 EntryIndex)
+{
+	if (!Entries.IsValidIndex(EntryIndex))
+	{
+		return;
+	}
+
+	MoveEntry(EntryIndex, UpdatedComponent->GetComponentLocation());
+
+	// Picking a cube up or dropping it changes whether queries see it, even if it stays in its cell
+	FInteractableEntry& Entry = Entries[EntryIndex];
+	const bool bAttached = UpdatedComponent->GetAttachParent() != nullptr;
+	if (bAttached != Entry.bAttached)
+	{
+		Entry.bAttached = bAttached;
+		OnCellChanged.Broadcast(Entry.Cell);
+	}
+}
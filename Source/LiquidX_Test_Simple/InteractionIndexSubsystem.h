@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "InteractionIndexSubsystem.generated.h"
+
+/** Something in a cell changed: an interactable entered, left, was attached/detached or changed state */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInteractableCellChanged, const FIntVector& /*Cell*/);
+
+/**
+ * Uniform grid of registered interactables (pickup cubes, interactive actors) so interaction
+ * queries don't have to go through a physics scene query and then cast whatever they hit.
+ * Entries follow their actor's root component as it moves; actors unregister when they leave
+ * play or go back to a pool. Attached actors (held cubes) stay indexed but are skipped by queries.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UInteractionIndexSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	/** Start tracking Actor. Registering an actor that is already tracked just refreshes its cell. */
+	void RegisterInteractable(AActor* Actor);
+	void UnregisterInteractable(AActor* Actor);
+
+	/** Tell listeners that Actor's interaction state changed (e.g. it was enabled or disabled) */
+	void NotifyInteractableChanged(AActor* Actor);
+
+	/** Nearest unattached interactable of Type within Range of Location */
+	UFUNCTION(BlueprintCallable, Category = "Interaction", meta = (DeterminesOutputType = "Type"))
+	AActor* FindNearest(const FVector& Location, float Range, TSubclassOf<AActor> Type) const;
+
+	/** Nearest unattached interactable of Type within Range of Origin and within HalfAngleDegrees of Direction */
+	UFUNCTION(BlueprintCallable, Category = "Interaction", meta = (DeterminesOutputType = "Type"))
+	AActor* FindNearestInCone(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees, TSubclassOf<AActor> Type) const;
+
+	/**
+	 * Every unattached interactable of Type within Range of Origin and within HalfAngleDegrees of Direction,
+	 * appended to OutActors nearest first. Returns the number appended.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	int32 QueryCone(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees, TSubclassOf<AActor> Type, TArray<AActor*>& OutActors) const;
+
+	/** Every unattached interactable of Type within Range of Location. Returns the number appended to OutActors. */
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	int32 QueryRadius(const FVector& Location, float Range, TSubclassOf<AActor> Type, TArray<AActor*>& OutActors) const;
+
+	template<typename T>
+	T* FindNearest(const FVector& Location, float Range) const
+	{
+		return static_cast<T*>(FindNearest(Location, Range, T::StaticClass()));
+	}
+
+	template<typename T>
+	T* FindNearestInCone(const FVector& Origin, const FVector& Direction, float Range, float HalfAngleDegrees) const
+	{
+		return static_cast<T*>(FindNearestInCone(Origin, Direction, Range, HalfAngleDegrees, T::StaticClass()));
+	}
+
+	UFUNCTION(BlueprintPure, Category = "Interaction")
+	int32 GetNumInteractables() const { return EntryIndexByActor.Num(); }
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Broadcast for every cell whose contents changed */
+	FOnInteractableCellChanged OnCellChanged;
+
+	/** Edge length of a grid cell. Around the typical query range keeps queries to a few cells. */
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction", meta = (ClampMin = "1"))
+	float CellSize = 200.0f;
+
+private:
+	struct FInteractableEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FVector Location = FVector::ZeroVector;
+		FIntVector Cell = FIntVector::ZeroValue;
+		bool bAttached = false;
+		FDelegateHandle TransformUpdatedHandle;
+	};
+
+	void MoveEntry(int32 EntryIndex, const FVector& NewLocation);
+
+	/** Calls Visitor(Actor, DistSq) for every valid unattached entry of Type within Range of Location */
+	template<typename VisitorType>
+	void ForEachInRange(const FVector& Location, float Range, TSubclassOf<AActor> Type, VisitorType&& Visitor) const;
+
+	void OnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 EntryIndex);
+
+	TArray<FInteractableEntry> Entries;
+	TArray<int32> FreeEntries;
+	TMap<TWeakObjectPtr<AActor>, int32> EntryIndexByActor;
+	TMap<FIntVector, TArray<int32>> Cells;
+};
@@ -2,24 +2,99 @@
 
 
 #include "InteractiveActor.h"
+#include "InteractionIndexSubsystem.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 AInteractiveActor::AInteractiveActor()
 {
+    // Tick is opt-in through TickPolicySettings; see UTickPolicySubsystem
     PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
 
     MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComponent"));
     RootComponent = MeshComponent;
+
+    // Interactions are server authoritative and rare, so the actor sleeps between them
+    bReplicates = true;
+    NetDormancy = DORM_Initial;
+    NetUpdateFrequency = 2.0f;
+}
+
+void AInteractiveActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(AInteractiveActor, bIsInteractable);
 }
 
 void AInteractiveActor::BeginPlay()
 {
     Super::BeginPlay();
+
+    if (UTickPolicySubsystem* TickPolicy = GetWorld()->GetSubsystem<UTickPolicySubsystem>())
+    {
+        TickPolicy->RegisterActor(this, TickPolicySettings, MeshComponent);
+    }
+
+    if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+    {
+        InteractionIndex->RegisterInteractable(this);
+    }
+}
+
+void AInteractiveActor::SetInteractable(bool bNewInteractable)
+{
+    if (!HasAuthority() || bIsInteractable == bNewInteractable)
+    {
+        return;
+    }
+
+    FlushNetDormancy();
+    bIsInteractable = bNewInteractable;
+
+    if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+    {
+        InteractionIndex->NotifyInteractableChanged(this);
+    }
 }
 
-void AInteractiveActor::Tick(float DeltaTime)
+void AInteractiveActor::PerformInteract()
 {
-    Super::Tick(DeltaTime);
+    if (HasAuthority())
+    {
+        // A multicast only reaches clients that have a channel open for this actor
+        FlushNetDormancy();
+        MulticastInteract();
+    }
+}
+
+void AInteractiveActor::MulticastInteract_Implementation()
+{
+    Interact();
+}
+
+void AInteractiveActor::OnRep_IsInteractable()
+{
+    if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+    {
+        InteractionIndex->NotifyInteractableChanged(this);
+    }
+}
+
+void AInteractiveActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UTickPolicySubsystem* TickPolicy = GetWorld()->GetSubsystem<UTickPolicySubsystem>())
+    {
+        TickPolicy->UnregisterActor(this);
+    }
+
+    if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+    {
+        InteractionIndex->UnregisterInteractable(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 
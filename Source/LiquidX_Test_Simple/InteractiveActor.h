@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TickPolicySubsystem.h"
 #include "InteractiveActor.generated.h"
 
 UCLASS()
@@ -14,18 +15,41 @@ class LIQUIDX_TEST_SIMPLE_API AInteractiveActor : public AActor
 public:
     AInteractiveActor();
 
-    virtual void Tick(float DeltaTime) override;
-
     UFUNCTION(BlueprintImplementableEvent, Category = "Interaction")
     void Interact();
 
+    /** Server only: run Interact on the server and every client */
+    void PerformInteract();
+
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+    /** Server only: enable or disable interaction. Goes through here so focus tracking hears about it. */
+    UFUNCTION(BlueprintCallable, Category = "Interaction")
+    void SetInteractable(bool bNewInteractable);
+
+    UFUNCTION(BlueprintPure, Category = "Interaction")
+    bool IsInteractable() const { return bIsInteractable; }
+
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     UStaticMeshComponent* MeshComponent;
 
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+    /** Change at runtime through SetInteractable so the interaction index stays in step */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_IsInteractable, Category = "Interaction")
     bool bIsInteractable = true;
 
+    /** Interactive actors don't tick unless a Blueprint implements Event Tick or the policy asks for it */
+    UPROPERTY(EditAnywhere, Category = "Tick")
+    FActorTickPolicySettings TickPolicySettings;
+
+private:
+    UFUNCTION(NetMulticast, Reliable)
+    void MulticastInteract();
+
+    UFUNCTION()
+    void OnRep_IsInteractable();
+
 };
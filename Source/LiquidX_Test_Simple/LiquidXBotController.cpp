@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXBotController.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "LiquidXCharacterMovementComponent.h"
+#include "BotStressSubsystem.h"
+#include "Engine/World.h"
+
+ALiquidXBotController::ALiquidXBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+}
+
+void ALiquidXBotController::InitializeBot(const FBotActionRates& InRates, int32 Seed)
+{
+	Rates = InRates;
+	Stream.Initialize(Seed);
+	PickMoveTarget();
+}
+
+void ALiquidXBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	Stream.Initialize(GetUniqueID());
+	PickMoveTarget();
+}
+
+void ALiquidXBotController::OnUnPossess()
+{
+	ReleaseActions();
+
+	Super::OnUnPossess();
+}
+
+ALiquidX_Test_SimpleCharacter* ALiquidXBotController::GetBotCharacter() const
+{
+	return Cast<ALiquidX_Test_SimpleCharacter>(GetPawn());
+}
+
+bool ALiquidXBotController::RollAction(float PerMinute, float DeltaSeconds)
+{
+	return PerMinute > 0.0f && Stream.FRand() < PerMinute / 60.0f * DeltaSeconds;
+}
+
+void ALiquidXBotController::PickMoveTarget()
+{
+	const APawn* BotPawn = GetPawn();
+	if (!BotPawn)
+	{
+		return;
+	}
+
+	const FVector Location = BotPawn->GetActorLocation();
+	const UBotStressSubsystem* BotStress = GetWorld()->GetSubsystem<UBotStressSubsystem>();
+	if (!BotStress || !BotStress->GetRandomMoveTarget(Stream, MoveTarget))
+	{
+		// No arena: wander around where we are
+		MoveTarget = Location + FVector(Stream.FRandRange(-1.0f, 1.0f), Stream.FRandRange(-1.0f, 1.0f), 0.0f) * 2000.0f;
+	}
+
+	ClosestToTarget = FVector::Dist2D(Location, MoveTarget);
+	TimeSinceCloser = 0.0f;
+}
+
+void ALiquidXBotController::StartWallRun()
+{
+	const APawn* BotPawn = GetPawn();
+	const UBotStressSubsystem* BotStress = GetWorld()->GetSubsystem<UBotStressSubsystem>();
+	if (BotPawn && BotStress && BotStress->FindNearestWallLane(BotPawn->GetActorLocation(), WallRunStart, WallRunDirection))
+	{
+		WallRunTimeLeft = Rates.WallRunDuration;
+		bWallRunJumped = false;
+	}
+}
+
+void ALiquidXBotController::ReleaseActions()
+{
+	if (ALiquidX_Test_SimpleCharacter* Character = GetBotCharacter())
+	{
+		if (SprintTimeLeft > 0.0f)
+		{
+			Character->StopSprint();
+		}
+		if (JetpackTimeLeft > 0.0f)
+		{
+			Character->DeactivateJetpack();
+		}
+		if (HoldTimeLeft > 0.0f)
+		{
+			Character->ThrowCube();
+		}
+		Character->StopJumping();
+	}
+
+	SprintTimeLeft = 0.0f;
+	JetpackTimeLeft = 0.0f;
+	HoldTimeLeft = 0.0f;
+	JumpHoldTimeLeft = 0.0f;
+	DoubleJumpDelay = -1.0f;
+	WallRunTimeLeft = 0.0f;
+}
+
+void ALiquidXBotController::PressJump()
+{
+	if (ALiquidX_Test_SimpleCharacter* Character = GetBotCharacter())
+	{
+		// Same as the jump binding: jump on the ground, double jump in the air
+		Character->DoubleJump();
+		JumpHoldTimeLeft = 0.2f;
+	}
+}
+
+void ALiquidXBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	ALiquidX_Test_SimpleCharacter* Character = GetBotCharacter();
+	const ULiquidXCharacterMovementComponent* Movement = Character ? Character->GetLiquidXMovement() : nullptr;
+	if (!Movement)
+	{
+		return;
+	}
+
+	const FVector Location = Character->GetActorLocation();
+
+	// Release the jump button a moment after pressing it, like a tap
+	if (JumpHoldTimeLeft > 0.0f)
+	{
+		JumpHoldTimeLeft -= DeltaSeconds;
+		if (JumpHoldTimeLeft <= 0.0f)
+		{
+			Character->StopJumping();
+		}
+	}
+
+	if (DoubleJumpDelay >= 0.0f)
+	{
+		DoubleJumpDelay -= DeltaSeconds;
+		if (DoubleJumpDelay < 0.0f)
+		{
+			PressJump();
+		}
+	}
+
+	// Movement: run to the wall lane and along it, otherwise towards the move target
+	if (WallRunTimeLeft > 0.0f)
+	{
+		WallRunTimeLeft -= DeltaSeconds;
+		if (!bWallRunJumped)
+		{
+			const FVector ToStart = (WallRunStart - Location) * FVector(1.0f, 1.0f, 0.0f);
+			if (ToStart.SizeSquared() < FMath::Square(ArrivalRadius * 0.5f))
+			{
+				// The wall is on the right of the lane; the jump and the run along it do the rest
+				Character->SetActorRotation(WallRunDirection.Rotation());
+				PressJump();
+				bWallRunJumped = true;
+				WallRunTimeLeft = FMath::Min(WallRunTimeLeft, 2.0f);
+			}
+			else
+			{
+				Character->AddMovementInput(ToStart.GetSafeNormal());
+			}
+		}
+		else
+		{
+			Character->AddMovementInput(WallRunDirection);
+		}
+
+		if (WallRunTimeLeft <= 0.0f)
+		{
+			PickMoveTarget();
+		}
+	}
+	else
+	{
+		const float Distance = FVector::Dist2D(Location, MoveTarget);
+		if (Distance < ClosestToTarget - 50.0f)
+		{
+			ClosestToTarget = Distance;
+			TimeSinceCloser = 0.0f;
+		}
+		else
+		{
+			TimeSinceCloser += DeltaSeconds;
+		}
+
+		if (Distance < ArrivalRadius || TimeSinceCloser > StuckTime)
+		{
+			PickMoveTarget();
+		}
+
+		Character->AddMovementInput(((MoveTarget - Location) * FVector(1.0f, 1.0f, 0.0f)).GetSafeNormal());
+
+		if (RollAction(Rates.WallRunPerMinute, DeltaSeconds))
+		{
+			StartWallRun();
+		}
+	}
+
+	// Actions, each rolled independently
+	if (SprintTimeLeft > 0.0f)
+	{
+		SprintTimeLeft -= DeltaSeconds;
+		if (SprintTimeLeft <= 0.0f)
+		{
+			Character->StopSprint();
+		}
+	}
+	else if (RollAction(Rates.SprintPerMinute, DeltaSeconds))
+	{
+		Character->StartSprint();
+		SprintTimeLeft = Rates.SprintDuration;
+	}
+
+	if (JetpackTimeLeft > 0.0f)
+	{
+		JetpackTimeLeft -= DeltaSeconds;
+		if (JetpackTimeLeft <= 0.0f)
+		{
+			Character->DeactivateJetpack();
+		}
+	}
+	else if (WallRunTimeLeft <= 0.0f && RollAction(Rates.JetpackPerMinute, DeltaSeconds))
+	{
+		PressJump();
+		Character->ActivateJetpack();
+		JetpackTimeLeft = Rates.JetpackDuration;
+	}
+
+	if (WallRunTimeLeft <= 0.0f && JetpackTimeLeft <= 0.0f && DoubleJumpDelay < 0.0f
+		&& Movement->IsMovingOnGround() && RollAction(Rates.DoubleJumpPerMinute, DeltaSeconds))
+	{
+		PressJump();
+		DoubleJumpDelay = 0.35f;
+	}
+
+	if (HoldTimeLeft > 0.0f)
+	{
+		HoldTimeLeft -= DeltaSeconds;
+		if (HoldTimeLeft <= 0.0f)
+		{
+			Character->ThrowCube();
+		}
+	}
+	else if (RollAction(Rates.PickupThrowPerMinute, DeltaSeconds))
+	{
+		Character->PickupCube();
+		HoldTimeLeft = Rates.CubeHoldDuration;
+	}
+
+	if (!Character->GetHeldCube() && RollAction(Rates.PunchPerMinute, DeltaSeconds))
+	{
+		Character->PunchCube();
+	}
+}
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "LiquidXBotController.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+
+/** How often a bot starts each action, in times per minute, and how long the held ones last */
+USTRUCT(BlueprintType)
+struct FBotActionRates
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float SprintPerMinute = 6.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float SprintDuration = 3.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float DoubleJumpPerMinute = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float JetpackPerMinute = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float JetpackDuration = 1.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float WallRunPerMinute = 4.0f;
+
+	/** Longest a bot spends getting to a wall and running along it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float WallRunDuration = 6.0f;
+
+	/** Pickups per minute; the cube is thrown after CubeHoldDuration */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float PickupThrowPerMinute = 6.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float CubeHoldDuration = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bot", meta = (ClampMin = "0"))
+	float PunchPerMinute = 20.0f;
+};
+
+/**
+ * Drives an ALiquidX_Test_SimpleCharacter like a player would, through the same calls its input
+ * handlers make. The bot runs between the points UBotStressSubsystem hands out (mostly cube clusters)
+ * and, at random with the configured rates, sprints, double jumps, burns the jetpack, runs to the
+ * nearest wall and along it, picks up and throws cubes and punches. Works without a navmesh: it
+ * steers straight at its target and picks another when it gets stuck.
+ */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API ALiquidXBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	ALiquidXBotController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Set the action rates and seed the bot's random choices, so a run with the same seeds repeats */
+	void InitializeBot(const FBotActionRates& InRates, int32 Seed);
+
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	FBotActionRates Rates;
+
+	/** Distance at which a move target counts as reached */
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float ArrivalRadius = 150.0f;
+
+	/** Seconds without getting closer to the target before picking another */
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float StuckTime = 4.0f;
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+private:
+	/** Whether an action with PerMinute starts this frame */
+	bool RollAction(float PerMinute, float DeltaSeconds);
+
+	void PickMoveTarget();
+	void StartWallRun();
+
+	/** Tap the jump button: a jump on the ground, a double jump in the air */
+	void PressJump();
+
+	/** Let go of everything held: sprint, jetpack, jump and cube */
+	void ReleaseActions();
+
+	ALiquidX_Test_SimpleCharacter* GetBotCharacter() const;
+
+	FRandomStream Stream;
+
+	FVector MoveTarget = FVector::ZeroVector;
+	float ClosestToTarget = 0.0f;
+	float TimeSinceCloser = 0.0f;
+
+	float SprintTimeLeft = 0.0f;
+	float JetpackTimeLeft = 0.0f;
+	float HoldTimeLeft = 0.0f;
+	float JumpHoldTimeLeft = 0.0f;
+
+	/** Counts down to the second jump of a double jump */
+	float DoubleJumpDelay = -1.0f;
+
+	// Wall run: approach WallRunStart, then jump and run along WallRunDirection
+	float WallRunTimeLeft = 0.0f;
+	FVector WallRunStart = FVector::ZeroVector;
+	FVector WallRunDirection = FVector::ForwardVector;
+	bool bWallRunJumped = false;
+};
@@ -0,0 +1,473 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXCharacterMovementComponent.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "GameplayDebugDrawSubsystem.h"
+#include "LiquidXStats.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PhysicsVolume.h"
+
+ULiquidXCharacterMovementComponent::ULiquidXCharacterMovementComponent()
+{
+	// Resting gravity, overwritten by the character's tuning; the jetpack swaps in its own scale while it fires
+	GravityScale = 1.75f;
+
+	bWantsToSprint = false;
+	bWantsJetpack = false;
+	bWantsDoubleJump = false;
+	bWallRunExhausted = false;
+	bHasDoubleJumped = false;
+	bWallRunHint = false;
+	bFixedStepMeshOffset = false;
+
+	SetMoveResponseDataContainer(LiquidXMoveResponseData);
+}
+
+ALiquidX_Test_SimpleCharacter* ULiquidXCharacterMovementComponent::GetLiquidXCharacter() const
+{
+	return Cast<ALiquidX_Test_SimpleCharacter>(CharacterOwner);
+}
+
+float ULiquidXCharacterMovementComponent::GetMaxSpeed() const
+{
+	const ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	if (bWantsToSprint && IsMovingOnGround() && Character)
+	{
+		return Super::GetMaxSpeed() * Character->GetTuning().SprintSpeedMultiplier;
+	}
+	return Super::GetMaxSpeed();
+}
+
+float ULiquidXCharacterMovementComponent::GetGravityZ() const
+{
+	const ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	if (IsJetpacking() && Character)
+	{
+		return GetPhysicsVolume()->GetGravityZ() * Character->GetTuning().JetpackGravityScale;
+	}
+	return Super::GetGravityZ();
+}
+
+bool ULiquidXCharacterMovementComponent::IsFalling() const
+{
+	// Jetpacking is falling with thrust; animation and air control should treat it that way
+	return Super::IsFalling() || IsJetpacking();
+}
+
+bool ULiquidXCharacterMovementComponent::CanDoubleJump() const
+{
+	// Walking off a ledge leaves JumpCurrentCount at 0; only a jump of the character's own counts
+	return (IsFalling() || IsWallRunning()) && CharacterOwner && CharacterOwner->JumpCurrentCount > 0 && !bHasDoubleJumped;
+}
+
+void ULiquidXCharacterMovementComponent::SetWallRunHint(bool bWallSeen, const FVector& Normal)
+{
+	bWallRunHint = bWallSeen;
+	if (bWallSeen && !IsWallRunning())
+	{
+		WallRunNormal = Normal;
+	}
+}
+
+bool ULiquidXCharacterMovementComponent::TryStartWallRun()
+{
+	if (IsWallRunning())
+	{
+		return true;
+	}
+
+	if (MovementMode != MOVE_Falling || bWallRunExhausted || WallRunNormal.IsNearlyZero() || !ConfirmWall())
+	{
+		return false;
+	}
+
+	SetMovementMode(MOVE_Custom, CMOVE_WallRun);
+	return true;
+}
+
+void ULiquidXCharacterMovementComponent::StopWallRun()
+{
+	if (IsWallRunning())
+	{
+		SetMovementMode(MOVE_Falling);
+	}
+}
+
+void ULiquidXCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	bWantsJetpack = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+	bWantsDoubleJump = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
+}
+
+void ULiquidXCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_MovementState);
+
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	if (!Character)
+	{
+		return;
+	}
+
+	// Double jump: a one-shot input, consumed by the first move that carries it
+	if (bWantsDoubleJump)
+	{
+		bWantsDoubleJump = false;
+		if (CanDoubleJump())
+		{
+			bHasDoubleJumped = true;
+			Velocity.Z = Character->GetTuning().DoubleJumpForce;
+			SetMovementMode(MOVE_Falling);
+		}
+	}
+
+	// The jetpack engages from the air while the input is held. Fuel only burns in PhysJetpack's fixed
+	// steps, so it runs out at the same point at any frame rate; holding the input on the ground costs
+	// nothing. Fuel refills whenever the jetpack isn't firing.
+	const bool bBurning = bWantsJetpack && Character->JetpackFuel > 0.0f;
+	if (bBurning && MovementMode == MOVE_Falling)
+	{
+		SetMovementMode(MOVE_Custom, CMOVE_Jetpack);
+	}
+	else if (!bBurning && IsJetpacking())
+	{
+		SetMovementMode(MOVE_Falling);
+	}
+
+	if (!IsJetpacking())
+	{
+		Character->SetJetpackFuel(Character->JetpackFuel + Character->GetTuning().JetpackFuelRefillRate * DeltaSeconds);
+	}
+
+	if (bWallRunHint && MovementMode == MOVE_Falling)
+	{
+		TryStartWallRun();
+	}
+}
+
+void ULiquidXCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	if (PreviousMovementMode == MOVE_Custom && PreviousCustomMode == CMOVE_WallRun)
+	{
+		WallRunTimer = 0.0f;
+	}
+
+	if (MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking)
+	{
+		bWallRunExhausted = false;
+		bHasDoubleJumped = false;
+	}
+
+	// Each custom mode starts its fixed steps afresh; time left over from the previous one is dropped
+	if ((PreviousMovementMode == MOVE_Custom || MovementMode == MOVE_Custom) && UpdatedComponent)
+	{
+		AbilityStepAccumulator = 0.0f;
+		FixedStepPreviousLocation = UpdatedComponent->GetComponentLocation();
+		ResetFixedStepInterpolation();
+	}
+
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+}
+
+void ULiquidXCharacterMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	Super::PhysCustom(deltaTime, Iterations);
+
+	if (CustomMovementMode != CMOVE_WallRun && CustomMovementMode != CMOVE_Jetpack)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid custom movement mode %d"), CustomMovementMode);
+		SetMovementMode(MOVE_Falling);
+		return;
+	}
+
+	if (AbilityFixedStepHz <= 0.0f)
+	{
+		PhysAbilityStep(deltaTime, Iterations);
+		return;
+	}
+
+	// Run the whole steps in this frame's time plus what earlier frames left over; the rest waits for
+	// the next frame. The tolerance keeps float error in frame times from dropping a step.
+	const float Step = 1.0f / AbilityFixedStepHz;
+	AbilityStepAccumulator += deltaTime;
+	while (AbilityStepAccumulator >= Step - 1.0e-5f)
+	{
+		AbilityStepAccumulator -= Step;
+		const float RemainingTime = FMath::Max(0.0f, AbilityStepAccumulator);
+		const uint8 StepMode = CustomMovementMode;
+		FixedStepPreviousLocation = UpdatedComponent->GetComponentLocation();
+
+		PhysAbilityStep(Step, Iterations);
+
+		if (MovementMode != MOVE_Custom || CustomMovementMode != StepMode)
+		{
+			// The mode ended during the step and handed over; its successor gets the rest of the frame
+			if (RemainingTime >= MIN_TICK_TIME)
+			{
+				StartNewPhysics(RemainingTime, Iterations);
+			}
+			return;
+		}
+	}
+
+	UpdateFixedStepInterpolation(FMath::Clamp(AbilityStepAccumulator / Step, 0.0f, 1.0f));
+}
+
+void ULiquidXCharacterMovementComponent::PhysAbilityStep(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == CMOVE_WallRun)
+	{
+		PhysWallRun(deltaTime, Iterations);
+	}
+	else
+	{
+		PhysJetpack(deltaTime, Iterations);
+	}
+}
+
+void ULiquidXCharacterMovementComponent::UpdateFixedStepInterpolation(float Alpha)
+{
+	USkeletalMeshComponent* Mesh = CharacterOwner->GetMesh();
+	if (!Mesh || !CharacterOwner->IsLocallyControlled() || IsNetMode(NM_DedicatedServer))
+	{
+		return;
+	}
+
+	// Other characters' meshes are left to network smoothing. This one is drawn Alpha of the way from
+	// the previous step to the current one, trailing the capsule by the part of a step not yet simulated.
+	const FVector Offset = (FixedStepPreviousLocation - UpdatedComponent->GetComponentLocation()) * (1.0f - Alpha);
+	Mesh->SetRelativeLocation(CharacterOwner->GetBaseTranslationOffset() + UpdatedComponent->GetComponentQuat().UnrotateVector(Offset));
+	bFixedStepMeshOffset = true;
+}
+
+void ULiquidXCharacterMovementComponent::ResetFixedStepInterpolation()
+{
+	if (bFixedStepMeshOffset && CharacterOwner && CharacterOwner->GetMesh())
+	{
+		CharacterOwner->GetMesh()->SetRelativeLocation(CharacterOwner->GetBaseTranslationOffset());
+	}
+	bFixedStepMeshOffset = false;
+}
+
+void ULiquidXCharacterMovementComponent::PhysWallRun(float deltaTime, int32 Iterations)
+{
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_WallRunUpdate);
+
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	const ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	WallRunTimer += deltaTime;
+
+	const bool bTimedOut = WallRunTimer >= Character->GetTuning().WallRunDuration;
+	if (bTimedOut || !ConfirmWall())
+	{
+		bWallRunExhausted |= bTimedOut;
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	FVector WallRunDirection = FVector::CrossProduct(WallRunNormal, FVector::UpVector);
+	if (FVector::DotProduct(WallRunDirection, UpdatedComponent->GetForwardVector()) < 0)
+	{
+		WallRunDirection = -WallRunDirection;
+	}
+	Velocity = WallRunDirection * Character->GetTuning().WallRunSpeed;
+
+	const FVector Delta = Velocity * deltaTime;
+	FHitResult Hit(1.0f);
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+	if (Hit.IsValidBlockingHit())
+	{
+		HandleImpact(Hit, deltaTime, Delta);
+		SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit, true);
+	}
+}
+
+void ULiquidXCharacterMovementComponent::PhysJetpack(float deltaTime, int32 Iterations)
+{
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_Jetpack);
+
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	if (Character->JetpackFuel <= 0.0f)
+	{
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+	Character->SetJetpackFuel(Character->JetpackFuel - Character->GetTuning().JetpackFuelConsumptionRate * deltaTime);
+
+	// Thrust integrates like a continuous force on the character's mass; falling physics does the
+	// rest with the reduced jetpack gravity (see GetGravityZ) and hands over to walking on landing
+	Velocity.Z += Character->GetTuning().JetpackForce / FMath::Max(Mass, UE_KINDA_SMALL_NUMBER) * deltaTime;
+	PhysFalling(deltaTime, Iterations);
+}
+
+bool ULiquidXCharacterMovementComponent::ConfirmWall()
+{
+	const ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	const FVector Start = UpdatedComponent->GetComponentLocation();
+	const FVector End = Start - WallRunNormal * Character->GetTuning().WallCheckDistance + UpdatedComponent->GetForwardVector() * Character->GetTuning().WallRunForwardOffset;
+
+	FHitResult Hit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WallRunConfirm), false, CharacterOwner);
+	LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_WallRunQueries, 1);
+	const bool bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, QueryParams);
+	LIQUIDX_DEBUG_LINE(Character->GetDebugDrawWorld(), WallRun, Start, End, bHit ? FColor::Green : FColor::Red);
+	if (bHit)
+	{
+		WallRunNormal = Hit.Normal;
+		return true;
+	}
+	return false;
+}
+
+void ULiquidXCharacterMovementComponent::ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse)
+{
+	// Take the server's fuel before the correction replays the unacknowledged moves on top of it.
+	// Written directly: the replayed moves publish it to the HUD as they run.
+	ALiquidX_Test_SimpleCharacter* Character = GetLiquidXCharacter();
+	if (MoveResponse.IsCorrection() && Character)
+	{
+		Character->JetpackFuel = static_cast<const FLiquidXMoveResponseDataContainer&>(MoveResponse).JetpackFuel;
+	}
+
+	Super::ClientHandleMoveResponse(MoveResponse);
+}
+
+FNetworkPredictionData_Client* ULiquidXCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		ULiquidXCharacterMovementComponent* MutableThis = const_cast<ULiquidXCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_LiquidX(*this);
+	}
+	return ClientPredictionData;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FSavedMove_LiquidX
+
+void FSavedMove_LiquidX::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToSprint = false;
+	bSavedWantsJetpack = false;
+	bSavedWantsDoubleJump = false;
+	SavedWallRunTimer = 0.0f;
+	SavedAbilityStepAccumulator = 0.0f;
+}
+
+uint8 FSavedMove_LiquidX::GetCompressedFlags() const
+{
+	uint8 Flags = Super::GetCompressedFlags();
+	if (bSavedWantsToSprint)
+	{
+		Flags |= FLAG_Custom_0;
+	}
+	if (bSavedWantsJetpack)
+	{
+		Flags |= FLAG_Custom_1;
+	}
+	if (bSavedWantsDoubleJump)
+	{
+		Flags |= FLAG_Custom_2;
+	}
+	return Flags;
+}
+
+bool FSavedMove_LiquidX::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_LiquidX* NewLiquidXMove = static_cast<const FSavedMove_LiquidX*>(NewMove.Get());
+	if (bSavedWantsToSprint != NewLiquidXMove->bSavedWantsToSprint
+		|| bSavedWantsJetpack != NewLiquidXMove->bSavedWantsJetpack
+		|| bSavedWantsDoubleJump || NewLiquidXMove->bSavedWantsDoubleJump)
+	{
+		return false;
+	}
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_LiquidX::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	const ULiquidXCharacterMovementComponent* Movement = Cast<ULiquidXCharacterMovementComponent>(C->GetCharacterMovement());
+	if (Movement)
+	{
+		bSavedWantsToSprint = Movement->bWantsToSprint;
+		bSavedWantsJetpack = Movement->bWantsJetpack;
+		bSavedWantsDoubleJump = Movement->bWantsDoubleJump;
+		SavedWallRunTimer = Movement->WallRunTimer;
+		SavedAbilityStepAccumulator = Movement->AbilityStepAccumulator;
+	}
+}
+
+void FSavedMove_LiquidX::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	ULiquidXCharacterMovementComponent* Movement = Cast<ULiquidXCharacterMovementComponent>(C->GetCharacterMovement());
+	if (Movement)
+	{
+		Movement->bWantsDoubleJump = bSavedWantsDoubleJump;
+		Movement->WallRunTimer = SavedWallRunTimer;
+		Movement->AbilityStepAccumulator = SavedAbilityStepAccumulator;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FLiquidXMoveResponseDataContainer
+
+void FLiquidXMoveResponseDataContainer::ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment)
+{
+	Super::ServerFillResponseData(CharacterMovement, PendingAdjustment);
+
+	const ALiquidX_Test_SimpleCharacter* Character = Cast<ALiquidX_Test_SimpleCharacter>(CharacterMovement.GetCharacterOwner());
+	JetpackFuel = Character ? Character->GetJetpackFuel() : 0.0f;
+}
+
+bool FLiquidXMoveResponseDataContainer::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap)
+{
+	if (!Super::Serialize(CharacterMovement, Ar, PackageMap))
+	{
+		return false;
+	}
+
+	// Acknowledged moves agree with the server already; only corrections pay for the fuel
+	if (IsCorrection())
+	{
+		Ar << JetpackFuel;
+	}
+	return !Ar.IsError();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FNetworkPredictionData_Client_LiquidX
+
+FNetworkPredictionData_Client_LiquidX::FNetworkPredictionData_Client_LiquidX(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_LiquidX::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_LiquidX());
+}
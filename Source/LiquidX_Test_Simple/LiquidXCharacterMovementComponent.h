@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "LiquidXCharacterMovementComponent.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+
+/** Server move response that also carries the jetpack fuel when it corrects the client */
+struct FLiquidXMoveResponseDataContainer : public FCharacterMoveResponseDataContainer
+{
+	typedef FCharacterMoveResponseDataContainer Super;
+
+	virtual void ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+
+	float JetpackFuel = 0.0f;
+};
+
+UENUM(BlueprintType)
+enum ECustomMovementMode : uint8
+{
+	CMOVE_None		UMETA(Hidden),
+	CMOVE_WallRun	UMETA(DisplayName = "Wall Run"),
+	CMOVE_Jetpack	UMETA(DisplayName = "Jetpack"),
+	CMOVE_MAX		UMETA(Hidden),
+};
+
+/**
+ * Character movement with native wall-run and jetpack movement modes, sprint and double jump.
+ * Inputs travel in the saved-move compressed flags, so all of it is simulated on the server and
+ * predicted and replayed on the owning client like the built-in movement modes.
+ *
+ * Wall run and jetpack advance in fixed steps of 1 / AbilityFixedStepHz from an accumulator, so
+ * jetpack climb, fuel use and wall-run distance come out the same at any frame rate, and a server
+ * ticking at 30 Hz agrees with 120 Hz clients. The locally controlled character's mesh is drawn
+ * between the last two steps. The LiquidX.Movement.FixedStep automation test checks this at
+ * 20/30/60/120 Hz.
+ */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API ULiquidXCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_LiquidX;
+
+public:
+	ULiquidXCharacterMovementComponent();
+
+	// UCharacterMovementComponent interface
+	virtual float GetMaxSpeed() const override;
+	virtual float GetGravityZ() const override;
+	virtual bool IsFalling() const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	UFUNCTION(BlueprintPure, Category = "Movement")
+	bool IsWallRunning() const { return IsCustomMovementMode(CMOVE_WallRun); }
+
+	UFUNCTION(BlueprintPure, Category = "Movement")
+	bool IsJetpacking() const { return IsCustomMovementMode(CMOVE_Jetpack); }
+
+	// Inputs, set on the owning client and carried to the server in the compressed flags
+	void SetWantsToSprint(bool bWants) { bWantsToSprint = bWants; }
+	void SetWantsJetpack(bool bWants) { bWantsJetpack = bWants; }
+	void RequestDoubleJump() { bWantsDoubleJump = true; }
+
+	/**
+	 * Rate the wall-run and jetpack modes are simulated at; 0 simulates them once per frame with the frame time.
+	 * Every step is a full movement sweep, so a frame costs ceil(AbilityFixedStepHz / frame rate) of them: the
+	 * default matches the 30 Hz dedicated server tick, where that is one. Raising it to 120 makes a 30 Hz server
+	 * do four sweeps per ability character per frame, and replays of corrected moves redo them on the client.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Abilities", meta = (ClampMin = "0"))
+	float AbilityFixedStepHz = 30.0f;
+
+	bool WantsToSprint() const { return bWantsToSprint; }
+	bool WantsJetpack() const { return bWantsJetpack; }
+	bool HasDoubleJumped() const { return bHasDoubleJumped; }
+
+	/** In the air after a jump of its own, not just off a ledge, and the second jump not used yet */
+	bool CanDoubleJump() const;
+
+	/** Wall seen by the wall-run probes. The movement simulation confirms it before starting a wall run. */
+	void SetWallRunHint(bool bWallSeen, const FVector& Normal);
+
+	/** Start a wall run against the hinted wall if the character is airborne and the wall is confirmed */
+	bool TryStartWallRun();
+	void StopWallRun();
+
+#if WITH_EDITORONLY_DATA
+	// Moved into FCharacterTuning; read once by ALiquidX_Test_SimpleCharacter::PostLoad to migrate old archetypes
+	UPROPERTY()
+	float JetpackGravityScale_DEPRECATED = 0.1f;
+	UPROPERTY()
+	float MaxJetpackFuel_DEPRECATED = 100.0f;
+#endif
+
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+	virtual void ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse) override;
+
+	void PhysWallRun(float deltaTime, int32 Iterations);
+	void PhysJetpack(float deltaTime, int32 Iterations);
+
+	/** Single trace towards WallRunNormal's wall. Updates WallRunNormal on a hit. */
+	bool ConfirmWall();
+
+	/** Run the active custom mode for one step */
+	void PhysAbilityStep(float deltaTime, int32 Iterations);
+
+	/** Offset the locally controlled character's mesh to Alpha of the way between the last two fixed steps */
+	void UpdateFixedStepInterpolation(float Alpha);
+	void ResetFixedStepInterpolation();
+
+	ALiquidX_Test_SimpleCharacter* GetLiquidXCharacter() const;
+
+private:
+	uint8 bWantsToSprint : 1;
+	uint8 bWantsJetpack : 1;
+	uint8 bWantsDoubleJump : 1;
+
+	/** Set when a wall run times out; cleared on landing so the same jump can't wall-run forever */
+	uint8 bWallRunExhausted : 1;
+	uint8 bHasDoubleJumped : 1;
+
+	uint8 bWallRunHint : 1;
+	FVector WallRunNormal = FVector::ZeroVector;
+	float WallRunTimer = 0.0f;
+
+	/** Frame time not yet simulated by the fixed ability steps */
+	float AbilityStepAccumulator = 0.0f;
+
+	/** Capsule location before the last fixed ability step, for interpolation */
+	FVector FixedStepPreviousLocation = FVector::ZeroVector;
+	uint8 bFixedStepMeshOffset : 1;
+
+	FLiquidXMoveResponseDataContainer LiquidXMoveResponseData;
+};
+
+class FSavedMove_LiquidX : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToSprint : 1;
+	uint8 bSavedWantsJetpack : 1;
+	uint8 bSavedWantsDoubleJump : 1;
+
+	// Simulation state at the start of the move, restored when the move is replayed. Jetpack fuel
+	// isn't: it comes from the server's correction and the replayed moves carry it forward.
+	float SavedWallRunTimer = 0.0f;
+	float SavedAbilityStepAccumulator = 0.0f;
+};
+
+class FNetworkPredictionData_Client_LiquidX : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_LiquidX(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
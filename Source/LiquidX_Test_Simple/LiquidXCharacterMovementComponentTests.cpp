@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXCharacterMovementComponent.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "LiquidXTestWorld.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MovementTests
+{
+	constexpr float SimulatedSeconds = 3.0f;
+	constexpr float JetpackSeconds = 2.0f;
+
+	struct FOutcome
+	{
+		FVector JetpackDelta = FVector::ZeroVector;
+		float JetpackFuel = 0.0f;
+		FVector WallRunDelta = FVector::ZeroVector;
+	};
+
+	/** Tick a fresh character's movement directly, Hz frames per second, and return how far it got */
+	static FVector Simulate(UWorld* World, const FVector& Start, float Hz, bool bFixedStep, bool bJetpack, float& OutFuel)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		ALiquidX_Test_SimpleCharacter* Character = World->SpawnActor<ALiquidX_Test_SimpleCharacter>(ALiquidX_Test_SimpleCharacter::StaticClass(), Start, FRotator::ZeroRotator, SpawnParams);
+		ULiquidXCharacterMovementComponent* Movement = Character ? Character->GetLiquidXMovement() : nullptr;
+		if (!Movement)
+		{
+			return FVector::ZeroVector;
+		}
+
+		Movement->bRunPhysicsWithNoController = true;
+		if (!bFixedStep)
+		{
+			Movement->AbilityFixedStepHz = 0.0f;
+		}
+		Movement->SetMovementMode(MOVE_Falling);
+		if (bJetpack)
+		{
+			Movement->SetWantsJetpack(true);
+		}
+		else
+		{
+			Movement->Velocity = FVector(Character->GetTuning().WallRunSpeed, 0.0f, 0.0f);
+			Movement->SetWallRunHint(true, FVector(0.0f, -1.0f, 0.0f));
+		}
+
+		const int32 NumFrames = FMath::RoundToInt32(SimulatedSeconds * Hz);
+		const int32 JetpackFrames = FMath::RoundToInt32(JetpackSeconds * Hz);
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			if (Frame == JetpackFrames)
+			{
+				Movement->SetWantsJetpack(false);
+			}
+			Movement->TickComponent(1.0f / Hz, LEVELTICK_All, nullptr);
+		}
+
+		OutFuel = Character->GetJetpackFuel();
+		const FVector Delta = Character->GetActorLocation() - Start;
+		Character->Destroy();
+		return Delta;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLiquidXMovementFixedStepTest, "LiquidX.Movement.FixedStep",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Jetpack flight and wall run end in the same place with the same fuel at 20, 30, 60 and 120 Hz.
+ * The per-frame runs are reported alongside to show the drift the fixed step removes.
+ */
+bool FLiquidXMovementFixedStepTest::RunTest(const FString& Parameters)
+{
+	using namespace MovementTests;
+
+	// The jetpack cut-off and the end fall on a step boundary at each rate; the last one is the reference
+	static const float Rates[] = { 20.0f, 30.0f, 60.0f, 120.0f };
+	constexpr float Tolerance = 1.0f;
+
+	FLiquidXTestWorld TestWorld;
+	UWorld* World = TestWorld.Get();
+
+	// High above the origin so nothing but the test wall is in the way
+	const FVector Origin(0.0f, 0.0f, 50000.0f);
+	const FVector WallRunStart = Origin + FVector(0.0f, 1000.0f, 0.0f);
+
+	// A 30 m wall along +X with its face 50 cm to the right of the wall-run start
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(WallRunStart + FVector(1300.0f, 60.0f, 0.0f), FRotator::ZeroRotator, SpawnParams);
+	if (!TestNotNull(TEXT("Wall"), Wall))
+	{
+		return false;
+	}
+	Wall->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+	Wall->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+	Wall->SetActorScale3D(FVector(30.0f, 0.2f, 6.0f));
+
+	for (const bool bFixedStep : { true, false })
+	{
+		FOutcome Outcomes[UE_ARRAY_COUNT(Rates)];
+		for (int32 Index = 0; Index < UE_ARRAY_COUNT(Rates); ++Index)
+		{
+			float WallRunFuel = 0.0f;
+			Outcomes[Index].JetpackDelta = Simulate(World, Origin, Rates[Index], bFixedStep, true, Outcomes[Index].JetpackFuel);
+			Outcomes[Index].WallRunDelta = Simulate(World, WallRunStart, Rates[Index], bFixedStep, false, WallRunFuel);
+		}
+
+		const FOutcome& Reference = Outcomes[UE_ARRAY_COUNT(Rates) - 1];
+		for (int32 Index = 0; Index < UE_ARRAY_COUNT(Rates); ++Index)
+		{
+			const FOutcome& Outcome = Outcomes[Index];
+			const TCHAR* StepName = bFixedStep ? TEXT("Fixed step") : TEXT("Frame step");
+			AddInfo(FString::Printf(TEXT("%s %3.0f Hz: jetpack height %.2f cm (%+.2f), fuel %.3f (%+.3f), wall run %.2f cm (%+.2f)"),
+				StepName, Rates[Index],
+				Outcome.JetpackDelta.Z, Outcome.JetpackDelta.Z - Reference.JetpackDelta.Z,
+				Outcome.JetpackFuel, Outcome.JetpackFuel - Reference.JetpackFuel,
+				Outcome.WallRunDelta.X, Outcome.WallRunDelta.X - Reference.WallRunDelta.X));
+
+			// Only the fixed step has to match; the per-frame runs show what it fixes
+			if (bFixedStep)
+			{
+				const FString What = FString::Printf(TEXT("%s %.0f Hz"), StepName, Rates[Index]);
+				TestTrue(What + TEXT(" jetpack height matches 120 Hz"), FVector::Dist(Outcome.JetpackDelta, Reference.JetpackDelta) <= Tolerance);
+				TestTrue(What + TEXT(" jetpack fuel matches 120 Hz"), FMath::Abs(Outcome.JetpackFuel - Reference.JetpackFuel) <= Tolerance);
+				TestTrue(What + TEXT(" wall run matches 120 Hz"), FVector::Dist(Outcome.WallRunDelta, Reference.WallRunDelta) <= Tolerance);
+			}
+		}
+	}
+
+	Wall->Destroy();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
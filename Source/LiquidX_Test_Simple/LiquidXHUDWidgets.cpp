@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXHUDWidgets.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/WidgetBlueprintLibrary.h"
+#include "Components/ProgressBar.h"
+#include "GameFramework/PlayerController.h"
+
+//////////////////////////////////////////////////////////////////////////
+// UJetpackBarDriver
+
+void UJetpackBarDriver::Bind(ALiquidX_Test_SimpleCharacter* InCharacter)
+{
+	Unbind();
+
+	APlayerController* PlayerController = InCharacter ? Cast<APlayerController>(InCharacter->GetController()) : nullptr;
+	if (!PlayerController)
+	{
+		return;
+	}
+
+	UClass* BarClass = JetpackBarClass.LoadSynchronous();
+	const FObjectProperty* BarProperty = BarClass ? FindFProperty<FObjectProperty>(BarClass, BarPropertyName) : nullptr;
+	if (!BarProperty || !BarProperty->PropertyClass->IsChildOf<UProgressBar>())
+	{
+		return;
+	}
+
+	// Nested widgets too: the bar sits inside the HUD layout
+	TArray<UUserWidget*> Widgets;
+	UWidgetBlueprintLibrary::GetAllWidgetsOfClass(PlayerController, Widgets, BarClass, false);
+	for (UUserWidget* Widget : Widgets)
+	{
+		if (Widget->GetOwningPlayer() != PlayerController)
+		{
+			continue;
+		}
+
+		if (UProgressBar* Bar = Cast<UProgressBar>(BarProperty->GetObjectPropertyValue_InContainer(Widget)))
+		{
+			// SetPercent replaces the bound attribute, so the binding function stops being called
+			Bar->PercentDelegate.Unbind();
+			Bars.AddUnique(Bar);
+		}
+	}
+
+	if (Bars.Num() > 0)
+	{
+		Character = InCharacter;
+		InCharacter->OnJetpackFuelChanged.AddUniqueDynamic(this, &UJetpackBarDriver::HandleFuelChanged);
+		HandleFuelChanged(InCharacter->GetJetpackFuel(), InCharacter->GetTuning().MaxJetpackFuel);
+	}
+}
+
+void UJetpackBarDriver::Unbind()
+{
+	if (ALiquidX_Test_SimpleCharacter* OldCharacter = Character.Get())
+	{
+		OldCharacter->OnJetpackFuelChanged.RemoveDynamic(this, &UJetpackBarDriver::HandleFuelChanged);
+	}
+	Character.Reset();
+	Bars.Reset();
+}
+
+void UJetpackBarDriver::HandleFuelChanged(float Fuel, float MaxFuel)
+{
+	const float Fraction = MaxFuel > 0.0f ? FMath::Clamp(Fuel / MaxFuel, 0.0f, 1.0f) : 0.0f;
+	for (const TWeakObjectPtr<UProgressBar>& Bar : Bars)
+	{
+		if (UProgressBar* ProgressBar = Bar.Get())
+		{
+			ProgressBar->SetPercent(Fraction);
+		}
+	}
+}
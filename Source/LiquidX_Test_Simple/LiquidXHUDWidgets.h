@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "LiquidXHUDWidgets.generated.h"
+
+class ALiquidX_Test_SimpleCharacter;
+class UProgressBar;
+class UUserWidget;
+
+/**
+ * Drives the fuel bar of the player's JetpackBarClass widgets (W_JetpackBar) from
+ * OnJetpackFuelChanged. The bar is the widget's BarPropertyName variable; Bind clears its per-frame
+ * Percent binding and sets it only when the fuel visibly moves, so the bar is only invalidated on
+ * change and the Blueprint binding function no longer runs every frame.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UJetpackBarDriver : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Take over InCharacter's player's jetpack bars and follow its fuel; call once the HUD is built */
+	void Bind(ALiquidX_Test_SimpleCharacter* InCharacter);
+
+	/** Stop following the character; the bars keep their last fill */
+	void Unbind();
+
+	/** Widget class holding a fuel bar */
+	UPROPERTY(Config)
+	TSoftClassPtr<UUserWidget> JetpackBarClass;
+
+	/** Progress bar variable of JetpackBarClass that shows the fuel */
+	UPROPERTY(Config)
+	FName BarPropertyName = TEXT("GasBar");
+
+private:
+	UFUNCTION()
+	void HandleFuelChanged(float Fuel, float MaxFuel);
+
+	TWeakObjectPtr<ALiquidX_Test_SimpleCharacter> Character;
+	TArray<TWeakObjectPtr<UProgressBar>> Bars;
+};
@@ -0,0 +1,267 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXPerfRun.h"
+#include "LiquidXStats.h"
+#include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Frame sampling
+
+void FPerfFrameSampler::Start(UWorld* InWorld, TFunction<void(float DeltaSeconds)> InOnTickStart, TFunction<void(const FPerfFrameTiming&)> InOnFrame)
+{
+	Stop();
+
+	World = InWorld;
+	OnTickStart = MoveTemp(InOnTickStart);
+	OnFrame = MoveTemp(InOnFrame);
+	LastTickStartCycles = 0;
+	TickStartCycles = 0;
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddRaw(this, &FPerfFrameSampler::HandleWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddRaw(this, &FPerfFrameSampler::HandleWorldPostActorTick);
+}
+
+void FPerfFrameSampler::Stop()
+{
+	if (!IsSampling())
+	{
+		return;
+	}
+
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	TickStartHandle.Reset();
+	PostActorTickHandle.Reset();
+	OnTickStart.Reset();
+	OnFrame.Reset();
+	World.Reset();
+}
+
+void FPerfFrameSampler::HandleWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != World.Get())
+	{
+		return;
+	}
+
+	LastTickStartCycles = TickStartCycles;
+	TickStartCycles = FPlatformTime::Cycles64();
+	FGameplayTraceCounter::NumTraces = 0;
+
+	if (OnTickStart)
+	{
+		OnTickStart(DeltaSeconds);
+	}
+}
+
+void FPerfFrameSampler::HandleWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != World.Get() || TickStartCycles == 0 || !OnFrame)
+	{
+		return;
+	}
+
+	FPerfFrameTiming Timing;
+	Timing.GameThreadMs = float(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - TickStartCycles));
+	Timing.NumTraces = FGameplayTraceCounter::NumTraces;
+	Timing.bHasFrameMs = LastTickStartCycles != 0;
+	if (Timing.bHasFrameMs)
+	{
+		Timing.FrameMs = float(FPlatformTime::ToMilliseconds64(TickStartCycles - LastTickStartCycles));
+	}
+	OnFrame(Timing);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Percentiles
+
+FPerfPercentiles FPerfPercentiles::Compute(TArray<float>& Values)
+{
+	FPerfPercentiles Result;
+	if (Values.Num() == 0)
+	{
+		return Result;
+	}
+
+	double Sum = 0.0;
+	for (float Value : Values)
+	{
+		Sum += Value;
+	}
+	Values.Sort();
+
+	auto Percentile = [&Values](float Fraction) { return Values[FMath::Min(Values.Num() - 1, FMath::FloorToInt32(Fraction * Values.Num()))]; };
+	Result.Average = float(Sum / Values.Num());
+	Result.P50 = Percentile(0.5f);
+	Result.P90 = Percentile(0.9f);
+	Result.P95 = Percentile(0.95f);
+	Result.P99 = Percentile(0.99f);
+	Result.Max = Values.Last();
+	return Result;
+}
+
+TSharedRef<FJsonObject> FPerfPercentiles::ToJson() const
+{
+	TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+	Object->SetNumberField(TEXT("avg"), Average);
+	Object->SetNumberField(TEXT("p50"), P50);
+	Object->SetNumberField(TEXT("p90"), P90);
+	Object->SetNumberField(TEXT("p95"), P95);
+	Object->SetNumberField(TEXT("p99"), P99);
+	Object->SetNumberField(TEXT("max"), Max);
+	return Object;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Reports
+
+FString FPerfReport::GetOutputPath(const TCHAR* OutputSwitch, const FString& Folder, const FString& Name)
+{
+	FString OutputPath;
+	if (!FParse::Value(FCommandLine::Get(), *FString::Printf(TEXT("%s="), OutputSwitch), OutputPath))
+	{
+		OutputPath = FPaths::ProjectSavedDir() / Folder / FString::Printf(TEXT("%s-%s"), *Name, *FDateTime::Now().ToString());
+	}
+	return OutputPath;
+}
+
+TSharedRef<FJsonObject> FPerfReport::MakeJson(const UWorld* World)
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("build"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetStringField(TEXT("map"), World->GetMapName());
+	Root->SetBoolField(TEXT("dedicatedServer"), World->GetNetMode() == NM_DedicatedServer);
+	return Root;
+}
+
+void FPerfReport::Write(const FString& OutputPath, const FString& Csv, const TSharedPtr<FJsonObject>& Json)
+{
+	FFileHelper::SaveStringToFile(Csv, *(OutputPath + TEXT(".csv")));
+
+	if (Json.IsValid())
+	{
+		FString JsonText;
+		FJsonSerializer::Serialize(Json.ToSharedRef(), TJsonWriterFactory<>::Create(&JsonText));
+		FFileHelper::SaveStringToFile(JsonText, *(OutputPath + TEXT(".json")));
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Arena
+
+AStaticMeshActor* FPerfArena::SpawnWall(UWorld* World, const FVector& Location, const FRotator& Rotation, const FVector& Scale)
+{
+	UStaticMesh* WallMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!WallMesh)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(Location, Rotation, SpawnParams);
+	if (!Wall)
+	{
+		return nullptr;
+	}
+
+	Wall->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+	Wall->GetStaticMeshComponent()->SetStaticMesh(WallMesh);
+	Wall->SetActorScale3D(Scale);
+	Actors.Add(Wall);
+	return Wall;
+}
+
+APickupCube* FPerfArena::AcquireCube(UWorld* World, UClass* CubeClass, const FTransform& Transform)
+{
+	// Acquired one at a time rather than through RequestSpawn so Clear can hand them back
+	UPickupCubePoolSubsystem* CubePool = World->GetSubsystem<UPickupCubePoolSubsystem>();
+	APickupCube* Cube = CubePool ? CubePool->AcquireCube(CubeClass, Transform) : nullptr;
+	if (Cube)
+	{
+		Cubes.Add(Cube);
+	}
+	return Cube;
+}
+
+void FPerfArena::Add(AActor* Actor)
+{
+	if (Actor)
+	{
+		Actors.Add(Actor);
+	}
+}
+
+void FPerfArena::Clear(UWorld* World)
+{
+	// A world being torn down takes the actors with it
+	if (World && !World->bIsTearingDown)
+	{
+		for (const TWeakObjectPtr<AActor>& Actor : Actors)
+		{
+			if (Actor.IsValid())
+			{
+				Actor->Destroy();
+			}
+		}
+		if (UPickupCubePoolSubsystem* CubePool = World->GetSubsystem<UPickupCubePoolSubsystem>())
+		{
+			for (const TWeakObjectPtr<APickupCube>& Cube : Cubes)
+			{
+				if (Cube.IsValid())
+				{
+					CubePool->ReleaseCube(Cube.Get());
+				}
+			}
+		}
+	}
+
+	Actors.Empty();
+	Cubes.Empty();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Command line
+
+bool FPerfCommandLineRun::Claim(const UWorld& World, const TCHAR* Switch, FString& OutValue)
+{
+	static TSet<FString> ClaimedSwitches;
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	if (!World.IsGameWorld() || ClaimedSwitches.Contains(Switch))
+	{
+		return false;
+	}
+
+	// Values may hold commas, e.g. -LiquidXBots=8,16,32
+	OutValue.Reset();
+	if (!FParse::Value(CommandLine, *FString::Printf(TEXT("%s="), Switch), OutValue, false) && !FParse::Param(CommandLine, Switch))
+	{
+		return false;
+	}
+
+	ClaimedSwitches.Add(Switch);
+	bClaimed = true;
+	return true;
+}
+
+void FPerfCommandLineRun::Finish(bool bSucceeded)
+{
+	if (bClaimed)
+	{
+		bClaimed = false;
+		FPlatformMisc::RequestExitWithStatus(false, bSucceeded ? 0 : 1);
+	}
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+
+class AActor;
+class AStaticMeshActor;
+class APickupCube;
+class FJsonObject;
+class UWorld;
+
+/**
+ * Shared pieces of the perf runs (gameplay benchmark, bot stress, input replay): frame sampling,
+ * percentile summaries, the CSV and JSON report, the actors a run spawns and the command-line
+ * start and exit. Each run keeps its own scenario and its own report columns.
+ */
+
+/** Timing of one world frame */
+struct FPerfFrameTiming
+{
+	/** World tick start to world tick start; only set from the second sampled frame on */
+	float FrameMs = 0.0f;
+	/** World tick start to the end of actor ticks */
+	float GameThreadMs = 0.0f;
+	/** Gameplay scene queries issued in between, see FGameplayTraceCounter */
+	int32 NumTraces = 0;
+	bool bHasFrameMs = false;
+};
+
+/**
+ * Times every frame of one world from FWorldDelegates and resets FGameplayTraceCounter at the start
+ * of each. Game thread only; stops itself when destroyed.
+ */
+class LIQUIDX_TEST_SIMPLE_API FPerfFrameSampler
+{
+public:
+	FPerfFrameSampler() = default;
+	~FPerfFrameSampler() { Stop(); }
+
+	FPerfFrameSampler(const FPerfFrameSampler&) = delete;
+	FPerfFrameSampler& operator=(const FPerfFrameSampler&) = delete;
+
+	/** Sample World's frames: OnTickStart runs as each world tick starts, OnFrame once its actors have ticked */
+	void Start(UWorld* InWorld, TFunction<void(float DeltaSeconds)> InOnTickStart, TFunction<void(const FPerfFrameTiming&)> InOnFrame);
+	void Stop();
+
+	bool IsSampling() const { return TickStartHandle.IsValid(); }
+
+private:
+	void HandleWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void HandleWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	TWeakObjectPtr<UWorld> World;
+	TFunction<void(float)> OnTickStart;
+	TFunction<void(const FPerfFrameTiming&)> OnFrame;
+
+	// In FPlatformTime cycles
+	uint64 LastTickStartCycles = 0;
+	uint64 TickStartCycles = 0;
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+};
+
+/** Average, percentiles and max of one per-frame value */
+struct LIQUIDX_TEST_SIMPLE_API FPerfPercentiles
+{
+	float Average = 0.0f;
+	float P50 = 0.0f;
+	float P90 = 0.0f;
+	float P95 = 0.0f;
+	float P99 = 0.0f;
+	float Max = 0.0f;
+
+	/** Summarize Values; sorts them */
+	static FPerfPercentiles Compute(TArray<float>& Values);
+
+	/** Summarize GetValue(Sample) over Samples */
+	template <typename SampleType, typename GetterType>
+	static FPerfPercentiles Compute(const TArray<SampleType>& Samples, GetterType GetValue)
+	{
+		TArray<float> Values;
+		Values.Reserve(Samples.Num());
+		for (const SampleType& Sample : Samples)
+		{
+			Values.Add(float(GetValue(Sample)));
+		}
+		return Compute(Values);
+	}
+
+	/** avg, p50, p90, p95, p99 and max fields */
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/** Where and how a run writes its results */
+struct LIQUIDX_TEST_SIMPLE_API FPerfReport
+{
+	/** Path without extension: -<OutputSwitch>= when given, otherwise Saved/<Folder>/<Name>-<date> */
+	static FString GetOutputPath(const TCHAR* OutputSwitch, const FString& Folder, const FString& Name);
+
+	/** JSON root with the build configuration, map and whether World is a dedicated server */
+	static TSharedRef<FJsonObject> MakeJson(const UWorld* World);
+
+	/** Write Csv to OutputPath.csv and Json, when set, to OutputPath.json */
+	static void Write(const FString& OutputPath, const FString& Csv, const TSharedPtr<FJsonObject>& Json = nullptr);
+};
+
+/**
+ * Actors a run spawns or borrows: /Engine/BasicShapes/Cube walls, cubes acquired from the cube pool
+ * and anything else it adds. Clear destroys them and releases the cubes back to the pool, except in
+ * a world being torn down, which takes the actors with it. Held weakly; the world owns the actors.
+ */
+class LIQUIDX_TEST_SIMPLE_API FPerfArena
+{
+public:
+	/** A movable wall at Location: the 1 m engine cube at Scale, so Scale is its size in metres */
+	AStaticMeshActor* SpawnWall(UWorld* World, const FVector& Location, const FRotator& Rotation, const FVector& Scale);
+
+	/** A cube from World's cube pool, null when there is no pool or it can't hand one out */
+	APickupCube* AcquireCube(UWorld* World, UClass* CubeClass, const FTransform& Transform);
+
+	/** Destroy Actor with the rest of the arena */
+	void Add(AActor* Actor);
+
+	void Clear(UWorld* World);
+
+	int32 GetNumCubes() const { return Cubes.Num(); }
+
+private:
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<TWeakObjectPtr<APickupCube>> Cubes;
+};
+
+/**
+ * A run started by a -<Switch>[=<Value>] command-line switch. Each switch starts one run per process,
+ * in the first game world that begins play, and the process exits when that run finishes.
+ */
+class LIQUIDX_TEST_SIMPLE_API FPerfCommandLineRun
+{
+public:
+	/** Whether World starts the -Switch run, with the switch's value in OutValue */
+	bool Claim(const UWorld& World, const TCHAR* Switch, FString& OutValue);
+
+	/** Exit with 0 when bSucceeded and 1 otherwise, if this run came from the command line */
+	void Finish(bool bSucceeded);
+
+	bool IsClaimed() const { return bClaimed; }
+
+private:
+	bool bClaimed = false;
+};
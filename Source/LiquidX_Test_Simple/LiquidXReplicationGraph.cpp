@@ -0,0 +1,260 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXReplicationGraph.h"
+#include "LiquidX_Test_SimpleCharacter.h"
+#include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "InteractiveActor.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLiquidXRepGraph, Log, All);
+
+//////////////////////////////////////////////////////////////////////////
+// ULiquidXReplicationGraphNode_OwnedActors
+
+void ULiquidXReplicationGraphNode_OwnedActors::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	ReplicationActorList.Reset();
+
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		if (Viewer.InViewer)
+		{
+			ReplicationActorList.Add(Viewer.InViewer);
+		}
+
+		if (Viewer.ViewTarget && Viewer.ViewTarget != Viewer.InViewer)
+		{
+			ReplicationActorList.Add(Viewer.ViewTarget);
+		}
+
+		const ALiquidX_Test_SimpleCharacter* Character = Cast<ALiquidX_Test_SimpleCharacter>(Viewer.ViewTarget);
+		if (Character && Character->GetHeldCube())
+		{
+			ReplicationActorList.Add(Character->GetHeldCube());
+		}
+	}
+
+	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// ULiquidXReplicationGraph
+
+void ULiquidXReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	GlobalActorReplicationInfoMap.SetClassInfo(AActor::StaticClass(), MakeClassInfo(AActor::StaticClass()));
+
+	FClassReplicationInfo CubeInfo = MakeClassInfo(APickupCube::StaticClass());
+	CubeInfo.SetCullDistanceSquared(FMath::Square(CubeCullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(APickupCube::StaticClass(), CubeInfo);
+
+	FClassReplicationInfo InteractiveInfo = MakeClassInfo(AInteractiveActor::StaticClass());
+	InteractiveInfo.SetCullDistanceSquared(FMath::Square(CubeCullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(AInteractiveActor::StaticClass(), InteractiveInfo);
+
+	FClassReplicationInfo CharacterInfo = MakeClassInfo(ALiquidX_Test_SimpleCharacter::StaticClass());
+	CharacterInfo.SetCullDistanceSquared(FMath::Square(CharacterCullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(ALiquidX_Test_SimpleCharacter::StaticClass(), CharacterInfo);
+}
+
+FClassReplicationInfo ULiquidXReplicationGraph::MakeClassInfo(UClass* Class) const
+{
+	const AActor* ClassDefaults = Class->GetDefaultObject<AActor>();
+
+	FClassReplicationInfo Info;
+	Info.SetCullDistanceSquared(ClassDefaults->NetCullDistanceSquared);
+	Info.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ClassDefaults->NetUpdateFrequency);
+	return Info;
+}
+
+void ULiquidXReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = SpatialCellSize;
+	GridNode->SpatialBias = FVector2D(-SpatialBiasExtent, -SpatialBiasExtent);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void ULiquidXReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	ULiquidXReplicationGraphNode_OwnedActors* OwnedActorsNode = CreateNewNode<ULiquidXReplicationGraphNode_OwnedActors>();
+	AddConnectionGraphNode(OwnedActorsNode, RepGraphConnection);
+}
+
+ULiquidXReplicationGraph::EClassRepPolicy ULiquidXReplicationGraph::GetPolicy(const AActor* Actor) const
+{
+	if (Actor->bAlwaysRelevant)
+	{
+		return EClassRepPolicy::AlwaysRelevant;
+	}
+	if (Actor->bOnlyRelevantToOwner)
+	{
+		return EClassRepPolicy::OwnerOnly;
+	}
+	if (Actor->IsA<APickupCube>() || Actor->IsA<AInteractiveActor>())
+	{
+		return EClassRepPolicy::SpatializeDormancy;
+	}
+	return EClassRepPolicy::SpatializeDynamic;
+}
+
+void ULiquidXReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetPolicy(ActorInfo.Actor))
+	{
+	case EClassRepPolicy::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EClassRepPolicy::OwnerOnly:
+		// Gathered per connection by ULiquidXReplicationGraphNode_OwnedActors
+		break;
+	case EClassRepPolicy::SpatializeDormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	case EClassRepPolicy::SpatializeDynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	}
+}
+
+void ULiquidXReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetPolicy(ActorInfo.Actor))
+	{
+	case EClassRepPolicy::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case EClassRepPolicy::OwnerOnly:
+		break;
+	case EClassRepPolicy::SpatializeDormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	case EClassRepPolicy::SpatializeDynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	}
+}
+
+int32 ULiquidXReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+	const float ElapsedMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	int64 TotalBytesPerSecond = 0;
+	const int32 NumConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	for (int32 ConnectionIndex = 0; ConnectionIndex < NumConnections; ++ConnectionIndex)
+	{
+		if (const UNetConnection* Connection = NetDriver->ClientConnections[ConnectionIndex])
+		{
+			TotalBytesPerSecond += Connection->OutBytesPerSecond;
+		}
+	}
+
+	Stats.NumFrames++;
+	Stats.NumConnections = NumConnections;
+	Stats.NumActorsReplicated = NumReplicated;
+	Stats.LastReplicateMs = ElapsedMs;
+	Stats.MaxReplicateMs = FMath::Max(Stats.MaxReplicateMs, ElapsedMs);
+	Stats.TotalReplicateMs += ElapsedMs;
+	Stats.AvgReplicateMs = Stats.TotalReplicateMs / Stats.NumFrames;
+	if (NumConnections > 0)
+	{
+		Stats.TotalBytesPerConnection += double(TotalBytesPerSecond) / NumConnections;
+	}
+	Stats.AvgBytesPerConnectionPerSecond = Stats.TotalBytesPerConnection / Stats.NumFrames;
+
+	return NumReplicated;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark commands
+
+static ULiquidXReplicationGraph* GetLiquidXReplicationGraph(UWorld* World)
+{
+	UNetDriver* Driver = World ? World->GetNetDriver() : nullptr;
+	return Driver ? Driver->GetReplicationDriver<ULiquidXReplicationGraph>() : nullptr;
+}
+
+static void SpawnBenchmarkCubes(const TArray<FString>& Args, UWorld* World)
+{
+	UPickupCubePoolSubsystem* CubePool = World ? World->GetSubsystem<UPickupCubePoolSubsystem>() : nullptr;
+	if (!CubePool || Args.Num() < 1)
+	{
+		UE_LOG(LogLiquidXRepGraph, Warning, TEXT("Usage: LiquidX.RepBench.SpawnCubes <Count> [Spacing]"));
+		return;
+	}
+
+	const int32 Count = FCString::Atoi(*Args[0]);
+	const float Spacing = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 150.0f;
+
+	// Use the level's cube class (the Blueprint with a mesh) when there is one
+	TSubclassOf<APickupCube> CubeClass = APickupCube::StaticClass();
+	for (TActorIterator<APickupCube> It(World); It; ++It)
+	{
+		CubeClass = It->GetClass();
+		break;
+	}
+
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt(float(Count)));
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location((Index % Side - Side / 2) * Spacing, (Index / Side - Side / 2) * Spacing, 100.0f);
+		Transforms.Add(FTransform(Location));
+	}
+
+	CubePool->RequestSpawn(CubeClass, Transforms);
+	UE_LOG(LogLiquidXRepGraph, Log, TEXT("Queued %d %s cubes"), Count, *GetNameSafe(CubeClass));
+}
+
+static void ReportBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	const ULiquidXReplicationGraph* Graph = GetLiquidXReplicationGraph(World);
+	if (!Graph)
+	{
+		UE_LOG(LogLiquidXRepGraph, Warning, TEXT("No LiquidX replication graph on this world (run on the server)"));
+		return;
+	}
+
+	const FLiquidXReplicationStats& Stats = Graph->GetStats();
+	UE_LOG(LogLiquidXRepGraph, Display, TEXT("RepBench: frames=%d connections=%d actors/frame=%d replicate ms avg=%.3f max=%.3f bytes/connection/s=%.0f"),
+		Stats.NumFrames, Stats.NumConnections, Stats.NumActorsReplicated, Stats.AvgReplicateMs, Stats.MaxReplicateMs, Stats.AvgBytesPerConnectionPerSecond);
+}
+
+static void ResetBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (ULiquidXReplicationGraph* Graph = GetLiquidXReplicationGraph(World))
+	{
+		Graph->ResetStats();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnBenchmarkCubesCommand(
+	TEXT("LiquidX.RepBench.SpawnCubes"),
+	TEXT("Spawn <Count> [Spacing] pickup cubes in a grid around the origin through the cube pool"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SpawnBenchmarkCubes));
+
+static FAutoConsoleCommandWithWorldAndArgs ReportBenchmarkCommand(
+	TEXT("LiquidX.RepBench.Report"),
+	TEXT("Log server replication ms/frame and bytes per connection"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReportBenchmark));
+
+static FAutoConsoleCommandWithWorldAndArgs ResetBenchmarkCommand(
+	TEXT("LiquidX.RepBench.Reset"),
+	TEXT("Reset the replication benchmark stats"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ResetBenchmark));
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "LiquidXReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+
+/** Server replication cost, averaged over the frames since the last reset */
+USTRUCT(BlueprintType)
+struct FLiquidXReplicationStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	int32 NumFrames = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	int32 NumConnections = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	int32 NumActorsReplicated = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float LastReplicateMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float AvgReplicateMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float MaxReplicateMs = 0.0f;
+
+	/** Outgoing bytes per second per client connection, averaged over frames and connections */
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float AvgBytesPerConnectionPerSecond = 0.0f;
+
+	double TotalReplicateMs = 0.0;
+	double TotalBytesPerConnection = 0.0;
+};
+
+/**
+ * Gathers, per connection, the viewer's controller, its pawn and the pawn's held cube, so a cube
+ * in hand stays relevant to its holder whatever the grid says.
+ */
+UCLASS()
+class LIQUIDX_TEST_SIMPLE_API ULiquidXReplicationGraphNode_OwnedActors : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override {}
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override {}
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+	FActorRepListRefView ReplicationActorList;
+};
+
+/**
+ * Replication graph for cube-heavy maps. Pickup cubes and interactive actors live in a 2D grid and
+ * are treated as static while dormant, so thousands of idle cubes cost nothing per connection.
+ * Everything else that moves is spatialized dynamically; always-relevant actors go to one list.
+ *
+ * Benchmark: run a server with -server -nullrhi -log -ExecCmds="LiquidX.RepBench.SpawnCubes <N>",
+ * connect M clients with 127.0.0.1 -game -nullrhi -nosound, then LiquidX.RepBench.Report on the
+ * server prints replication ms/frame and bytes/connection (LiquidX.RepBench.Reset starts over).
+ */
+UCLASS(transient, config = Game)
+class LIQUIDX_TEST_SIMPLE_API ULiquidXReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	// UReplicationGraph interface
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	const FLiquidXReplicationStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FLiquidXReplicationStats(); }
+
+	/** Edge length of a spatialization grid cell */
+	UPROPERTY(Config)
+	float SpatialCellSize = 10000.0f;
+
+	/** Grid origin offset; the grid covers +/- this much around the world origin without rebuilding */
+	UPROPERTY(Config)
+	float SpatialBiasExtent = 200000.0f;
+
+	UPROPERTY(Config)
+	float CubeCullDistance = 8000.0f;
+
+	UPROPERTY(Config)
+	float CharacterCullDistance = 15000.0f;
+
+private:
+	enum class EClassRepPolicy : uint8
+	{
+		AlwaysRelevant,
+		OwnerOnly,
+		SpatializeDormancy,
+		SpatializeDynamic
+	};
+
+	EClassRepPolicy GetPolicy(const AActor* Actor) const;
+
+	/** Class settings from the class defaults' NetUpdateFrequency and NetCullDistanceSquared */
+	FClassReplicationInfo MakeClassInfo(UClass* Class) const;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+	FLiquidXReplicationStats Stats;
+};
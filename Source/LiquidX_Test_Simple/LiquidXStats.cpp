@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LiquidXStats.h"
+
+int32 FGameplayTraceCounter::NumTraces = 0;
+
+#if LIQUIDX_STATS
+
+DEFINE_STAT(STAT_LiquidX_MovementState);
+DEFINE_STAT(STAT_LiquidX_Jetpack);
+DEFINE_STAT(STAT_LiquidX_WallRunCheck);
+DEFINE_STAT(STAT_LiquidX_WallRunUpdate);
+DEFINE_STAT(STAT_LiquidX_PickupCube);
+DEFINE_STAT(STAT_LiquidX_ThrowCube);
+DEFINE_STAT(STAT_LiquidX_PunchDamage);
+DEFINE_STAT(STAT_LiquidX_Interact);
+DEFINE_STAT(STAT_LiquidX_Significance);
+DEFINE_STAT(STAT_LiquidX_DamageFlush);
+DEFINE_STAT(STAT_LiquidX_HealthEffects);
+DEFINE_STAT(STAT_LiquidX_WallRunQueries);
+DEFINE_STAT(STAT_LiquidX_PickupQueries);
+DEFINE_STAT(STAT_LiquidX_PunchQueries);
+DEFINE_STAT(STAT_LiquidX_InteractQueries);
+DEFINE_STAT(STAT_LiquidX_SettleQueries);
+DEFINE_STAT(STAT_LiquidX_DamageEvents);
+DEFINE_STAT(STAT_LiquidX_CubesDamaged);
+DEFINE_STAT(STAT_LiquidX_CubesIdle);
+DEFINE_STAT(STAT_LiquidX_CubesSimulating);
+DEFINE_STAT(STAT_LiquidX_CubesHeld);
+DEFINE_STAT(STAT_LiquidX_CubesPooled);
+
+UE_TRACE_CHANNEL_DEFINE(LiquidXChannel);
+
+#endif
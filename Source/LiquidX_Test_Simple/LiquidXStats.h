@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/**
+ * Stats and Insights instrumentation for the gameplay hot paths. "stat LiquidX" shows the cycle
+ * counters, per-ability scene queries, cube counts and damage events; an Insights capture with
+ * -trace=cpu,stats,LiquidX adds a timing scope per counter. All of it compiles out in Shipping.
+ */
+#define LIQUIDX_STATS (!UE_BUILD_SHIPPING)
+
+/** Scene queries issued by gameplay code, sampled and reset every frame by FPerfFrameSampler. Game thread only. */
+struct LIQUIDX_TEST_SIMPLE_API FGameplayTraceCounter
+{
+	static int32 NumTraces;
+
+	FORCEINLINE static void Add(int32 Count = 1) { NumTraces += Count; }
+};
+
+#if LIQUIDX_STATS
+
+DECLARE_STATS_GROUP(TEXT("LiquidX"), STATGROUP_LiquidX, STATCAT_Advanced);
+
+// Abilities and interaction
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement State"), STAT_LiquidX_MovementState, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Jetpack"), STAT_LiquidX_Jetpack, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wall Run Check"), STAT_LiquidX_WallRunCheck, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wall Run Update"), STAT_LiquidX_WallRunUpdate, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pickup Cube"), STAT_LiquidX_PickupCube, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Throw Cube"), STAT_LiquidX_ThrowCube, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Punch Damage"), STAT_LiquidX_PunchDamage, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interact"), STAT_LiquidX_Interact, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Significance"), STAT_LiquidX_Significance, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+
+// Cube systems
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Damage Flush"), STAT_LiquidX_DamageFlush, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Health Effects"), STAT_LiquidX_HealthEffects, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+
+// Scene queries per ability, per frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries: Wall Run"), STAT_LiquidX_WallRunQueries, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries: Pickup"), STAT_LiquidX_PickupQueries, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries: Punch"), STAT_LiquidX_PunchQueries, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries: Interact"), STAT_LiquidX_InteractQueries, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries: Cube Settle"), STAT_LiquidX_SettleQueries, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+
+// Damage events applied per frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_LiquidX_DamageEvents, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cubes Damaged"), STAT_LiquidX_CubesDamaged, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+
+// Cubes by state; each cube is in exactly one
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cubes Idle"), STAT_LiquidX_CubesIdle, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cubes Simulating"), STAT_LiquidX_CubesSimulating, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cubes Held"), STAT_LiquidX_CubesHeld, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cubes Pooled"), STAT_LiquidX_CubesPooled, STATGROUP_LiquidX, LIQUIDX_TEST_SIMPLE_API);
+
+UE_TRACE_CHANNEL_EXTERN(LiquidXChannel, LIQUIDX_TEST_SIMPLE_API);
+
+/** Time the enclosing scope in "stat LiquidX" and as an Insights event on the LiquidX channel */
+#define LIQUIDX_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, LiquidXChannel)
+
+/** Count Count scene queries against an ability's query stat and the benchmark's trace counter */
+#define LIQUIDX_COUNT_SCENE_QUERIES(Stat, Count) \
+	INC_DWORD_STAT_BY(Stat, Count); \
+	FGameplayTraceCounter::Add(Count)
+
+#define LIQUIDX_INC_STAT_BY(Stat, Amount) INC_DWORD_STAT_BY(Stat, Amount)
+
+#else
+
+#define LIQUIDX_SCOPE_CYCLE_COUNTER(Stat)
+#define LIQUIDX_COUNT_SCENE_QUERIES(Stat, Count)
+#define LIQUIDX_INC_STAT_BY(Stat, Amount)
+
+#endif
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+/**
+ * Game world for automation tests. It is created with its subsystems and begun play, and is torn
+ * down when it goes out of scope. Tick advances it the way the engine loop does and returns the
+ * game thread time it took, for tests that compare costs.
+ */
+class FLiquidXTestWorld
+{
+public:
+	FLiquidXTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("LiquidXTestWorld"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+	}
+
+	~FLiquidXTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	FLiquidXTestWorld(const FLiquidXTestWorld&) = delete;
+	FLiquidXTestWorld& operator=(const FLiquidXTestWorld&) = delete;
+
+	UWorld* Get() const { return World; }
+
+	/** Tick the world NumFrames times; returns the average milliseconds per frame */
+	double Tick(int32 NumFrames, float DeltaSeconds = 1.0f / 60.0f)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			World->Tick(LEVELTICK_All, DeltaSeconds);
+		}
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / FMath::Max(1, NumFrames);
+	}
+
+private:
+	UWorld* World = nullptr;
+};
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -8,6 +8,6 @@ public class LiquidX_Test_Simple : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "PhysicsCore" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "AIModule", "PhysicsCore", "NetCore", "ReplicationGraph", "MassEntity", "MassCommon", "UMG", "Json" });
 	}
 }
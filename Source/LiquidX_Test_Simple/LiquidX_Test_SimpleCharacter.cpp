@@ -12,19 +12,35 @@
 #include "InputActionValue.h"
 #include "Kismet/GameplayStatics.h"
 #include "PickupCube.h"
+#include "PickupCubeInstanceSubsystem.h"
 #include "InteractiveActor.h"
+#include "InteractionIndexSubsystem.h"
+#include "InteractionFocusComponent.h"
+#include "CubeSettleSubsystem.h"
+#include "CubeDamageSubsystem.h"
+#include "CubeMassSubsystem.h"
+#include "LiquidXStats.h"
 #include "Engine/DamageEvents.h"
-#include "DrawDebugHelpers.h"
+#include "GameplayDebugDrawSubsystem.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "Animation/AnimInstance.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "CharacterAbilityComponent.h"
+#include "CharacterAbilities.h"
+#include "LiquidXCharacterMovementComponent.h"
+#include "InputRecordingSubsystem.h"
+#include "CharacterSignificanceSubsystem.h"
+#include "LiquidXHUDWidgets.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
 //////////////////////////////////////////////////////////////////////////
 // ALiquidX_Test_SimpleCharacter
 
-ALiquidX_Test_SimpleCharacter::ALiquidX_Test_SimpleCharacter()
+ALiquidX_Test_SimpleCharacter::ALiquidX_Test_SimpleCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<ULiquidXCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -40,14 +56,8 @@ ALiquidX_Test_SimpleCharacter::ALiquidX_Test_SimpleCharacter()
 	GetCharacterMovement()->bOrientRotationToMovement = true; // Character moves in the direction of input...	
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 500.0f, 0.0f); // ...at this rotation rate
 
-	// Note: For faster iteration times these variables, and many more, can be tweaked in the Character Blueprint
-	// instead of recompiling to adjust them
-	GetCharacterMovement()->JumpZVelocity = 700.f;
-	GetCharacterMovement()->AirControl = 0.35f;
-	GetCharacterMovement()->MaxWalkSpeed = 500.f;
-	GetCharacterMovement()->MinAnalogWalkSpeed = 20.f;
-	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
-	GetCharacterMovement()->BrakingDecelerationFalling = 1500.0f;
+	// Speeds, gravity and braking come from the tuning asset (see ApplyTuning); start from its defaults
+	ApplyMovementTuning();
 
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
@@ -60,16 +70,30 @@ ALiquidX_Test_SimpleCharacter::ALiquidX_Test_SimpleCharacter()
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
 
+	// Movement abilities tick on their own, only while they are active
+	AbilityComponent = CreateDefaultSubobject<UCharacterAbilityComponent>(TEXT("AbilityComponent"));
+	AbilityComponent->AbilityClasses = {
+		UJetpackAbility::StaticClass(),
+		UWallRunAbility::StaticClass(),
+		UDoubleJumpAbility::StaticClass(),
+		USprintAbility::StaticClass()
+	};
+
+	// Interaction prompt target, fed by the interaction index rather than per-frame traces
+	FocusComponent = CreateDefaultSubobject<UInteractionFocusComponent>(TEXT("FocusComponent"));
+	FocusComponent->FocusRange = Tuning.InteractionRange;
+	FocusComponent->FocusConeHalfAngle = Tuning.InteractionConeHalfAngle;
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
 
-void ALiquidX_Test_SimpleCharacter::Tick(float DeltaTime)
+void ALiquidX_Test_SimpleCharacter::PostInitializeComponents()
 {
-	Super::Tick(DeltaTime);
-	UpdateJetpack(DeltaTime);
-	CheckWallRun();
-	UpdateWallRun(DeltaTime);
+	Super::PostInitializeComponents();
+
+	ApplyTuning();
+	SetJetpackFuel(Tuning.MaxJetpackFuel);
 }
 
 void ALiquidX_Test_SimpleCharacter::BeginPlay()
@@ -77,9 +101,131 @@ void ALiquidX_Test_SimpleCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
-	bJetpackActive = false;
+	// After Super, so the abilities the significance settings reach into exist
+	if (UCharacterSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCharacterSignificanceSubsystem>())
+	{
+		Significance->RegisterCharacter(this);
+	}
+
+#if WITH_EDITOR
+	TuningChangedHandle = UCharacterTuningData::OnTuningChanged.AddUObject(this, &ALiquidX_Test_SimpleCharacter::HandleTuningChanged);
+#endif
+}
+
+void ALiquidX_Test_SimpleCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+#if WITH_EDITOR
+	UCharacterTuningData::OnTuningChanged.Remove(TuningChangedHandle);
+#endif
+
+	if (UCharacterSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCharacterSignificanceSubsystem>())
+	{
+		Significance->UnregisterCharacter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+ULiquidXCharacterMovementComponent* ALiquidX_Test_SimpleCharacter::GetLiquidXMovement() const
+{
+	return Cast<ULiquidXCharacterMovementComponent>(GetCharacterMovement());
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Tuning
+
+void ALiquidX_Test_SimpleCharacter::SetTuningData(UCharacterTuningData* NewTuningData)
+{
+	TuningData = NewTuningData;
+	ApplyTuning();
+}
+
+void ALiquidX_Test_SimpleCharacter::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	// The deprecated properties keep the old defaults unless the saved archetype overrode them
+	const FCharacterTuning OldDefaults;
+#define LIQUIDX_MIGRATE_TUNING(Name) \
+	if (Name##_DEPRECATED != OldDefaults.Name) \
+	{ \
+		DefaultTuning.Name = Name##_DEPRECATED; \
+		Name##_DEPRECATED = OldDefaults.Name; \
+	}
+
+	LIQUIDX_MIGRATE_TUNING(JetpackForce)
+	LIQUIDX_MIGRATE_TUNING(JetpackFuelConsumptionRate)
+	LIQUIDX_MIGRATE_TUNING(JetpackFuelRefillRate)
+	LIQUIDX_MIGRATE_TUNING(ThrowForce)
+	LIQUIDX_MIGRATE_TUNING(InteractionRange)
+	LIQUIDX_MIGRATE_TUNING(InteractionConeHalfAngle)
+	LIQUIDX_MIGRATE_TUNING(PunchForce)
+	LIQUIDX_MIGRATE_TUNING(PunchDamage)
+	LIQUIDX_MIGRATE_TUNING(bAreaPunch)
+	LIQUIDX_MIGRATE_TUNING(DoubleJumpForce)
+	LIQUIDX_MIGRATE_TUNING(PunchAnimationDelay)
+	LIQUIDX_MIGRATE_TUNING(SprintSpeedMultiplier)
+	LIQUIDX_MIGRATE_TUNING(WallRunSpeed)
+	LIQUIDX_MIGRATE_TUNING(WallRunDuration)
+	LIQUIDX_MIGRATE_TUNING(WallCheckDistance)
+	LIQUIDX_MIGRATE_TUNING(WallRunForwardOffset)
+
+	// The jetpack tank and gravity used to live on the movement component
+	if (ULiquidXCharacterMovementComponent* Movement = GetLiquidXMovement())
+	{
+		if (Movement->JetpackGravityScale_DEPRECATED != OldDefaults.JetpackGravityScale)
+		{
+			DefaultTuning.JetpackGravityScale = Movement->JetpackGravityScale_DEPRECATED;
+			Movement->JetpackGravityScale_DEPRECATED = OldDefaults.JetpackGravityScale;
+		}
+		if (Movement->MaxJetpackFuel_DEPRECATED != OldDefaults.MaxJetpackFuel)
+		{
+			DefaultTuning.MaxJetpackFuel = Movement->MaxJetpackFuel_DEPRECATED;
+			Movement->MaxJetpackFuel_DEPRECATED = OldDefaults.MaxJetpackFuel;
+		}
+	}
+#undef LIQUIDX_MIGRATE_TUNING
+#endif
 }
 
+void ALiquidX_Test_SimpleCharacter::ApplyTuning()
+{
+	const UCharacterTuningData* Override = UCharacterTuningData::GetCommandLineOverride();
+	const UCharacterTuningData* Source = Override ? Override : TuningData.Get();
+	Tuning = Source ? Source->Tuning : DefaultTuning;
+
+	ApplyMovementTuning();
+	FocusComponent->FocusRange = Tuning.InteractionRange;
+	FocusComponent->FocusConeHalfAngle = Tuning.InteractionConeHalfAngle;
+
+	// A new tank size moves the fill fraction even when the fuel doesn't
+	FuelNotifyFilter.Reset();
+	SetJetpackFuel(JetpackFuel);
+}
+
+void ALiquidX_Test_SimpleCharacter::ApplyMovementTuning()
+{
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	Movement->MaxWalkSpeed = Tuning.WalkSpeed;
+	Movement->MinAnalogWalkSpeed = Tuning.MinAnalogWalkSpeed;
+	Movement->JumpZVelocity = Tuning.JumpZVelocity;
+	Movement->AirControl = Tuning.AirControl;
+	Movement->BrakingDecelerationWalking = Tuning.BrakingDecelerationWalking;
+	Movement->BrakingDecelerationFalling = Tuning.BrakingDecelerationFalling;
+	Movement->GravityScale = Tuning.GravityScale;
+}
+
+#if WITH_EDITOR
+void ALiquidX_Test_SimpleCharacter::HandleTuningChanged(const UCharacterTuningData* ChangedData)
+{
+	if (ChangedData == TuningData)
+	{
+		ApplyTuning();
+	}
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -97,33 +243,35 @@ void ALiquidX_Test_SimpleCharacter::SetupPlayerInputComponent(UInputComponent* P
 	// Set up action bindings
 	if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerInputComponent)) {
 		
+		// Every binding goes through OnInputAction so input can be recorded and replayed; HandleInput maps each to its handler
+
 		// Jumping
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Started, this, &ALiquidX_Test_SimpleCharacter::DoubleJump);
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
+		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Started, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::JumpStarted);
+		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::JumpCompleted);
 
 		// Moving
-		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::Move);
+		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::Move);
 
 		// Looking
-		EnhancedInputComponent->BindAction(LookAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::Look);
+		EnhancedInputComponent->BindAction(LookAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::Look);
 
 		// Jetpack
-		EnhancedInputComponent->BindAction(JetpackAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::ActivateJetpack);
-		EnhancedInputComponent->BindAction(JetpackAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::DeactivateJetpack);
+		EnhancedInputComponent->BindAction(JetpackAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::Jetpack);
+		EnhancedInputComponent->BindAction(JetpackAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::JetpackCompleted);
 
 		// PickupThrow
-		EnhancedInputComponent->BindAction(PickupThrowAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::PickupCube);
-		EnhancedInputComponent->BindAction(PickupThrowAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::ThrowCube);
+		EnhancedInputComponent->BindAction(PickupThrowAction, ETriggerEvent::Started, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::PickupThrow);
+		EnhancedInputComponent->BindAction(PickupThrowAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::PickupThrowCompleted);
 
 		// Interact
-		EnhancedInputComponent->BindAction(InteractAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::Interact);
+		EnhancedInputComponent->BindAction(InteractAction, ETriggerEvent::Started, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::Interact);
 
 		// Punch
-		EnhancedInputComponent->BindAction(PunchAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::PunchCube);
+		EnhancedInputComponent->BindAction(PunchAction, ETriggerEvent::Started, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::Punch);
 
 		// Sprint
-		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::StartSprint);
-		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::StopSprint);
+		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Triggered, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::Sprint);
+		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Completed, this, &ALiquidX_Test_SimpleCharacter::OnInputAction, ERecordedInput::SprintCompleted);
 
 	}
 	else
@@ -132,6 +280,65 @@ void ALiquidX_Test_SimpleCharacter::SetupPlayerInputComponent(UInputComponent* P
 	}
 }
 
+void ALiquidX_Test_SimpleCharacter::OnInputAction(const FInputActionInstance& Instance, ERecordedInput Input)
+{
+	const FVector2D Value = Instance.GetValue().Get<FVector2D>();
+	if (UInputRecordingSubsystem* Recording = GetWorld()->GetSubsystem<UInputRecordingSubsystem>())
+	{
+		if (Recording->IsRecording())
+		{
+			Recording->RecordInput(this, Input, Value);
+		}
+	}
+
+	HandleInput(Input, Value);
+}
+
+void ALiquidX_Test_SimpleCharacter::HandleInput(ERecordedInput Input, const FVector2D& Value)
+{
+	switch (Input)
+	{
+	case ERecordedInput::Move:
+		Move(FInputActionValue(Value));
+		break;
+	case ERecordedInput::Look:
+		Look(FInputActionValue(Value));
+		break;
+	case ERecordedInput::JumpStarted:
+		DoubleJump();
+		break;
+	case ERecordedInput::JumpCompleted:
+		StopJumping();
+		break;
+	case ERecordedInput::Jetpack:
+		ActivateJetpack();
+		break;
+	case ERecordedInput::JetpackCompleted:
+		DeactivateJetpack();
+		break;
+	case ERecordedInput::PickupThrow:
+		PickupCube();
+		break;
+	case ERecordedInput::PickupThrowCompleted:
+		ThrowCube();
+		break;
+	case ERecordedInput::Interact:
+		Interact();
+		break;
+	case ERecordedInput::Punch:
+		PunchCube();
+		break;
+	case ERecordedInput::Sprint:
+		StartSprint();
+		break;
+	case ERecordedInput::SprintCompleted:
+		StopSprint();
+		break;
+	default:
+		break;
+	}
+}
+
 void ALiquidX_Test_SimpleCharacter::Move(const FInputActionValue& Value)
 {
 	// input is a Vector2D
@@ -171,40 +378,63 @@ void ALiquidX_Test_SimpleCharacter::Look(const FInputActionValue& Value)
 //////Jetpack/////
 void ALiquidX_Test_SimpleCharacter::ActivateJetpack()
 {
-	bJetpackActive = true;
+	AbilityComponent->TryActivateAbility(UJetpackAbility::StaticClass());
 }
 
 void ALiquidX_Test_SimpleCharacter::DeactivateJetpack()
 {
-	bJetpackActive = false;
+	AbilityComponent->DeactivateAbility(UJetpackAbility::StaticClass());
 }
 
-void ALiquidX_Test_SimpleCharacter::UpdateJetpack(float DeltaTime)
+void ALiquidX_Test_SimpleCharacter::SetJetpackFuel(float NewFuel)
 {
-	if (bJetpackActive && JetpackFuel > 0)
+	JetpackFuel = FMath::Clamp(NewFuel, 0.0f, Tuning.MaxJetpackFuel);
+	if (FuelNotifyFilter.Update(JetpackFuel, Tuning.MaxJetpackFuel, FuelNotifyStep))
 	{
-		// Apply upward force
-		GetCharacterMovement()->AddForce(FVector(0, 0, JetpackForce));
+		OnJetpackFuelChanged.Broadcast(JetpackFuel, Tuning.MaxJetpackFuel);
+	}
+}
 
-		// Consume fuel
-		JetpackFuel = FMath::Max(0.0f, JetpackFuel - JetpackFuelConsumptionRate * DeltaTime);
+void ALiquidX_Test_SimpleCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
 
-		// Disable gravity while jetpack is active
-		GetCharacterMovement()->GravityScale = 0.1f;
+	// The HUD may be built later this frame, after possession; take its bars over on the next one
+	if (IsLocallyControlled() && IsPlayerControlled())
+	{
+		GetWorldTimerManager().SetTimerForNextTick(this, &ALiquidX_Test_SimpleCharacter::BindJetpackBars);
 	}
-	else
+	else if (JetpackBarDriver)
+	{
+		JetpackBarDriver->Unbind();
+	}
+}
+
+void ALiquidX_Test_SimpleCharacter::BindJetpackBars()
+{
+	if (!IsLocallyControlled() || !IsPlayerControlled())
 	{
-		// Refill fuel when jetpack is not in use
-		JetpackFuel = FMath::Min(100.0f, JetpackFuel + JetpackFuelRefillRate * DeltaTime);
+		return;
+	}
 
-		// Restore normal gravity
-		GetCharacterMovement()->GravityScale = 1.75f;
+	if (!JetpackBarDriver)
+	{
+		JetpackBarDriver = NewObject<UJetpackBarDriver>(this);
 	}
+	JetpackBarDriver->Bind(this);
 }
 
 /////Cube/////
 void ALiquidX_Test_SimpleCharacter::PickupCube()
 {
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_PickupCube);
+
+	if (!HasAuthority())
+	{
+		ServerPickupCube();
+		return;
+	}
+
 	if (HeldCube)
 	{
 		ThrowCube();
@@ -212,76 +442,110 @@ void ALiquidX_Test_SimpleCharacter::PickupCube()
 	}
 
 	FVector Start = GetActorLocation();
-	float Radius = 150.0f;
+	const float Radius = Tuning.PickupRadius;
 	FVector End = Start; // Sphere trace will use the same start and end for radius.
 
+	// Idle cubes in range may be instances; turn them back into actors before looking for one
+	TArray<APickupCube*> PromotedCubes;
+	if (UPickupCubeInstanceSubsystem* Instancing = GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>())
+	{
+		Instancing->PromoteInRadius(Start, Radius, PromotedCubes);
+	}
+	if (UCubeMassSubsystem* CubeMass = GetWorld()->GetSubsystem<UCubeMassSubsystem>())
+	{
+		CubeMass->PromoteInRadius(Start, Radius, PromotedCubes);
+	}
+
 	FHitResult HitResult;
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(this);
 
-	// Perform the sphere trace
-	if (GetWorld()->SweepSingleByChannel(
-		HitResult,
-		Start,
-		End,
-		FQuat::Identity, // No rotation
-		ECC_Visibility,
-		FCollisionShape::MakeSphere(Radius),
-		QueryParams))
-	{
-		APickupCube* Cube = Cast<APickupCube>(HitResult.GetActor());
-		if (Cube)
+	// The interaction index knows every cube, including ones promoted just now
+	APickupCube* Cube = nullptr;
+	if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+	{
+		Cube = InteractionIndex->FindNearest<APickupCube>(Start, Radius);
+	}
+
+	// Perform the sphere trace for cubes the index doesn't know about
+	if (!Cube)
+	{
+		LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_PickupQueries, 1);
+		if (GetWorld()->SweepSingleByChannel(
+			HitResult,
+			Start,
+			End,
+			FQuat::Identity, // No rotation
+			ECC_Visibility,
+			FCollisionShape::MakeSphere(Radius),
+			QueryParams))
 		{
-			HeldCube = Cube;
-			HeldCube->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, "hand_r");
-			HeldCube->GetStaticMeshComponent()->SetSimulatePhysics(false);
-			HeldCube->GetStaticMeshComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-			UE_LOG(LogTemp, Warning, TEXT("Picked up"));
+			Cube = Cast<APickupCube>(HitResult.GetActor());
 		}
 	}
 
-	// Draw a debug sphere to visualize the sphere trace
-	DrawDebugSphere(GetWorld(), Start, Radius, 12, FColor::Green, false, 1.0f);
+	if (Cube)
+	{
+		// Held cubes move every frame, so keep them awake for replication until they settle again
+		Cube->SetNetActive(true);
+
+		HeldCube = Cube;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ALiquidX_Test_SimpleCharacter, HeldCube, this);
+		HeldCube->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, CubeAttachSocketName);
+		HeldCube->SetStateFlag(ECubeStateFlags::Held, true);
+		HeldCube->GetStaticMeshComponent()->SetSimulatePhysics(false);
+		HeldCube->GetStaticMeshComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		UE_LOG(LogTemp, Warning, TEXT("Picked up"));
+	}
 
-	// Draw a debug line from the character's location to the hit point
-	FVector EndPoint = HitResult.TraceEnd;
-	DrawDebugLine(GetWorld(), Start, EndPoint, FColor::Red, false, 1.0f);
+	// Visualize the pickup sphere and the trace from the character's location to the hit point
+	LIQUIDX_DEBUG_SPHERE(GetDebugDrawWorld(), Pickup, Start, Radius, FColor::Green);
+	LIQUIDX_DEBUG_LINE(GetDebugDrawWorld(), Pickup, Start, HitResult.TraceEnd, FColor::Red);
 }
 
 void ALiquidX_Test_SimpleCharacter::ThrowCube()
 {
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_ThrowCube);
+
+	if (!HasAuthority())
+	{
+		ServerThrowCube();
+		return;
+	}
+
 	if (HeldCube)
 	{
 		// Detach and set physics
 		HeldCube->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+		HeldCube->SetStateFlag(ECubeStateFlags::Held, false);
 
 		// Store the reference to the cube being thrown
 		UStaticMeshComponent* CubeMesh = HeldCube->GetStaticMeshComponent();
 		if (CubeMesh)
 		{
-			// Enable physics simulation
-			CubeMesh->SetSimulatePhysics(true);
-			CubeMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-
 			// Calculate throw direction and position
 			FVector ThrowDirection = GetActorForwardVector();
 			FVector ThrowPosition = GetMesh()->GetSocketLocation(CubeAttachSocketName);
 
 			// Move the cube slightly forward to prevent collision with the character
-			HeldCube->SetActorLocation(ThrowPosition + ThrowDirection * 100.0f);
+			HeldCube->SetActorLocation(ThrowPosition + ThrowDirection * Tuning.ThrowSpawnOffset);
+
+			// Simulate until it comes to rest; the settle subsystem then freezes it and queues it for instancing
+			if (UCubeSettleSubsystem* Settle = GetWorld()->GetSubsystem<UCubeSettleSubsystem>())
+			{
+				Settle->AddSimulatingCube(HeldCube);
+			}
+			else
+			{
+				CubeMesh->SetSimulatePhysics(true);
+				CubeMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+			}
 
 			// Apply the throwing force
-			CubeMesh->AddImpulse(ThrowDirection * ThrowForce);
-
-			// Set a timer to disable physics
-			FTimerHandle TimerHandle;
-			GetWorld()->GetTimerManager().SetTimer(TimerHandle, [CubeMesh]()
-				{
-					// Disable physics after 1 seconds
-					CubeMesh->SetSimulatePhysics(false);
-				}, 1.0f, false);
+			CubeMesh->AddImpulse(ThrowDirection * Tuning.ThrowForce);
 
 			HeldCube = nullptr;
+			MARK_PROPERTY_DIRTY_FROM_NAME(ALiquidX_Test_SimpleCharacter, HeldCube, this);
 			UE_LOG(LogTemp, Warning, TEXT("Throw"));
 		}
 	}
@@ -290,35 +554,63 @@ void ALiquidX_Test_SimpleCharacter::ThrowCube()
 /////Interact/////
 void ALiquidX_Test_SimpleCharacter::Interact()
 {
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_Interact);
+
+	if (!HasAuthority())
+	{
+		ServerInteract();
+		return;
+	}
+
 	FVector Start = GetActorLocation();
-	FVector End = Start + GetActorForwardVector() * InteractionRange;
+	FVector End = Start + GetActorForwardVector() * Tuning.InteractionRange;
+
+	int32 NumTraces = 0;
+	AInteractiveActor* InteractiveActor = Cast<AInteractiveActor>(FindVisibleInCone(AInteractiveActor::StaticClass(), Start, NumTraces));
+	LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_InteractQueries, NumTraces);
 
 	FHitResult HitResult;
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(this);
 
-	if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams))
+	if (!InteractiveActor)
 	{
-		AInteractiveActor* InteractiveActor = Cast<AInteractiveActor>(HitResult.GetActor());
-		if (InteractiveActor)
+		LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_InteractQueries, 1);
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams))
 		{
-			InteractiveActor->Interact();
+			InteractiveActor = Cast<AInteractiveActor>(HitResult.GetActor());
 		}
 	}
-	DrawDebugLine(GetWorld(), Start, End, FColor::Red, false, 1.0f);
+
+	if (InteractiveActor)
+	{
+		InteractiveActor->PerformInteract();
+	}
+	LIQUIDX_DEBUG_LINE(GetDebugDrawWorld(), Interact, Start, End, FColor::Red);
 }
 
 /////Damage/////
 void ALiquidX_Test_SimpleCharacter::PunchCube()
 {
+	if (!HasAuthority())
+	{
+		// Play the montage right away for the local player; the server applies the damage
+		if (PunchMontage)
+		{
+			PlayAnimMontage(PunchMontage);
+		}
+		ServerPunchCube();
+		return;
+	}
+
 	if (PunchMontage)
 	{
-		// Play the punch animation montage
-		PlayAnimMontage(PunchMontage);
+		// Play the punch animation montage everywhere the character is relevant
+		MulticastPlayPunchMontage();
 
 		// Schedule the actual punch damage after a short delay
 		FTimerHandle TimerHandle;
-		GetWorldTimerManager().SetTimer(TimerHandle, this, &ALiquidX_Test_SimpleCharacter::PerformPunchDamage, PunchAnimationDelay, false);
+		GetWorldTimerManager().SetTimer(TimerHandle, this, &ALiquidX_Test_SimpleCharacter::PerformPunchDamage, Tuning.PunchAnimationDelay, false);
 	}
 	else
 	{
@@ -329,131 +621,225 @@ void ALiquidX_Test_SimpleCharacter::PunchCube()
 
 void ALiquidX_Test_SimpleCharacter::PerformPunchDamage()
 {
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_PunchDamage);
+
 	FVector Start = GetActorLocation();
-	FVector End = Start + GetActorForwardVector() * InteractionRange;
+	FVector End = Start + GetActorForwardVector() * Tuning.InteractionRange;
+
+	UCubeDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCubeDamageSubsystem>();
+	if (DamageSubsystem && Tuning.bAreaPunch)
+	{
+		// Every loose cube in the cone; the damage pass promotes instanced cubes in the way itself
+		DamageSubsystem->QueueConeDamage(Start, GetActorForwardVector(), Tuning.InteractionRange, Tuning.InteractionConeHalfAngle, Tuning.PunchDamage, Tuning.PunchForce, GetController(), this);
+		LIQUIDX_DEBUG_LINE(GetDebugDrawWorld(), Punch, Start, End, FColor::Red);
+		return;
+	}
 
 	FHitResult HitResult;
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(this);
 
-	if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams))
+	TArray<APickupCube*> PromotedCubes;
+	if (UPickupCubeInstanceSubsystem* Instancing = GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>())
+	{
+		Instancing->PromoteAlongSegment(Start, End, 0.0f, PromotedCubes);
+	}
+	if (UCubeMassSubsystem* CubeMass = GetWorld()->GetSubsystem<UCubeMassSubsystem>())
+	{
+		CubeMass->PromoteAlongSegment(Start, End, 0.0f, PromotedCubes);
+	}
+
+	int32 NumTraces = 0;
+	APickupCube* Cube = Cast<APickupCube>(FindVisibleInCone(APickupCube::StaticClass(), Start, NumTraces));
+	LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_PunchQueries, NumTraces);
+
+	if (!Cube)
 	{
-		APickupCube* Cube = Cast<APickupCube>(HitResult.GetActor());
-		if (Cube)
+		LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_PunchQueries, 1);
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams))
 		{
-			FDamageEvent DamageEvent;
-			Cube->TakeDamage(PunchDamage, DamageEvent, GetController(), this);
-			Cube->GetStaticMeshComponent()->AddImpulse(GetActorForwardVector() * PunchForce);
+			Cube = Cast<APickupCube>(HitResult.GetActor());
 		}
 	}
-	DrawDebugLine(GetWorld(), Start, End, FColor::Red, false, 1.0f);
+
+	if (Cube && DamageSubsystem)
+	{
+		DamageSubsystem->QueueDamage(Cube, Tuning.PunchDamage, GetActorForwardVector() * Tuning.PunchForce, GetController(), this);
+	}
+	else if (Cube)
+	{
+		FDamageEvent DamageEvent;
+		Cube->TakeDamage(Tuning.PunchDamage, DamageEvent, GetController(), this);
+		Cube->GetStaticMeshComponent()->AddImpulse(GetActorForwardVector() * Tuning.PunchForce);
+	}
+	LIQUIDX_DEBUG_LINE(GetDebugDrawWorld(), Punch, Start, End, FColor::Red);
 }
 
-/////Double jump/////
-void ALiquidX_Test_SimpleCharacter::DoubleJump()
+AActor* ALiquidX_Test_SimpleCharacter::FindVisibleInCone(TSubclassOf<AActor> Type, const FVector& Start, int32& OutNumTraces) const
 {
-	if (JumpCount == 0)
+	UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>();
+	if (!InteractionIndex)
 	{
-		Jump();
-		JumpCount++;
+		return nullptr;
 	}
-	else if (JumpCount == 1 && bCanDoubleJump)
+
+	TArray<AActor*> Candidates;
+	InteractionIndex->QueryCone(Start, GetActorForwardVector(), Tuning.InteractionRange, Tuning.InteractionConeHalfAngle, Type, Candidates);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(InteractionVisibility), false, this);
+	if (HeldCube)
 	{
-		LaunchCharacter(FVector(0, 0, DoubleJumpForce), false, true);
-		JumpCount++;
+		QueryParams.AddIgnoredActor(HeldCube);
 	}
+
+	// The nearest candidate can be behind a wall while the next one is in plain sight
+	const int32 NumChecks = FMath::Min(Candidates.Num(), MaxVisibilityChecks);
+	for (int32 Index = 0; Index < NumChecks; ++Index)
+	{
+		AActor* Candidate = Candidates[Index];
+		FHitResult Hit;
+		++OutNumTraces;
+		if (!GetWorld()->LineTraceSingleByChannel(Hit, Start, Candidate->GetActorLocation(), ECC_Visibility, QueryParams) || Hit.GetActor() == Candidate)
+		{
+			return Candidate;
+		}
+	}
+	return nullptr;
+}
+
+/////Networking/////
+void ALiquidX_Test_SimpleCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ALiquidX_Test_SimpleCharacter, HeldCube, Params);
+}
+
+void ALiquidX_Test_SimpleCharacter::ServerPickupCube_Implementation()
+{
+	PickupCube();
 }
 
-void ALiquidX_Test_SimpleCharacter::Landed(const FHitResult& Hit)
+void ALiquidX_Test_SimpleCharacter::ServerThrowCube_Implementation()
 {
-	Super::Landed(Hit);
-	JumpCount = 0;
-	bCanDoubleJump = true;
+	ThrowCube();
+}
+
+void ALiquidX_Test_SimpleCharacter::ServerInteract_Implementation()
+{
+	Interact();
+}
+
+void ALiquidX_Test_SimpleCharacter::ServerPunchCube_Implementation()
+{
+	PunchCube();
+}
+
+void ALiquidX_Test_SimpleCharacter::MulticastPlayPunchMontage_Implementation()
+{
+	// The owning client played it when the input came in
+	if (PunchMontage && (HasAuthority() || !IsLocallyControlled()))
+	{
+		PlayAnimMontage(PunchMontage);
+	}
+}
+
+void ALiquidX_Test_SimpleCharacter::OnRep_HeldCube(APickupCube* PreviousHeldCube)
+{
+	// Attachment and movement replicate with the cube; only the local collision state needs mirroring
+	if (PreviousHeldCube && PreviousHeldCube != HeldCube)
+	{
+		PreviousHeldCube->GetStaticMeshComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		PreviousHeldCube->SetStateFlag(ECubeStateFlags::Held, false);
+	}
+
+	if (HeldCube)
+	{
+		HeldCube->GetStaticMeshComponent()->SetSimulatePhysics(false);
+		HeldCube->GetStaticMeshComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		HeldCube->SetStateFlag(ECubeStateFlags::Held, true);
+	}
+}
+
+/////Double jump/////
+void ALiquidX_Test_SimpleCharacter::DoubleJump()
+{
+	AbilityComponent->TryActivateAbility(UDoubleJumpAbility::StaticClass());
+}
+
+void ALiquidX_Test_SimpleCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	// Becoming airborne is what wakes the wall-run ability up
+	AbilityComponent->RefreshAbilityTicks();
 }
 
 /////Sprint/////
 void ALiquidX_Test_SimpleCharacter::StartSprint()
 {
-	bIsSprinting = true;
-	GetCharacterMovement()->MaxWalkSpeed *= SprintSpeedMultiplier;
+	AbilityComponent->TryActivateAbility(USprintAbility::StaticClass());
 }
 
 void ALiquidX_Test_SimpleCharacter::StopSprint()
 {
-	bIsSprinting = false;
-	GetCharacterMovement()->MaxWalkSpeed = 600.0f;
+	AbilityComponent->DeactivateAbility(USprintAbility::StaticClass());
 }
 
 
 /////Wall run/////
 void ALiquidX_Test_SimpleCharacter::CheckWallRun()
 {
-	if (!GetCharacterMovement()->IsFalling())
+	LIQUIDX_SCOPE_CYCLE_COUNTER(STAT_LiquidX_WallRunCheck);
+
+	ULiquidXCharacterMovementComponent* Movement = GetLiquidXMovement();
+	if (Movement->IsWallRunning())
+	{
+		// Once running, the movement component keeps confirming the wall itself
+		return;
+	}
+
+	if (!Movement->IsFalling())
 	{
-		StopWallRun();
+		Movement->SetWallRunHint(false, FVector::ZeroVector);
 		return;
 	}
 
 	FVector Start = GetActorLocation();
 	FVector Right = GetActorRightVector();
-	FVector ForwardOffset = GetActorForwardVector() * 50.0f;
+	FVector ForwardOffset = GetActorForwardVector() * Tuning.WallRunForwardOffset;
 
-	TArray<FVector> Directions = { Right, -Right };
+	const FVector Directions[] = { Right, -Right };
 
 	for (const FVector& Direction : Directions)
 	{
-		FVector End = Start + Direction * WallCheckDistance + ForwardOffset;
+		FVector End = Start + Direction * Tuning.WallCheckDistance + ForwardOffset;
 		FHitResult HitResult;
 		FCollisionQueryParams QueryParams;
 		QueryParams.AddIgnoredActor(this);
 
-		if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams))
+		LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_WallRunQueries, 1);
+		const bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams);
+		LIQUIDX_DEBUG_LINE(GetDebugDrawWorld(), WallRun, Start, End, bHit ? FColor::Green : FColor::Red);
+		if (bHit)
 		{
-			StartWallRun();
-			WallNormal = HitResult.Normal;
+			// The movement component picks the hint up in its next update and confirms the wall itself
+			Movement->SetWallRunHint(true, HitResult.Normal);
 			return;
 		}
 	}
 
-	StopWallRun();
+	Movement->SetWallRunHint(false, FVector::ZeroVector);
 }
 
 void ALiquidX_Test_SimpleCharacter::StartWallRun()
 {
-	if (!bIsWallRunning)
-	{
-		bIsWallRunning = true;
-		GetCharacterMovement()->SetMovementMode(MOVE_Flying);
-		WallRunTimer = 0.0f;
-	}
+	GetLiquidXMovement()->TryStartWallRun();
 }
 
 void ALiquidX_Test_SimpleCharacter::StopWallRun()
 {
-	if (bIsWallRunning)
-	{
-		bIsWallRunning = false;
-		GetCharacterMovement()->SetMovementMode(MOVE_Falling);
-	}
+	GetLiquidXMovement()->StopWallRun();
 }
-
-void ALiquidX_Test_SimpleCharacter::UpdateWallRun(float DeltaTime)
-{
-	if (bIsWallRunning)
-	{
-		WallRunTimer += DeltaTime;
-		if (WallRunTimer >= WallRunDuration)
-		{
-			StopWallRun();
-			return;
-		}
-
-		FVector WallRunDirection = FVector::CrossProduct(WallNormal, FVector::UpVector);
-		if (FVector::DotProduct(WallRunDirection, GetActorForwardVector()) < 0)
-		{
-			WallRunDirection = -WallRunDirection;
-		}
-
-		GetCharacterMovement()->Velocity = WallRunDirection * WallRunSpeed;
-	}
-}
\ No newline at end of file
@@ -5,16 +5,26 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "CharacterTuningData.h"
+#include "HUDNotifyFilter.h"
 #include "LiquidX_Test_SimpleCharacter.generated.h"
 
 class USpringArmComponent;
 class UCameraComponent;
 class UInputMappingContext;
 class UInputAction;
+class UCharacterAbilityComponent;
+class UInteractionFocusComponent;
+class ULiquidXCharacterMovementComponent;
+class UJetpackBarDriver;
 struct FInputActionValue;
+struct FInputActionInstance;
+enum class ERecordedInput : uint8;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnJetpackFuelChanged, float, Fuel, float, MaxFuel);
+
 UCLASS(config=Game)
 class ALiquidX_Test_SimpleCharacter : public ACharacter
 {
@@ -64,10 +74,26 @@ class ALiquidX_Test_SimpleCharacter : public ACharacter
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* SprintAction;
 
-public:
-	ALiquidX_Test_SimpleCharacter();
+	/** Runs jetpack, wall-run, double jump and sprint */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Ability, meta = (AllowPrivateAccess = "true"))
+	UCharacterAbilityComponent* AbilityComponent;
+
+	/** Tracks the interactable an interaction prompt should point at */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Interaction, meta = (AllowPrivateAccess = "true"))
+	UInteractionFocusComponent* FocusComponent;
+
+	// Abilities drive the movement state below
+	friend class UJetpackAbility;
+	friend class UWallRunAbility;
+	friend class UDoubleJumpAbility;
+	friend class USprintAbility;
 
-	virtual void Tick(float DeltaTime) override;
+	// Movement simulation saves/restores the jetpack fuel
+	friend class ULiquidXCharacterMovementComponent;
+	friend class FSavedMove_LiquidX;
+
+public:
+	ALiquidX_Test_SimpleCharacter(const FObjectInitializer& ObjectInitializer);
 
 	// Jetpack functions
 	UFUNCTION(BlueprintCallable, Category = "Jetpack")
@@ -76,6 +102,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Jetpack")
 	void DeactivateJetpack();
 
+	UFUNCTION(BlueprintPure, Category = "Jetpack")
+	float GetJetpackFuel() const { return JetpackFuel; }
+
+	/** Set the fuel, clamped to the tank, and fire OnJetpackFuelChanged when the change is big enough to show */
+	UFUNCTION(BlueprintCallable, Category = "Jetpack")
+	void SetJetpackFuel(float NewFuel);
+
+	/**
+	 * Fires when the fuel has moved FuelNotifyStep of the tank since the last notification, or runs
+	 * empty or full. HUD widgets update on this instead of reading JetpackFuel every frame.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Jetpack")
+	FOnJetpackFuelChanged OnJetpackFuelChanged;
+
 	// Cube interaction functions
 	UFUNCTION(BlueprintCallable, Category = "Interaction")
 	void PickupCube();
@@ -110,6 +150,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void StopWallRun();
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Run the handler bound to an input event, with the axis value for Move and Look. Input replays drive the character through this. */
+	void HandleInput(ERecordedInput Input, const FVector2D& Value);
+
 protected:
 
 	/** Called for movement input */
@@ -117,6 +162,9 @@ protected:
 
 	/** Called for looking input */
 	void Look(const FInputActionValue& Value);
+
+	/** Every input binding lands here; hands the event to an active input recording, then to HandleInput */
+	void OnInputAction(const FInputActionInstance& Instance, ERecordedInput Input);
 			
 
 protected:
@@ -126,91 +174,161 @@ protected:
 	// To add mapping context
 	virtual void BeginPlay();
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+	/** Returns AbilityComponent subobject **/
+	FORCEINLINE UCharacterAbilityComponent* GetAbilityComponent() const { return AbilityComponent; }
+	/** Returns FocusComponent subobject **/
+	FORCEINLINE UInteractionFocusComponent* GetFocusComponent() const { return FocusComponent; }
+	/** Returns the cube currently held, if any **/
+	FORCEINLINE class APickupCube* GetHeldCube() const { return HeldCube; }
+	/** Returns the character movement component as its native LiquidX type **/
+	ULiquidXCharacterMovementComponent* GetLiquidXMovement() const;
+	/** Returns the tuning in effect, copied from TuningData or DefaultTuning **/
+	FORCEINLINE const FCharacterTuning& GetTuning() const { return Tuning; }
+
+	/** Whether this character's debug traces are drawn; cleared by UCharacterSignificanceSubsystem for insignificant characters */
+	void SetDebugDrawSignificant(bool bSignificant) { bDebugDrawSignificant = bSignificant; }
+
+	/** World to pass to the LIQUIDX_DEBUG_* macros: null, so nothing is drawn, while the character isn't significant enough */
+	FORCEINLINE UWorld* GetDebugDrawWorld() const { return bDebugDrawSignificant ? GetWorld() : nullptr; }
+
+	/** Switch to another tuning asset, or DefaultTuning for null, and apply it right away */
+	UFUNCTION(BlueprintCallable, Category = "Tuning")
+	void SetTuningData(UCharacterTuningData* NewTuningData);
+
+	virtual void PostInitializeComponents() override;
+	virtual void PostLoad() override;
+	virtual void NotifyControllerChanged() override;
 
 private:
-	UFUNCTION()
-	virtual void Landed(const FHitResult& Hit) override;
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
 
-	// Jetpack properties
-	UPROPERTY(EditAnywhere, Category = "Jetpack")
-	float JetpackForce = 1000.0f;
+	/** Movement and ability tuning of this archetype; DefaultTuning is used when unset */
+	UPROPERTY(EditAnywhere, Category = "Tuning")
+	TObjectPtr<UCharacterTuningData> TuningData;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jetpack", meta = (AllowPrivateAccess = "true"))
-	float JetpackFuel = 100.0f;
+	/** Tuning used while TuningData is unset. Archetypes saved before the tuning assets get their old overrides here on load. */
+	UPROPERTY(EditAnywhere, Category = "Tuning", meta = (EditCondition = "TuningData == nullptr"))
+	FCharacterTuning DefaultTuning;
 
-	UPROPERTY(EditAnywhere, Category = "Jetpack")
-	float JetpackFuelConsumptionRate = 10.0f;
+	/** Flat copy of the tuning in effect. Everything reads this; it is only rewritten by ApplyTuning. */
+	UPROPERTY(VisibleInstanceOnly, Transient, Category = "Tuning")
+	FCharacterTuning Tuning;
 
-	UPROPERTY(EditAnywhere, Category = "Jetpack")
-	float JetpackFuelRefillRate = 5.0f;
+	/** Copy the tuning from TuningData (or the -LiquidXTuning override) and push it to the components that mirror it */
+	void ApplyTuning();
 
-	bool bJetpackActive = false;
+	/** Push the movement values in Tuning to the movement component */
+	void ApplyMovementTuning();
 
-	// Cube interaction properties
-	UPROPERTY(EditAnywhere, Category = "Interaction")
-	float PickupRange = 200.0f;
+#if WITH_EDITORONLY_DATA
+	// Tuning properties from before FCharacterTuning, redirected here by [CoreRedirects] in DefaultEngine.ini.
+	// PostLoad moves any value an archetype changed into DefaultTuning; they are not saved again.
+	UPROPERTY()
+	float JetpackForce_DEPRECATED = 1000.0f;
+	UPROPERTY()
+	float JetpackFuelConsumptionRate_DEPRECATED = 10.0f;
+	UPROPERTY()
+	float JetpackFuelRefillRate_DEPRECATED = 5.0f;
+	UPROPERTY()
+	float ThrowForce_DEPRECATED = 1000.0f;
+	UPROPERTY()
+	float InteractionRange_DEPRECATED = 200.0f;
+	UPROPERTY()
+	float InteractionConeHalfAngle_DEPRECATED = 30.0f;
+	UPROPERTY()
+	float PunchForce_DEPRECATED = 500.0f;
+	UPROPERTY()
+	float PunchDamage_DEPRECATED = 10.0f;
+	UPROPERTY()
+	bool bAreaPunch_DEPRECATED = false;
+	UPROPERTY()
+	float DoubleJumpForce_DEPRECATED = 700.0f;
+	UPROPERTY()
+	float PunchAnimationDelay_DEPRECATED = 0.2f;
+	UPROPERTY()
+	float SprintSpeedMultiplier_DEPRECATED = 1.5f;
+	UPROPERTY()
+	float WallRunSpeed_DEPRECATED = 800.0f;
+	UPROPERTY()
+	float WallRunDuration_DEPRECATED = 2.0f;
+	UPROPERTY()
+	float WallCheckDistance_DEPRECATED = 60.0f;
+	UPROPERTY()
+	float WallRunForwardOffset_DEPRECATED = 50.0f;
+#endif
 
-	UPROPERTY(EditAnywhere, Category = "Interaction")
-	float ThrowForce = 1000.0f;
+	bool bDebugDrawSignificant = true;
 
-	UPROPERTY(EditAnywhere, Category = "Interaction")
-	FName CubeAttachSocketName = "hand_r";
+#if WITH_EDITOR
+	void HandleTuningChanged(const UCharacterTuningData* ChangedData);
+	FDelegateHandle TuningChangedHandle;
+#endif
 
-	UPROPERTY()
-	class APickupCube* HeldCube;
+	/** Current jetpack fuel, starts at Tuning.MaxJetpackFuel. Written through SetJetpackFuel so the HUD hears about it. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Jetpack", meta = (AllowPrivateAccess = "true"))
+	float JetpackFuel = 100.0f;
 
-	// Damage properties
-	UPROPERTY(EditAnywhere, Category = "Interaction")
-	float InteractionRange = 200.0f;
+	/** Fraction of the tank the fuel has to move before OnJetpackFuelChanged fires again */
+	UPROPERTY(EditAnywhere, Category = "Jetpack", meta = (ClampMin = "0", ClampMax = "1"))
+	float FuelNotifyStep = 0.01f;
 
-	UPROPERTY(EditAnywhere, Category = "Interaction")
-	float PunchForce = 500.0f;
+	FHUDNotifyFilter FuelNotifyFilter;
 
-	UPROPERTY(EditAnywhere, Category = "Interaction")
-	float PunchDamage = 10.0f;
+	/** Sets the player's W_JetpackBar from OnJetpackFuelChanged instead of its per-frame Percent binding */
+	UPROPERTY(Transient)
+	TObjectPtr<UJetpackBarDriver> JetpackBarDriver;
 
-	//Double Jump Properties
-	UPROPERTY(EditAnywhere, Category = "Movement")
-	float DoubleJumpForce = 700.0f;
+	/** Take over the local player's jetpack bars, once the HUD they live in has been built */
+	void BindJetpackBars();
 
-	bool bCanDoubleJump = false;
-	int32 JumpCount = 0;
+	// Cube interaction properties
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	FName CubeAttachSocketName = "hand_r";
 
-	void UpdateJetpack(float DeltaTime);
+	UPROPERTY(ReplicatedUsing = OnRep_HeldCube)
+	class APickupCube* HeldCube;
 
-	UPROPERTY(EditAnywhere, Category = "Animation")
-	class UAnimMontage* PunchMontage;
+	UFUNCTION()
+	void OnRep_HeldCube(APickupCube* PreviousHeldCube);
 
-	UPROPERTY(EditAnywhere, Category = "Animation")
-	float PunchAnimationDelay = 0.2f; 
+	// Cube and interaction input runs on the server; clients forward it here
+	UFUNCTION(Server, Reliable)
+	void ServerPickupCube();
 
-	void PerformPunchDamage();
+	UFUNCTION(Server, Reliable)
+	void ServerThrowCube();
 
-	// Sprint properties
-	UPROPERTY(EditAnywhere, Category = "Movement")
-	float SprintSpeedMultiplier = 1.5f;
+	UFUNCTION(Server, Reliable)
+	void ServerInteract();
 
-	bool bIsSprinting = false;
+	UFUNCTION(Server, Reliable)
+	void ServerPunchCube();
 
-	// Wall run properties
-	UPROPERTY(EditAnywhere, Category = "Movement")
-	float WallRunSpeed = 800.0f;
+	/** Plays PunchMontage on the server and on simulated proxies, so other players see the punch */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastPlayPunchMontage();
 
-	UPROPERTY(EditAnywhere, Category = "Movement")
-	float WallRunDuration = 2.0f;
+	UPROPERTY(EditAnywhere, Category = "Animation")
+	class UAnimMontage* PunchMontage;
 
-	UPROPERTY(EditAnywhere, Category = "Movement")
-	float WallCheckDistance = 60.0f;
+	void PerformPunchDamage();
 
-	bool bIsWallRunning = false;
-	FVector WallNormal;
-	float WallRunTimer = 0.0f;
+	/**
+	 * Nearest interactable of Type in the interaction cone that Start can see. The interaction index
+	 * supplies the candidates, nearest first; each is confirmed with a visibility trace, up to
+	 * MaxVisibilityChecks of them, so nothing is reached through a wall. Adds the traces to OutNumTraces.
+	 */
+	AActor* FindVisibleInCone(TSubclassOf<AActor> Type, const FVector& Start, int32& OutNumTraces) const;
 
-	void UpdateWallRun(float DeltaTime);
+	/** Most index candidates an interact or punch confirms with a trace before giving up */
+	UPROPERTY(EditAnywhere, Category = "Interaction", meta = (ClampMin = "1"))
+	int32 MaxVisibilityChecks = 4;
 };
 
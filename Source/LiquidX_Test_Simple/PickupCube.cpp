@@ -2,12 +2,23 @@
 
 
 #include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "PickupCubeInstanceSubsystem.h"
+#include "InteractionIndexSubsystem.h"
+#include "CubeDamageSubsystem.h"
+#include "CubeHealthBarSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 // Sets default values
 APickupCube::APickupCube()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+    // Tick is opt-in through TickPolicySettings; see UTickPolicySubsystem
     PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
 
     MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComponent"));
     RootComponent = MeshComponent;
@@ -15,32 +26,339 @@ APickupCube::APickupCube()
     MeshComponent->SetSimulatePhysics(false);
     MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
 
+    // Server authoritative; idle cubes stay dormant and don't cost relevancy or property checks
+    bReplicates = true;
+    SetReplicatingMovement(true);
+    NetDormancy = DORM_Initial;
+    NetUpdateFrequency = 10.0f;
+    MinNetUpdateFrequency = 2.0f;
 }
 
 // Called when the game starts or when spawned
 void APickupCube::BeginPlay()
 {
 	Super::BeginPlay();
-    CurrentHealth = MaxHealth;
+
+    if (HasAuthority())
+    {
+        CurrentHealth = MaxHealth;
+        MARK_PROPERTY_DIRTY_FROM_NAME(APickupCube, CurrentHealth, this);
+
+        // DORM_Initial only applies to level-placed actors; spawned cubes replicate once and then sleep
+        if (NetDormancy == DORM_Initial && !IsNetStartupActor())
+        {
+            SetNetDormancy(DORM_DormantAll);
+        }
+    }
+
+    // Clients register with whatever health arrived in the initial bunch
+    CubeState = GetWorld()->GetSubsystem<UCubeStateSubsystem>();
+    if (CubeState)
+    {
+        StateHandle = CubeState->RegisterCube(this, CurrentHealth, MaxHealth);
+        SetStateFlag(ECubeStateFlags::InPool, bInPool);
+    }
+
+    if (UCubeHealthBarSubsystem* HealthBars = GetWorld()->GetSubsystem<UCubeHealthBarSubsystem>())
+    {
+        HealthBars->RegisterCube(this);
+    }
+
+    if (UTickPolicySubsystem* TickPolicy = GetWorld()->GetSubsystem<UTickPolicySubsystem>())
+    {
+        TickPolicy->RegisterActor(this, GetEffectiveTickPolicy(), MeshComponent);
+    }
+
+    if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+    {
+        InteractionIndex->RegisterInteractable(this);
+    }
+
+    if (UPickupCubeInstanceSubsystem* Instancing = GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>())
+    {
+        Instancing->QueueDemotion(this, Instancing->IdleDelay);
+    }
 }
 
-// Called every frame
-void APickupCube::Tick(float DeltaTime)
+void APickupCube::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+    if (UTickPolicySubsystem* TickPolicy = GetWorld()->GetSubsystem<UTickPolicySubsystem>())
+    {
+        TickPolicy->UnregisterActor(this);
+    }
+
+    if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+    {
+        InteractionIndex->UnregisterInteractable(this);
+    }
+
+    if (UCubeHealthBarSubsystem* HealthBars = GetWorld()->GetSubsystem<UCubeHealthBarSubsystem>())
+    {
+        HealthBars->UnregisterCube(this);
+    }
 
+    if (CubeState)
+    {
+        CubeState->UnregisterCube(StateHandle);
+        CubeState = nullptr;
+        StateHandle = FCubeHandle();
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void APickupCube::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    // Push based: these only get compared when marked dirty, not on every replication pass
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(APickupCube, MaxHealth, Params);
+    DOREPLIFETIME_WITH_PARAMS_FAST(APickupCube, CurrentHealth, Params);
+    DOREPLIFETIME_WITH_PARAMS_FAST(APickupCube, bInPool, Params);
 }
 
 float APickupCube::TakeDamage(float Damage, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
+    if (!HasAuthority())
+    {
+        return 0.0f;
+    }
+
     float DamageApplied = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
-    CurrentHealth = FMath::Max(0.0f, CurrentHealth - DamageApplied);
+    SetCurrentHealth(GetHealth() - DamageApplied);
 
-    if (CurrentHealth <= 0)
+    if (GetHealth() <= 0)
     {
-        Destroy();
+        // Recycle at the end of the frame so anything else reacting to this hit still sees the cube
+        if (UCubeDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCubeDamageSubsystem>())
+        {
+            DamageSubsystem->QueueRelease(this);
+        }
+        else if (UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>())
+        {
+            CubePool->ReleaseCube(this);
+        }
+        else
+        {
+            Destroy();
+        }
     }
 
     return DamageApplied;
 }
 
+void APickupCube::ActivateFromPool(const FTransform& Transform)
+{
+    FlushNetDormancy();
+
+    bInPool = false;
+    MARK_PROPERTY_DIRTY_FROM_NAME(APickupCube, bInPool, this);
+    SetHealthValues(GetMaxHealth(), GetMaxHealth());
+    BroadcastHealthChanged();
+
+    SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+    ApplyPoolState();
+
+    if (UPickupCubeInstanceSubsystem* Instancing = GetWorld()->GetSubsystem<UPickupCubeInstanceSubsystem>())
+    {
+        Instancing->QueueDemotion(this, Instancing->IdleDelay);
+    }
+}
+
+void APickupCube::ReturnToPool()
+{
+    FlushNetDormancy();
+
+    bInPool = true;
+    MARK_PROPERTY_DIRTY_FROM_NAME(APickupCube, bInPool, this);
+
+    DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+    ApplyPoolState();
+    SetNetActive(false);
+}
+
+void APickupCube::ApplyPoolState()
+{
+    SetStateFlag(ECubeStateFlags::InPool, bInPool);
+
+    if (bInPool)
+    {
+        SetStateFlag(ECubeStateFlags::Held | ECubeStateFlags::Simulating | ECubeStateFlags::HealthEffects, false);
+
+        if (UTickPolicySubsystem* TickPolicy = GetWorld()->GetSubsystem<UTickPolicySubsystem>())
+        {
+            TickPolicy->UnregisterActor(this);
+        }
+
+        if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+        {
+            InteractionIndex->UnregisterInteractable(this);
+        }
+
+        MeshComponent->SetSimulatePhysics(false);
+        MeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+        SetActorEnableCollision(false);
+        SetActorHiddenInGame(true);
+    }
+    else
+    {
+        SetActorHiddenInGame(false);
+        SetActorEnableCollision(true);
+        MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+        if (UTickPolicySubsystem* TickPolicy = GetWorld()->GetSubsystem<UTickPolicySubsystem>())
+        {
+            TickPolicy->RegisterActor(this, GetEffectiveTickPolicy(), MeshComponent);
+        }
+
+        if (UInteractionIndexSubsystem* InteractionIndex = GetWorld()->GetSubsystem<UInteractionIndexSubsystem>())
+        {
+            InteractionIndex->RegisterInteractable(this);
+        }
+    }
+}
+
+FActorTickPolicySettings APickupCube::GetEffectiveTickPolicy() const
+{
+    FActorTickPolicySettings Settings = TickPolicySettings;
+    if (Settings.Policy == EActorTickPolicy::Auto && !Settings.bNativeTick && !bAllowBlueprintTick)
+    {
+        Settings.Policy = EActorTickPolicy::Never;
+    }
+    return Settings;
+}
+
+void APickupCube::SetNetActive(bool bActive)
+{
+    if (HasAuthority() && GetNetMode() != NM_Standalone)
+    {
+        SetNetDormancy(bActive ? DORM_Awake : DORM_DormantAll);
+    }
+}
+
+float APickupCube::GetHealth() const
+{
+    return CubeState ? CubeState->GetHealth(StateHandle) : CurrentHealth;
+}
+
+float APickupCube::GetMaxHealth() const
+{
+    return CubeState ? CubeState->GetMaxHealth(StateHandle) : MaxHealth;
+}
+
+void APickupCube::SetStateFlag(ECubeStateFlags Flag, bool bSet)
+{
+    if (CubeState)
+    {
+        CubeState->SetFlag(StateHandle, Flag, bSet);
+    }
+}
+
+bool APickupCube::HasStateFlag(ECubeStateFlags Flag) const
+{
+    return CubeState && CubeState->HasFlag(StateHandle, Flag);
+}
+
+void APickupCube::SetHealthValues(float InHealth, float InMaxHealth)
+{
+    if (CubeState)
+    {
+        CubeState->SetMaxHealth(StateHandle, InMaxHealth);
+        CubeState->SetHealth(StateHandle, InHealth);
+    }
+    else
+    {
+        MaxHealth = InMaxHealth;
+        CurrentHealth = InHealth;
+    }
+
+    if (HasAuthority())
+    {
+        UpdateReplicatedHealth();
+    }
+}
+
+void APickupCube::UpdateReplicatedHealth()
+{
+    // Derived from the store; only marked dirty when the value clients have is out of date
+    const float StoredMaxHealth = GetMaxHealth();
+    if (MaxHealth != StoredMaxHealth)
+    {
+        MaxHealth = StoredMaxHealth;
+        MARK_PROPERTY_DIRTY_FROM_NAME(APickupCube, MaxHealth, this);
+    }
+
+    const float StoredHealth = GetHealth();
+    if (CurrentHealth != StoredHealth)
+    {
+        CurrentHealth = StoredHealth;
+        MARK_PROPERTY_DIRTY_FROM_NAME(APickupCube, CurrentHealth, this);
+    }
+}
+
+void APickupCube::OnRep_MaxHealth()
+{
+    if (CubeState)
+    {
+        CubeState->SetMaxHealth(StateHandle, MaxHealth);
+    }
+
+    // The fill fraction moved even if health didn't
+    BroadcastHealthChanged();
+}
+
+void APickupCube::OnRep_CurrentHealth()
+{
+    if (CubeState)
+    {
+        CubeState->SetHealth(StateHandle, CurrentHealth);
+    }
+    BroadcastHealthChanged();
+}
+
+void APickupCube::BroadcastHealthChanged()
+{
+    OnHealthChanged.Broadcast(this, GetHealth());
+}
+
+void APickupCube::OnRep_InPool()
+{
+    ApplyPoolState();
+}
+
+void APickupCube::SetHealthState(float InCurrentHealth, float InMaxHealth)
+{
+    SetHealthValues(FMath::Clamp(InCurrentHealth, 0.0f, InMaxHealth), InMaxHealth);
+    BroadcastHealthChanged();
+}
+
+void APickupCube::SetCurrentHealth(float NewHealth)
+{
+    if (!HasAuthority())
+    {
+        return;
+    }
+
+    // Dormant cubes need a flush for the new health to reach clients
+    FlushNetDormancy();
+    SetHealthValues(FMath::Clamp(NewHealth, 0.0f, GetMaxHealth()), GetMaxHealth());
+    BroadcastHealthChanged();
+}
+
+void APickupCube::NotifyDamageTaken(float Damage, AController* EventInstigator, AActor* DamageCauser)
+{
+    const UDamageType* DamageType = GetDefault<UDamageType>();
+    ReceiveAnyDamage(Damage, DamageType, EventInstigator, DamageCauser);
+    OnTakeAnyDamage.Broadcast(this, Damage, DamageType, EventInstigator, DamageCauser);
+    if (EventInstigator)
+    {
+        EventInstigator->InstigatedAnyDamage(Damage, DamageType, this, DamageCauser);
+    }
+}
+
+bool APickupCube::IsAtRest(float SpeedThreshold) const
+{
+    return !MeshComponent->IsSimulatingPhysics() && GetVelocity().SizeSquared() <= FMath::Square(SpeedThreshold);
+}
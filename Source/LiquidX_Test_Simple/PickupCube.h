@@ -4,8 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TickPolicySubsystem.h"
+#include "CubeStateSubsystem.h"
 #include "PickupCube.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCubeHealthChanged, APickupCube*, Cube, float, NewHealth);
+
+/**
+ * Replicated, server-authoritative pickup cube. Idle cubes are net-dormant and only replicate
+ * when something happens to them (damage, pickup, throw, leaving or entering the pool).
+ * Health and held/simulating/pooled state live in UCubeStateSubsystem, which is the source of truth.
+ * The actor reads and writes through its handle; on the server the replicated health properties are
+ * derived from the store, and on clients their OnReps write into it.
+ */
 UCLASS()
 class LIQUIDX_TEST_SIMPLE_API APickupCube : public AActor
 {
@@ -15,31 +26,121 @@ public:
 	// Sets default values for this actor's properties
 	APickupCube();
 
-	virtual void Tick(float DeltaTime) override;
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	UFUNCTION(BlueprintCallable, Category = "Pickup")
 	UStaticMeshComponent* GetStaticMeshComponent() const { return MeshComponent; }
 
 	UFUNCTION(BlueprintPure, Category = "Health")
-	float GetHealth() const { return CurrentHealth; }
+	float GetHealth() const;
 
 	UFUNCTION(BlueprintPure, Category = "Health")
-	float GetMaxHealth() const { return MaxHealth; }
+	float GetMaxHealth() const;
+
+	// Pooling, driven by UPickupCubePoolSubsystem
+	void ActivateFromPool(const FTransform& Transform);
+	void ReturnToPool();
+
+	UFUNCTION(BlueprintPure, Category = "Pickup")
+	bool IsInPool() const { return bInPool; }
+
+	/** Restores health carried by an instanced cube when it is turned back into an actor */
+	void SetHealthState(float InCurrentHealth, float InMaxHealth);
+
+	/** Server only: set health, wake the cube so it replicates and broadcast OnHealthChanged */
+	void SetCurrentHealth(float NewHealth);
+
+	/**
+	 * Fire what TakeDamage fires for a hit: ReceiveAnyDamage, OnTakeAnyDamage and the instigator's
+	 * InstigatedAnyDamage. The batched damage pass calls this per event once health is written back.
+	 */
+	void NotifyDamageTaken(float Damage, AController* EventInstigator, AActor* DamageCauser);
+
+	UFUNCTION(BlueprintPure, Category = "Pickup")
+	bool IsHeld() const { return GetAttachParentActor() != nullptr; }
 
+	/** True when the cube is not simulating and not moving faster than SpeedThreshold */
+	bool IsAtRest(float SpeedThreshold) const;
+
+	bool CanBeInstanced() const { return bAllowInstancing; }
+
+	FCubeHandle GetStateHandle() const { return StateHandle; }
+
+	/** Set or clear a flag in this cube's entry in the state store */
+	void SetStateFlag(ECubeStateFlags Flag, bool bSet);
+	bool HasStateFlag(ECubeStateFlags Flag) const;
+
+	/** Server only: keep the cube awake for replication while it is handled, or let it go dormant once idle */
+	void SetNetActive(bool bActive);
+
+	/** Fires on the server and on every client when CurrentHealth changes, including pool reuse and promotion */
+	UPROPERTY(BlueprintAssignable, Category = "Health")
+	FOnCubeHealthChanged OnHealthChanged;
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Cubes don't tick unless a Blueprint implements Event Tick or the policy asks for it */
+	UPROPERTY(EditAnywhere, Category = "Tick")
+	FActorTickPolicySettings TickPolicySettings;
+
+	/**
+	 * Let an Auto policy tick the cube for a Blueprint Event Tick. Off by default: B_PickupCube's
+	 * Event Tick only polled GetHealth/GetMaxHealth for W_CubeHP, which the health bar subsystem
+	 * replaces. Turn on for a Blueprint whose tick does other work.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Tick")
+	bool bAllowBlueprintTick = false;
 
 private:
 	UPROPERTY(VisibleAnywhere, Category = "Components")
 	UStaticMeshComponent* MeshComponent;
 
-	UPROPERTY(EditAnywhere, Category = "Health")
+	/** Starting max health; after BeginPlay the network copy of the stored value */
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_MaxHealth, Category = "Health")
 	float MaxHealth = 100.0f;
 
-	UPROPERTY(VisibleAnywhere, Category = "Health")
+	/** Network copy of the stored health; read it through GetHealth */
+	UPROPERTY(VisibleAnywhere, ReplicatedUsing = OnRep_CurrentHealth, Category = "Health")
 	float CurrentHealth;
 
+	/** Let UPickupCubeInstanceSubsystem replace this cube with a mesh instance while it is idle */
+	UPROPERTY(EditAnywhere, Category = "Pickup")
+	bool bAllowInstancing = true;
+
+	UPROPERTY(ReplicatedUsing = OnRep_InPool)
+	bool bInPool = false;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UCubeStateSubsystem> CubeState;
+
+	FCubeHandle StateHandle;
+
+	UFUNCTION()
+	void OnRep_MaxHealth();
+
+	UFUNCTION()
+	void OnRep_CurrentHealth();
+
+	UFUNCTION()
+	void OnRep_InPool();
+
+	/** Apply the local side of bInPool: visibility, collision and subsystem registration */
+	void ApplyPoolState();
+
+	/** Write health to the state store, or to the properties before the cube has registered, then replicate it */
+	void SetHealthValues(float InHealth, float InMaxHealth);
+
+	/** Server only: copy the stored health into the replicated properties and mark the changed ones dirty */
+	void UpdateReplicatedHealth();
+
+	/** TickPolicySettings, with Auto turned to Never when only a disallowed Blueprint tick would run */
+	FActorTickPolicySettings GetEffectiveTickPolicy() const;
+
+	/** Fire OnHealthChanged with the stored health */
+	void BroadcastHealthChanged();
+
 };
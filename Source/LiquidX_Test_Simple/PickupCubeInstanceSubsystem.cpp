@@ -0,0 +1,301 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupCubeInstanceSubsystem.h"
+#include "PickupCube.h"
+#include "PickupCubePoolSubsystem.h"
+#include "CubeMassSubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+void UPickupCubeInstanceSubsystem::Deinitialize()
+{
+	PendingDemotions.Empty();
+	PendingContactPromotions.Empty();
+	Batches.Empty();
+	HostActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+TStatId UPickupCubeInstanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupCubeInstanceSubsystem, STATGROUP_Tickables);
+}
+
+void UPickupCubeInstanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingContactPromotions.Num() > 0)
+	{
+		TArray<APickupCube*> Promoted;
+		for (const FVector& ContactPoint : PendingContactPromotions)
+		{
+			PromoteInRadius(ContactPoint, 1.0f, Promoted);
+		}
+		PendingContactPromotions.Reset();
+	}
+
+	if (PendingDemotions.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	int32 NumDemoted = 0;
+	for (auto It = PendingDemotions.CreateIterator(); It && NumDemoted < MaxDemotionsPerFrame; ++It)
+	{
+		APickupCube* Cube = It->Key.Get();
+
+		// Held cubes are re-queued by the character when they are thrown
+		if (!Cube || Cube->IsInPool() || Cube->IsHeld())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (Now < It->Value)
+		{
+			continue;
+		}
+
+		// Health effects end with the actor, so affected cubes wait for them to finish
+		if (!Cube->IsAtRest(RestSpeedThreshold) || Cube->HasStateFlag(ECubeStateFlags::HealthEffects))
+		{
+			It->Value = Now + IdleDelay;
+			continue;
+		}
+
+		It.RemoveCurrent();
+		if (DemoteCube(Cube))
+		{
+			NumDemoted++;
+		}
+	}
+}
+
+void UPickupCubeInstanceSubsystem::QueueDemotion(APickupCube* Cube, float Delay)
+{
+	if (Cube && Cube->CanBeInstanced())
+	{
+		PendingDemotions.Add(Cube, GetWorld()->GetTimeSeconds() + Delay);
+	}
+}
+
+bool UPickupCubeInstanceSubsystem::DemoteCube(APickupCube* Cube)
+{
+	if (!IsValid(Cube) || Cube->IsInPool() || !Cube->CanBeInstanced() || Cube->IsHeld() || !Cube->IsAtRest(RestSpeedThreshold))
+	{
+		return false;
+	}
+
+	if (Cube->HasStateFlag(ECubeStateFlags::HealthEffects))
+	{
+		return false;
+	}
+
+	// Instances only exist on the machine that made them; networked cubes go dormant instead
+	if (Cube->GetNetMode() != NM_Standalone)
+	{
+		return false;
+	}
+
+	// Debris-field mode keeps resting cubes as Mass entities instead of instances
+	UCubeMassSubsystem* CubeMass = GetWorld()->GetSubsystem<UCubeMassSubsystem>();
+	if (CubeMass && CubeMass->ShouldDemoteToMass())
+	{
+		PendingDemotions.Remove(Cube);
+		return CubeMass->DemoteCube(Cube);
+	}
+
+	FCubeInstanceBatch& Batch = FindOrCreateBatch(Cube->GetClass());
+	if (!Batch.Component)
+	{
+		return false;
+	}
+
+	FCubeInstanceData& Data = Batch.Instances.AddDefaulted_GetRef();
+	Data.CurrentHealth = Cube->GetHealth();
+	Data.MaxHealth = Cube->GetMaxHealth();
+	Batch.Component->AddInstance(Cube->GetActorTransform(), /*bWorldSpace*/ true);
+
+	PendingDemotions.Remove(Cube);
+	if (UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>())
+	{
+		CubePool->ReleaseCube(Cube);
+	}
+	else
+	{
+		Cube->Destroy();
+	}
+	return true;
+}
+
+int32 UPickupCubeInstanceSubsystem::PromoteInRadius(const FVector& Location, float Radius, TArray<APickupCube*>& OutCubes)
+{
+	int32 NumPromoted = 0;
+	for (auto& Pair : Batches)
+	{
+		if (!Pair.Value.Component || Pair.Value.Instances.Num() == 0)
+		{
+			continue;
+		}
+
+		TArray<int32> Overlapping = Pair.Value.Component->GetInstancesOverlappingSphere(Location, Radius, /*bSphereInWorldSpace*/ true);
+		NumPromoted += PromoteInstances(Pair.Key, Overlapping, OutCubes);
+	}
+	return NumPromoted;
+}
+
+int32 UPickupCubeInstanceSubsystem::PromoteAlongSegment(const FVector& Start, const FVector& End, float Radius, TArray<APickupCube*>& OutCubes)
+{
+	FBox SegmentBounds(ForceInit);
+	SegmentBounds += Start;
+	SegmentBounds += End;
+	SegmentBounds = SegmentBounds.ExpandBy(Radius);
+
+	int32 NumPromoted = 0;
+	for (auto& Pair : Batches)
+	{
+		UHierarchicalInstancedStaticMeshComponent* Component = Pair.Value.Component;
+		if (!Component || Pair.Value.Instances.Num() == 0 || !Component->GetStaticMesh())
+		{
+			continue;
+		}
+
+		const float MeshRadius = Component->GetStaticMesh()->GetBounds().SphereRadius;
+		TArray<int32> Candidates = Component->GetInstancesOverlappingBox(SegmentBounds, /*bBoxInWorldSpace*/ true);
+		Candidates.RemoveAllSwap([&](int32 InstanceIndex)
+		{
+			FTransform InstanceTransform;
+			Component->GetInstanceTransform(InstanceIndex, InstanceTransform, /*bWorldSpace*/ true);
+			const float ReachRadius = Radius + MeshRadius * InstanceTransform.GetMaximumAxisScale();
+			return FMath::PointDistToSegment(InstanceTransform.GetLocation(), Start, End) > ReachRadius;
+		});
+		NumPromoted += PromoteInstances(Pair.Key, Candidates, OutCubes);
+	}
+	return NumPromoted;
+}
+
+int32 UPickupCubeInstanceSubsystem::GetNumInstances() const
+{
+	int32 NumInstances = 0;
+	for (const auto& Pair : Batches)
+	{
+		NumInstances += Pair.Value.Instances.Num();
+	}
+	return NumInstances;
+}
+
+FCubeInstanceBatch& UPickupCubeInstanceSubsystem::FindOrCreateBatch(TSubclassOf<APickupCube> CubeClass)
+{
+	if (FCubeInstanceBatch* Existing = Batches.Find(CubeClass))
+	{
+		return *Existing;
+	}
+
+	FCubeInstanceBatch& Batch = Batches.Add(CubeClass);
+
+	const APickupCube* CubeDefaults = CubeClass->GetDefaultObject<APickupCube>();
+	const UStaticMeshComponent* Template = CubeDefaults->GetStaticMeshComponent();
+	if (!Template || !Template->GetStaticMesh())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no static mesh, its cubes will stay actors"), *GetNameSafe(CubeClass));
+		return Batch;
+	}
+
+	if (!HostActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		HostActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		USceneComponent* Root = NewObject<USceneComponent>(HostActor, TEXT("Root"));
+		HostActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(HostActor);
+	Component->SetStaticMesh(Template->GetStaticMesh());
+	for (int32 MaterialIndex = 0; MaterialIndex < Template->GetNumMaterials(); ++MaterialIndex)
+	{
+		Component->SetMaterial(MaterialIndex, Template->GetMaterial(MaterialIndex));
+	}
+	Component->SetCollisionProfileName(Template->GetCollisionProfileName());
+	Component->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	Component->SetNotifyRigidBodyCollision(true);
+	Component->bSupportRemoveAtSwap = true;
+	Component->OnComponentHit.AddDynamic(this, &UPickupCubeInstanceSubsystem::OnInstanceHit);
+	Component->SetupAttachment(HostActor->GetRootComponent());
+	Component->RegisterComponent();
+
+	Batch.Component = Component;
+	return Batch;
+}
+
+APickupCube* UPickupCubeInstanceSubsystem::PromoteInstance(TSubclassOf<APickupCube> CubeClass, int32 InstanceIndex)
+{
+	FCubeInstanceBatch* Batch = Batches.Find(CubeClass);
+	if (!Batch || !Batch->Instances.IsValidIndex(InstanceIndex))
+	{
+		return nullptr;
+	}
+
+	FTransform InstanceTransform;
+	Batch->Component->GetInstanceTransform(InstanceIndex, InstanceTransform, /*bWorldSpace*/ true);
+	const FCubeInstanceData Data = Batch->Instances[InstanceIndex];
+
+	// Take the actor first; if the pool can't hand one out the instance stays as it is
+	UPickupCubePoolSubsystem* CubePool = GetWorld()->GetSubsystem<UPickupCubePoolSubsystem>();
+	APickupCube* Cube = CubePool ? CubePool->AcquireCube(CubeClass, InstanceTransform) : nullptr;
+	if (!Cube)
+	{
+		return nullptr;
+	}
+
+	// Acquiring can spawn and a new batch would move this one, so find it again. Instance removal
+	// swaps the last instance into this slot; mirror that in the data array.
+	Batch = Batches.Find(CubeClass);
+	Batch->Component->RemoveInstance(InstanceIndex);
+	Batch->Instances.RemoveAtSwap(InstanceIndex, 1, EAllowShrinking::No);
+
+	Cube->SetHealthState(Data.CurrentHealth, Data.MaxHealth);
+	QueueDemotion(Cube, PromotedIdleDelay);
+	return Cube;
+}
+
+int32 UPickupCubeInstanceSubsystem::PromoteInstances(TSubclassOf<APickupCube> CubeClass, TArray<int32>& InstanceIndices, TArray<APickupCube*>& OutCubes)
+{
+	InstanceIndices.Sort(TGreater<int32>());
+
+	int32 NumPromoted = 0;
+	for (const int32 InstanceIndex : InstanceIndices)
+	{
+		const FCubeInstanceBatch* Batch = Batches.Find(CubeClass);
+		if (!Batch || !Batch->Instances.IsValidIndex(InstanceIndex))
+		{
+			continue;
+		}
+
+		APickupCube* Cube = PromoteInstance(CubeClass, InstanceIndex);
+		if (!Cube)
+		{
+			// The pool is out of cubes of this class. Nothing was removed, so the indices already
+			// promoted above this one are the only slots that moved; stop rather than retry the rest.
+			break;
+		}
+		OutCubes.Add(Cube);
+		NumPromoted++;
+	}
+	return NumPromoted;
+}
+
+void UPickupCubeInstanceSubsystem::OnInstanceHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	// Only physics contacts wake instances; characters walking over a pile should not promote it
+	if (OtherComp && OtherComp->IsSimulatingPhysics())
+	{
+		PendingContactPromotions.Add(Hit.ImpactPoint);
+	}
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupCubeInstanceSubsystem.generated.h"
+
+class APickupCube;
+class UHierarchicalInstancedStaticMeshComponent;
+
+/** Gameplay state carried by an instanced cube while it has no actor */
+USTRUCT()
+struct FCubeInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	float CurrentHealth = 0.0f;
+
+	UPROPERTY()
+	float MaxHealth = 0.0f;
+};
+
+/** All instanced cubes of one APickupCube class. Instances[i] mirrors instance i of Component. */
+USTRUCT()
+struct FCubeInstanceBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UHierarchicalInstancedStaticMeshComponent> Component;
+
+	UPROPERTY()
+	TArray<FCubeInstanceData> Instances;
+};
+
+/**
+ * Shows resting, unheld APickupCube actors as instances of one hierarchical instanced static mesh per
+ * cube class, returning the actor to the pool. Instances are turned back into real actors (promoted)
+ * when a pickup sweep, punch trace or physics contact reaches them. Health carries over both ways.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UPickupCubeInstanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Demote Cube once it has stayed idle for Delay seconds */
+	void QueueDemotion(APickupCube* Cube, float Delay);
+
+	/** Replace an idle cube actor with an instance. Returns false if the cube is held, moving, has health effects running or is not instanceable. */
+	UFUNCTION(BlueprintCallable, Category = "Instancing")
+	bool DemoteCube(APickupCube* Cube);
+
+	/** Promote every instance whose bounds overlap the sphere. Promoted actors are appended to OutCubes. */
+	UFUNCTION(BlueprintCallable, Category = "Instancing")
+	int32 PromoteInRadius(const FVector& Location, float Radius, TArray<APickupCube*>& OutCubes);
+
+	/** Promote every instance within Radius of the segment. Promoted actors are appended to OutCubes. */
+	UFUNCTION(BlueprintCallable, Category = "Instancing")
+	int32 PromoteAlongSegment(const FVector& Start, const FVector& End, float Radius, TArray<APickupCube*>& OutCubes);
+
+	UFUNCTION(BlueprintPure, Category = "Instancing")
+	int32 GetNumInstances() const;
+
+	/** Time a cube must stay idle before it is demoted */
+	UPROPERTY(Config, EditAnywhere, Category = "Instancing")
+	float IdleDelay = 2.0f;
+
+	/** Idle delay used after a promotion, so cubes that were just touched stay actors for a while */
+	UPROPERTY(Config, EditAnywhere, Category = "Instancing")
+	float PromotedIdleDelay = 5.0f;
+
+	/** Cubes moving faster than this are not considered at rest */
+	UPROPERTY(Config, EditAnywhere, Category = "Instancing")
+	float RestSpeedThreshold = 5.0f;
+
+	/** Upper bound on demotions per frame so large levels convert over several frames */
+	UPROPERTY(Config, EditAnywhere, Category = "Instancing")
+	int32 MaxDemotionsPerFrame = 512;
+
+private:
+	FCubeInstanceBatch& FindOrCreateBatch(TSubclassOf<APickupCube> CubeClass);
+	/** Swap an instance for a pooled actor; the instance is kept if the pool has none to give */
+	APickupCube* PromoteInstance(TSubclassOf<APickupCube> CubeClass, int32 InstanceIndex);
+
+	/**
+	 * Promote the given instance indices of one batch, highest index first so swap-removal only moves
+	 * slots above the ones still to come. Stops at the first failed promotion, leaving the rest as instances.
+	 */
+	int32 PromoteInstances(TSubclassOf<APickupCube> CubeClass, TArray<int32>& InstanceIndices, TArray<APickupCube*>& OutCubes);
+
+	UFUNCTION()
+	void OnInstanceHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	UPROPERTY()
+	TMap<TSubclassOf<APickupCube>, FCubeInstanceBatch> Batches;
+
+	/** Actor that owns the instanced components. Kept at the origin so instance transforms are world space. */
+	UPROPERTY()
+	TObjectPtr<AActor> HostActor;
+
+	/** Cubes waiting to be demoted, with the world time at which they may be */
+	TMap<TWeakObjectPtr<APickupCube>, double> PendingDemotions;
+
+	/** Contact points reported by physics this frame; promoted on the next tick outside the physics callback */
+	TArray<FVector> PendingContactPromotions;
+};
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupCubePoolSubsystem.h"
+#include "PickupCube.h"
+#include "Engine/World.h"
+
+void UPickupCubePoolSubsystem::Deinitialize()
+{
+	PendingRequests.Empty();
+	Pool.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UPickupCubePoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupCubePoolSubsystem, STATGROUP_Tickables);
+}
+
+void UPickupCubePoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingRequests.Num() == 0)
+	{
+		return;
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + SpawnBudgetMs / 1000.0;
+
+	// Always spawn at least one cube per frame so a tiny budget can't stall the queue
+	bool bSpawnedThisFrame = false;
+	while (PendingRequests.Num() > 0)
+	{
+		// Taken off the queue while spawning: a cube's BeginPlay can queue more requests and reallocate it
+		FPendingSpawnRequest Request = MoveTemp(PendingRequests[0]);
+		PendingRequests.RemoveAt(0);
+
+		while (Request.NextIndex < Request.Transforms.Num())
+		{
+			if (bSpawnedThisFrame && FPlatformTime::Seconds() >= EndTime)
+			{
+				PendingRequests.Insert(MoveTemp(Request), 0);
+				return;
+			}
+
+			const FTransform& Transform = Request.Transforms[Request.NextIndex++];
+			if (Request.bPrewarm)
+			{
+				// Another prewarm or released cubes may have filled the bucket since this was queued
+				if (GetNumPooled(Request.CubeClass) >= MaxPooledPerClass)
+				{
+					break;
+				}
+				if (APickupCube* Cube = SpawnCube(Request.CubeClass, Transform))
+				{
+					Cube->ReturnToPool();
+					Pool.FindOrAdd(Request.CubeClass).FreeCubes.Add(Cube);
+					Request.NumSpawned++;
+				}
+			}
+			else if (AcquireCube(Request.CubeClass, Transform))
+			{
+				Request.NumSpawned++;
+			}
+			bSpawnedThisFrame = true;
+		}
+
+		CompleteRequest(Request);
+	}
+}
+
+void UPickupCubePoolSubsystem::PrewarmPool(TSubclassOf<APickupCube> CubeClass, int32 Count)
+{
+	// Cubes replicate from the server; a client spawning its own would desync
+	if (!CubeClass || GetWorld()->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	// Cubes beyond MaxPooledPerClass would only be destroyed again on their first release
+	Count = FMath::Min(Count, MaxPooledPerClass - GetNumPooled(CubeClass));
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	FPendingSpawnRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.RequestId = NextRequestId++;
+	Request.CubeClass = CubeClass;
+	Request.Transforms.Init(FTransform::Identity, Count);
+	Request.StartFrame = GFrameCounter;
+	Request.bPrewarm = true;
+}
+
+APickupCube* UPickupCubePoolSubsystem::AcquireCube(TSubclassOf<APickupCube> CubeClass, const FTransform& Transform)
+{
+	if (!CubeClass || GetWorld()->GetNetMode() == NM_Client)
+	{
+		return nullptr;
+	}
+
+	if (FPickupCubePoolBucket* Bucket = Pool.Find(CubeClass))
+	{
+		while (Bucket->FreeCubes.Num() > 0)
+		{
+			APickupCube* Cube = Bucket->FreeCubes.Pop(EAllowShrinking::No);
+			if (IsValid(Cube))
+			{
+				PoolHits++;
+				Cube->ActivateFromPool(Transform);
+				return Cube;
+			}
+		}
+	}
+
+	PoolMisses++;
+	return SpawnCube(CubeClass, Transform);
+}
+
+void UPickupCubePoolSubsystem::ReleaseCube(APickupCube* Cube)
+{
+	if (!IsValid(Cube) || Cube->IsInPool())
+	{
+		return;
+	}
+
+	FPickupCubePoolBucket& Bucket = Pool.FindOrAdd(Cube->GetClass());
+	if (Bucket.FreeCubes.Num() >= MaxPooledPerClass)
+	{
+		Cube->Destroy();
+		return;
+	}
+
+	Cube->ReturnToPool();
+	Bucket.FreeCubes.Add(Cube);
+}
+
+int32 UPickupCubePoolSubsystem::RequestSpawn(TSubclassOf<APickupCube> CubeClass, const TArray<FTransform>& Transforms)
+{
+	if (!CubeClass || GetWorld()->GetNetMode() == NM_Client)
+	{
+		return INDEX_NONE;
+	}
+
+	FPendingSpawnRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.RequestId = NextRequestId++;
+	Request.CubeClass = CubeClass;
+	Request.Transforms = Transforms;
+	Request.StartFrame = GFrameCounter;
+	return Request.RequestId;
+}
+
+int32 UPickupCubePoolSubsystem::GetNumPooled(TSubclassOf<APickupCube> CubeClass) const
+{
+	const FPickupCubePoolBucket* Bucket = Pool.Find(CubeClass);
+	return Bucket ? Bucket->FreeCubes.Num() : 0;
+}
+
+APickupCube* UPickupCubePoolSubsystem::SpawnCube(TSubclassOf<APickupCube> CubeClass, const FTransform& Transform)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	APickupCube* Cube = GetWorld()->SpawnActor<APickupCube>(CubeClass, Transform, SpawnParams);
+	if (!Cube)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to spawn pooled cube of class %s"), *GetNameSafe(CubeClass));
+	}
+	return Cube;
+}
+
+void UPickupCubePoolSubsystem::CompleteRequest(const FPendingSpawnRequest& Request)
+{
+	FCubeSpawnRequestStats Stats;
+	Stats.RequestId = Request.RequestId;
+	Stats.NumRequested = Request.Transforms.Num();
+	Stats.NumSpawned = Request.NumSpawned;
+	Stats.FramesTaken = static_cast<int32>(GFrameCounter - Request.StartFrame) + 1;
+
+	if (MaxCompletedRequestHistory > 0)
+	{
+		if (CompletedRequests.Num() >= MaxCompletedRequestHistory)
+		{
+			CompletedRequests.RemoveAt(0);
+		}
+		CompletedRequests.Add(Stats);
+	}
+
+	OnSpawnRequestCompleted.Broadcast(Stats);
+}
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupCubePoolSubsystem.generated.h"
+
+class APickupCube;
+
+/** Result of a batched spawn request, reported once every cube of the request has been handed out */
+USTRUCT(BlueprintType)
+struct FCubeSpawnRequestStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 RequestId = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 NumRequested = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 NumSpawned = 0;
+
+	/** Number of frames between the request being queued and its last cube being spawned */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 FramesTaken = 0;
+};
+
+/** Free list for one cube class. Wrapped in a struct so the pool map can be a UPROPERTY. */
+USTRUCT()
+struct FPickupCubePoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<APickupCube>> FreeCubes;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCubeSpawnRequestCompleted, const FCubeSpawnRequestStats&, Stats);
+
+/**
+ * Owns every pooled APickupCube in the world. Cubes are pre-warmed, handed out with AcquireCube and
+ * recycled with ReleaseCube instead of being destroyed. Large spawn requests are queued and spread
+ * over several frames so that no single frame spends more than SpawnBudgetMs spawning actors.
+ * In networked games only the server spawns; pooled cubes reach clients through replication.
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UPickupCubePoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue CubeClass cubes to be spawned into the pool (inactive) under the per-frame budget, up to MaxPooledPerClass */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void PrewarmPool(TSubclassOf<APickupCube> CubeClass, int32 Count);
+
+	/** Returns an active cube at Transform, reusing a pooled one when available */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	APickupCube* AcquireCube(TSubclassOf<APickupCube> CubeClass, const FTransform& Transform);
+
+	/** Deactivates the cube and returns it to the pool, or destroys it if the pool is full */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void ReleaseCube(APickupCube* Cube);
+
+	/** Queue one cube per transform, spawned over as many frames as the budget requires. Returns the request id. */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	int32 RequestSpawn(TSubclassOf<APickupCube> CubeClass, const TArray<FTransform>& Transforms);
+
+	UFUNCTION(BlueprintPure, Category = "Pool")
+	int32 GetPoolHits() const { return PoolHits; }
+
+	UFUNCTION(BlueprintPure, Category = "Pool")
+	int32 GetPoolMisses() const { return PoolMisses; }
+
+	UFUNCTION(BlueprintPure, Category = "Pool")
+	int32 GetNumPooled(TSubclassOf<APickupCube> CubeClass) const;
+
+	UFUNCTION(BlueprintPure, Category = "Pool")
+	int32 GetNumPendingRequests() const { return PendingRequests.Num(); }
+
+	/** Stats of the most recently completed spawn requests, oldest first */
+	UFUNCTION(BlueprintPure, Category = "Pool")
+	const TArray<FCubeSpawnRequestStats>& GetCompletedRequestStats() const { return CompletedRequests; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Pool")
+	FOnCubeSpawnRequestCompleted OnSpawnRequestCompleted;
+
+	/** Time allowed for spawning queued cubes each frame */
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	float SpawnBudgetMs = 2.0f;
+
+	/** Released cubes beyond this count (per class) are destroyed instead of pooled */
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	int32 MaxPooledPerClass = 4096;
+
+	/** Number of completed request stats kept for GetCompletedRequestStats */
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	int32 MaxCompletedRequestHistory = 32;
+
+private:
+	struct FPendingSpawnRequest
+	{
+		int32 RequestId = INDEX_NONE;
+		TSubclassOf<APickupCube> CubeClass;
+		TArray<FTransform> Transforms;
+		int32 NextIndex = 0;
+		uint64 StartFrame = 0;
+		int32 NumSpawned = 0;
+
+		/** Prewarm requests spawn straight into the pool instead of handing cubes out */
+		bool bPrewarm = false;
+	};
+
+	APickupCube* SpawnCube(TSubclassOf<APickupCube> CubeClass, const FTransform& Transform);
+	void CompleteRequest(const FPendingSpawnRequest& Request);
+
+	UPROPERTY()
+	TMap<TSubclassOf<APickupCube>, FPickupCubePoolBucket> Pool;
+
+	TArray<FPendingSpawnRequest> PendingRequests;
+	TArray<FCubeSpawnRequestStats> CompletedRequests;
+
+	int32 NextRequestId = 0;
+	int32 PoolHits = 0;
+	int32 PoolMisses = 0;
+};
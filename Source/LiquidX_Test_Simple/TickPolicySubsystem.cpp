@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TickPolicySubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+bool FActorTickPolicySettings::WantsTick(const AActor* Actor) const
+{
+	switch (Policy)
+	{
+	case EActorTickPolicy::Always:
+		return true;
+	case EActorTickPolicy::Auto:
+		return Actor && (bNativeTick || Actor->GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AActor, ReceiveTick)));
+	default:
+		return false;
+	}
+}
+
+void UTickPolicySubsystem::Deinitialize()
+{
+	Entries.Empty();
+	EntryIndexByActor.Empty();
+	EntryIndexBySleepSource.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UTickPolicySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTickPolicySubsystem, STATGROUP_Tickables);
+}
+
+void UTickPolicySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Entries.Num() == 0)
+	{
+		return;
+	}
+
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	// Without any viewer (e.g. a server with no players yet) keep everything in range
+	const bool bHasViewers = ViewLocations.Num() > 0;
+
+	const int32 NumChecks = FMath::Min(MaxDistanceChecksPerFrame, Entries.Num());
+	for (int32 Check = 0; Check < NumChecks; ++Check)
+	{
+		NextDistanceCheck = NextDistanceCheck % Entries.Num();
+		const int32 EntryIndex = NextDistanceCheck++;
+
+		FTickPolicyEntry& Entry = Entries[EntryIndex];
+		const AActor* Actor = Entry.Actor.Get();
+		if (!Actor)
+		{
+			RemoveEntryAt(EntryIndex);
+			if (Entries.Num() == 0)
+			{
+				return;
+			}
+
+			// The last entry was swapped into this slot; check it next instead of stepping past it
+			NextDistanceCheck = EntryIndex;
+			continue;
+		}
+
+		if (Entry.DisableTickDistanceSq <= 0.0f)
+		{
+			continue;
+		}
+
+		bool bInRange = !bHasViewers;
+		const FVector ActorLocation = Actor->GetActorLocation();
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			if (FVector::DistSquared(ActorLocation, ViewLocation) <= Entry.DisableTickDistanceSq)
+			{
+				bInRange = true;
+				break;
+			}
+		}
+
+		if (bInRange != Entry.bInRange)
+		{
+			Entry.bInRange = bInRange;
+			RefreshTickEnabled(Entry);
+		}
+	}
+}
+
+void UTickPolicySubsystem::RegisterActor(AActor* Actor, const FActorTickPolicySettings& Settings, UPrimitiveComponent* SleepSource)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	UnregisterActor(Actor);
+
+	if (!Settings.WantsTick(Actor))
+	{
+		return;
+	}
+
+	Actor->SetActorTickInterval(Settings.TickInterval);
+
+	const int32 EntryIndex = Entries.AddDefaulted();
+	FTickPolicyEntry& Entry = Entries[EntryIndex];
+	Entry.Actor = Actor;
+	Entry.DisableTickDistanceSq = FMath::Square(Settings.DisableTickDistance);
+	EntryIndexByActor.Add(Actor, EntryIndex);
+
+	if (SleepSource && Settings.bDisableTickWhenAsleep)
+	{
+		Entry.SleepSource = SleepSource;
+		Entry.bAsleep = SleepSource->IsSimulatingPhysics() && !SleepSource->RigidBodyIsAwake();
+		SleepSource->BodyInstance.bGenerateWakeEvents = true;
+		SleepSource->OnComponentWake.AddUniqueDynamic(this, &UTickPolicySubsystem::OnSleepSourceWake);
+		SleepSource->OnComponentSleep.AddUniqueDynamic(this, &UTickPolicySubsystem::OnSleepSourceSleep);
+		EntryIndexBySleepSource.Add(SleepSource, EntryIndex);
+	}
+
+	RefreshTickEnabled(Entry);
+}
+
+void UTickPolicySubsystem::UnregisterActor(AActor* Actor)
+{
+	if (const int32* EntryIndex = EntryIndexByActor.Find(Actor))
+	{
+		RemoveEntryAt(*EntryIndex);
+	}
+
+	if (Actor)
+	{
+		Actor->SetActorTickEnabled(false);
+	}
+}
+
+void UTickPolicySubsystem::RefreshTickEnabled(const FTickPolicyEntry& Entry) const
+{
+	if (AActor* Actor = Entry.Actor.Get())
+	{
+		Actor->SetActorTickEnabled(!Entry.bAsleep && Entry.bInRange);
+	}
+}
+
+void UTickPolicySubsystem::RemoveEntryAt(int32 EntryIndex)
+{
+	FTickPolicyEntry& Entry = Entries[EntryIndex];
+	EntryIndexByActor.Remove(Entry.Actor);
+	if (UPrimitiveComponent* SleepSource = Entry.SleepSource.Get())
+	{
+		SleepSource->OnComponentWake.RemoveDynamic(this, &UTickPolicySubsystem::OnSleepSourceWake);
+		SleepSource->OnComponentSleep.RemoveDynamic(this, &UTickPolicySubsystem::OnSleepSourceSleep);
+	}
+	EntryIndexBySleepSource.Remove(Entry.SleepSource);
+
+	Entries.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+
+	// Re-point the maps at the entry that was swapped into this slot
+	if (Entries.IsValidIndex(EntryIndex))
+	{
+		const FTickPolicyEntry& Moved = Entries[EntryIndex];
+		EntryIndexByActor.Add(Moved.Actor, EntryIndex);
+		if (Moved.SleepSource.IsValid())
+		{
+			EntryIndexBySleepSource.Add(Moved.SleepSource, EntryIndex);
+		}
+	}
+}
+
+void UTickPolicySubsystem::OnSleepSourceWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	SetAsleep(WakingComponent, false);
+}
+
+void UTickPolicySubsystem::OnSleepSourceSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	SetAsleep(SleepingComponent, true);
+}
+
+void UTickPolicySubsystem::SetAsleep(UPrimitiveComponent* Component, bool bAsleep)
+{
+	if (const int32* EntryIndex = EntryIndexBySleepSource.Find(Component))
+	{
+		FTickPolicyEntry& Entry = Entries[*EntryIndex];
+		if (Entry.bAsleep != bAsleep)
+		{
+			Entry.bAsleep = bAsleep;
+			RefreshTickEnabled(Entry);
+		}
+	}
+}
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TickPolicySubsystem.generated.h"
+
+UENUM(BlueprintType)
+enum class EActorTickPolicy : uint8
+{
+	/** Never tick */
+	Never,
+	/** Tick only if the Blueprint implements Event Tick or a C++ subclass sets bNativeTick */
+	Auto,
+	/** Always tick (subject to interval, sleep and distance settings) */
+	Always
+};
+
+/** Per-actor tick policy. Actors start with tick disabled and only tick when this says so. */
+USTRUCT(BlueprintType)
+struct FActorTickPolicySettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tick")
+	EActorTickPolicy Policy = EActorTickPolicy::Auto;
+
+	/**
+	 * Set in the constructor of a C++ subclass that overrides Tick. A native override can't be seen
+	 * through reflection, so Auto would otherwise leave it without a tick.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Tick")
+	bool bNativeTick = false;
+
+	/** Seconds between ticks, 0 ticks every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tick", meta = (ClampMin = "0"))
+	float TickInterval = 0.0f;
+
+	/** Stop ticking while the physics body is asleep */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tick")
+	bool bDisableTickWhenAsleep = true;
+
+	/** Stop ticking when further than this from every player view, 0 disables the check */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tick", meta = (ClampMin = "0"))
+	float DisableTickDistance = 0.0f;
+
+	/** Whether Actor should tick at all under this policy */
+	bool WantsTick(const AActor* Actor) const;
+};
+
+/**
+ * Turns actor tick on and off from events instead of letting every actor tick every frame.
+ * Registered actors tick only while awake (physics sleep events) and near a player view
+ * (checked round-robin, a bounded number of actors per frame).
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UTickPolicySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Apply Settings to Actor. SleepSource, if given, drives the asleep state through its wake/sleep events. */
+	void RegisterActor(AActor* Actor, const FActorTickPolicySettings& Settings, UPrimitiveComponent* SleepSource = nullptr);
+
+	/** Stop managing Actor and disable its tick */
+	void UnregisterActor(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Tick")
+	int32 GetNumRegisteredActors() const { return Entries.Num(); }
+
+	/** Number of registered actors whose distance is re-checked each frame */
+	UPROPERTY(Config, EditAnywhere, Category = "Tick")
+	int32 MaxDistanceChecksPerFrame = 256;
+
+private:
+	struct FTickPolicyEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UPrimitiveComponent> SleepSource;
+		float DisableTickDistanceSq = 0.0f;
+		bool bAsleep = false;
+		bool bInRange = true;
+	};
+
+	void RefreshTickEnabled(const FTickPolicyEntry& Entry) const;
+	void RemoveEntryAt(int32 EntryIndex);
+
+	UFUNCTION()
+	void OnSleepSourceWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	UFUNCTION()
+	void OnSleepSourceSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	void SetAsleep(UPrimitiveComponent* Component, bool bAsleep);
+
+	TArray<FTickPolicyEntry> Entries;
+	TMap<TWeakObjectPtr<AActor>, int32> EntryIndexByActor;
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, int32> EntryIndexBySleepSource;
+
+	TArray<FVector> ViewLocations;
+	int32 NextDistanceCheck = 0;
+};
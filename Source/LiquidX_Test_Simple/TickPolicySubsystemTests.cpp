@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TickPolicySubsystem.h"
+#include "PickupCube.h"
+#include "InteractiveActor.h"
+#include "PickupCubeInstanceSubsystem.h"
+#include "LiquidXTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTickPolicyWantsTickTest, "LiquidX.TickPolicy.WantsTick",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTickPolicyWantsTickTest::RunTest(const FString& Parameters)
+{
+	const AActor* Actor = GetDefault<APickupCube>();
+
+	FActorTickPolicySettings Settings;
+	TestFalse(TEXT("Auto without an Event Tick or native tick"), Settings.WantsTick(Actor));
+
+	Settings.bNativeTick = true;
+	TestTrue(TEXT("Auto with a native Tick override"), Settings.WantsTick(Actor));
+
+	Settings.Policy = EActorTickPolicy::Never;
+	TestFalse(TEXT("Never, even with a native Tick override"), Settings.WantsTick(Actor));
+
+	Settings.Policy = EActorTickPolicy::Always;
+	Settings.bNativeTick = false;
+	TestTrue(TEXT("Always"), Settings.WantsTick(Actor));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTickPolicyTenThousandActorsTest, "LiquidX.TickPolicy.TenThousandActors",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Spawns 10k APickupCube and 10k AInteractiveActor and compares the game thread cost of a frame
+ * with every actor ticking, as before the tick policy, against the policy's opt-in ticks.
+ */
+bool FTickPolicyTenThousandActorsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumEach = 10000;
+	constexpr int32 NumFrames = 60;
+
+	FLiquidXTestWorld TestWorld;
+	UWorld* World = TestWorld.Get();
+
+	// Cubes are demoted to instances after IdleDelay, and the timed frames run well past the default.
+	// Both runs have to measure the same 20k actors, so keep the cubes as actors for the whole test.
+	if (UPickupCubeInstanceSubsystem* Instancing = World->GetSubsystem<UPickupCubeInstanceSubsystem>())
+	{
+		Instancing->IdleDelay = TNumericLimits<float>::Max();
+	}
+
+	// Actors still in the world and out of the pool
+	auto CountLiveActors = [](const TArray<AActor*>& InActors)
+	{
+		int32 NumLive = 0;
+		for (const AActor* Actor : InActors)
+		{
+			const APickupCube* Cube = Cast<APickupCube>(Actor);
+			NumLive += IsValid(Actor) && !(Cube && Cube->IsInPool()) ? 1 : 0;
+		}
+		return NumLive;
+	};
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(NumEach * 2);
+	for (int32 Index = 0; Index < NumEach; ++Index)
+	{
+		const FVector Location(Index % 100 * 200.0f, Index / 100 * 200.0f, 0.0f);
+		Actors.Add(World->SpawnActor<APickupCube>(Location, FRotator::ZeroRotator));
+		Actors.Add(World->SpawnActor<AInteractiveActor>(Location + FVector(0.0f, 0.0f, 500.0f), FRotator::ZeroRotator));
+	}
+	Actors.Remove(nullptr);
+	TestEqual(TEXT("Spawned actors"), Actors.Num(), NumEach * 2);
+
+	// Settle the spawn work first, so the timed frames only compare ticking
+	TestWorld.Tick(2);
+
+	int32 NumTicking = 0;
+	for (const AActor* Actor : Actors)
+	{
+		NumTicking += Actor->IsActorTickEnabled() ? 1 : 0;
+	}
+	TestEqual(TEXT("Actors ticking under the default policy"), NumTicking, 0);
+
+	const double PolicyMs = TestWorld.Tick(NumFrames);
+	TestEqual(TEXT("Actors live after the tick policy frames"), CountLiveActors(Actors), NumEach * 2);
+
+	// Before the policy both classes ticked from BeginPlay
+	for (AActor* Actor : Actors)
+	{
+		Actor->SetActorTickEnabled(true);
+	}
+	const double AlwaysTickMs = TestWorld.Tick(NumFrames);
+	TestEqual(TEXT("Actors live after the all-ticking frames"), CountLiveActors(Actors), NumEach * 2);
+
+	AddInfo(FString::Printf(TEXT("%d actors: %.3f ms/frame all ticking, %.3f ms/frame with the tick policy"), Actors.Num(), AlwaysTickMs, PolicyMs));
+	TestTrue(TEXT("The tick policy frame is cheaper than ticking every actor"), PolicyMs < AlwaysTickMs);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
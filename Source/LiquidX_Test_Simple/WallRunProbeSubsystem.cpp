@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WallRunProbeSubsystem.h"
+#include "GameplayDebugDrawSubsystem.h"
+#include "LiquidXStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+void UWallRunProbeSubsystem::Deinitialize()
+{
+	Probers.Empty();
+	FreeProbers.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UWallRunProbeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWallRunProbeSubsystem, STATGROUP_Tickables);
+}
+
+void UWallRunProbeSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumTracesLastFrame = 0;
+
+	UWorld* World = GetWorld();
+	const uint64 Frame = GFrameCounter;
+	for (int32 ProberHandle = 0; ProberHandle < Probers.Num(); ++ProberHandle)
+	{
+		FWallProber& Prober = Probers[ProberHandle];
+		const AActor* Owner = Prober.Owner.Get();
+
+		// Only probe for characters that asked this frame, and never stack probes
+		if (!Owner || Prober.LastUpdateFrame != Frame || Prober.NumPending > 0)
+		{
+			continue;
+		}
+
+		if (Prober.FramesUntilProbe > 0)
+		{
+			Prober.FramesUntilProbe--;
+			continue;
+		}
+		Prober.FramesUntilProbe = Prober.ProbeInterval - 1;
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WallRunProbe), false, Owner);
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			const FVector Direction = Side == 0 ? Prober.Right : -Prober.Right;
+			const FVector End = Prober.Start + Direction * Prober.Distance + Prober.ForwardOffset;
+			const FTraceDelegate Delegate = FTraceDelegate::CreateUObject(this, &UWallRunProbeSubsystem::OnTraceCompleted, ProberHandle, Prober.Serial, Side);
+			World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Prober.Start, End, ProbeChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &Delegate);
+		}
+		Prober.NumPending = 2;
+		NumTracesLastFrame += 2;
+		LIQUIDX_COUNT_SCENE_QUERIES(STAT_LiquidX_WallRunQueries, 2);
+	}
+}
+
+int32 UWallRunProbeSubsystem::RegisterProber(AActor* Owner)
+{
+	const int32 ProberHandle = FreeProbers.Num() > 0 ? FreeProbers.Pop(EAllowShrinking::No) : Probers.AddDefaulted();
+
+	FWallProber& Prober = Probers[ProberHandle];
+	Prober = FWallProber();
+	Prober.Owner = Owner;
+	Prober.Serial = NextSerial++;
+	return ProberHandle;
+}
+
+void UWallRunProbeSubsystem::UnregisterProber(int32 ProberHandle)
+{
+	if (Probers.IsValidIndex(ProberHandle) && Probers[ProberHandle].Serial != 0)
+	{
+		// Clearing the serial makes any in-flight trace for this slot stale
+		Probers[ProberHandle] = FWallProber();
+		FreeProbers.Add(ProberHandle);
+	}
+}
+
+void UWallRunProbeSubsystem::UpdateProbe(int32 ProberHandle, const FVector& Start, const FVector& Right, const FVector& ForwardOffset, float Distance)
+{
+	if (!Probers.IsValidIndex(ProberHandle))
+	{
+		return;
+	}
+
+	FWallProber& Prober = Probers[ProberHandle];
+	Prober.Start = Start;
+	Prober.Right = Right;
+	Prober.ForwardOffset = ForwardOffset;
+	Prober.Distance = Distance;
+	Prober.LastUpdateFrame = GFrameCounter;
+}
+
+void UWallRunProbeSubsystem::ResetProbeResult(int32 ProberHandle)
+{
+	if (Probers.IsValidIndex(ProberHandle))
+	{
+		FWallProber& Prober = Probers[ProberHandle];
+		Prober.Result = FWallProbeResult();
+		Prober.ProbeInterval = Prober.MinProbeInterval;
+		Prober.FramesUntilProbe = 0;
+
+		// A new serial makes traces issued before the reset stale, so they can't republish an old wall
+		Prober.Serial = NextSerial++;
+		Prober.NumPending = 0;
+	}
+}
+
+void UWallRunProbeSubsystem::SetProberLOD(int32 ProberHandle, int32 MinInterval, bool bDebugDraw)
+{
+	if (Probers.IsValidIndex(ProberHandle))
+	{
+		FWallProber& Prober = Probers[ProberHandle];
+		Prober.MinProbeInterval = FMath::Max(1, MinInterval);
+		Prober.ProbeInterval = FMath::Max(Prober.ProbeInterval, Prober.MinProbeInterval);
+		Prober.bDebugDraw = bDebugDraw;
+	}
+}
+
+const FWallProbeResult& UWallRunProbeSubsystem::GetProbeResult(int32 ProberHandle) const
+{
+	static const FWallProbeResult NoResult;
+	return Probers.IsValidIndex(ProberHandle) ? Probers[ProberHandle].Result : NoResult;
+}
+
+void UWallRunProbeSubsystem::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, int32 ProberHandle, uint32 Serial, int32 Side)
+{
+	if (!Probers.IsValidIndex(ProberHandle) || Probers[ProberHandle].Serial != Serial)
+	{
+		return;
+	}
+
+	FWallProber& Prober = Probers[ProberHandle];
+	const bool bHit = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+	Prober.bSideHit[Side] = bHit;
+	Prober.SideNormal[Side] = bHit ? FVector(Datum.OutHits[0].Normal) : FVector::ZeroVector;
+	LIQUIDX_DEBUG_LINE(Prober.bDebugDraw ? GetWorld() : nullptr, WallRun, Datum.Start, Datum.End, bHit ? FColor::Green : FColor::Red);
+
+	if (--Prober.NumPending == 0)
+	{
+		PublishResult(Prober);
+	}
+}
+
+void UWallRunProbeSubsystem::PublishResult(FWallProber& Prober)
+{
+	// Same preference as the synchronous check: the right-hand wall wins
+	FWallProbeResult NewResult;
+	NewResult.bValid = true;
+	if (Prober.bSideHit[0])
+	{
+		NewResult.bHit = true;
+		NewResult.WallNormal = Prober.SideNormal[0];
+	}
+	else if (Prober.bSideHit[1])
+	{
+		NewResult.bHit = true;
+		NewResult.WallNormal = Prober.SideNormal[1];
+	}
+
+	const FWallProbeResult& OldResult = Prober.Result;
+	const bool bUnchanged = OldResult.bValid && OldResult.bHit == NewResult.bHit
+		&& (!NewResult.bHit || FVector::DotProduct(OldResult.WallNormal, NewResult.WallNormal) > 0.99f);
+
+	if (bUnchanged)
+	{
+		Prober.ProbeInterval = FMath::Max(FMath::Min(Prober.ProbeInterval * 2, FMath::Max(1, MaxProbeInterval)), Prober.MinProbeInterval);
+	}
+	else
+	{
+		Prober.ProbeInterval = Prober.MinProbeInterval;
+		Prober.FramesUntilProbe = 0;
+	}
+
+	Prober.Result = NewResult;
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "WallRunProbeSubsystem.generated.h"
+
+/** Latest wall probe result for one character */
+struct FWallProbeResult
+{
+	bool bValid = false;
+	bool bHit = false;
+	FVector WallNormal = FVector::ZeroVector;
+};
+
+/**
+ * Batches the left/right wall-run probes of every wall-run-capable character into async line
+ * traces. Probes updated during a frame are issued together at the end of that frame and their
+ * results are delivered before the next frame's abilities tick. Probers whose result did not
+ * change probe less often, up to MaxProbeInterval frames apart, and less significant characters
+ * have a floor on that interval (see SetProberLOD).
+ */
+UCLASS(config = Game)
+class LIQUIDX_TEST_SIMPLE_API UWallRunProbeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Returns a prober handle for Owner */
+	int32 RegisterProber(AActor* Owner);
+	void UnregisterProber(int32 ProberHandle);
+
+	/** Ask for a probe from Start along +/-Right (plus ForwardOffset) this frame */
+	void UpdateProbe(int32 ProberHandle, const FVector& Start, const FVector& Right, const FVector& ForwardOffset, float Distance);
+
+	/** Drop the prober's last result and any probe in flight, and probe at full rate again */
+	void ResetProbeResult(int32 ProberHandle);
+
+	/** Probe at most every MinInterval frames, and only draw the probes with bDebugDraw; set by the owner's significance */
+	void SetProberLOD(int32 ProberHandle, int32 MinInterval, bool bDebugDraw);
+
+	/** Most recent completed result for the prober */
+	const FWallProbeResult& GetProbeResult(int32 ProberHandle) const;
+
+	UFUNCTION(BlueprintPure, Category = "Wall Run")
+	int32 GetNumTracesLastFrame() const { return NumTracesLastFrame; }
+
+	/** Longest gap, in frames, between probes of a prober whose result keeps coming back the same */
+	UPROPERTY(Config, EditAnywhere, Category = "Wall Run")
+	int32 MaxProbeInterval = 4;
+
+	/** Collision channel the probes trace against */
+	UPROPERTY(Config, EditAnywhere, Category = "Wall Run")
+	TEnumAsByte<ECollisionChannel> ProbeChannel = ECC_Visibility;
+
+private:
+	struct FWallProber
+	{
+		TWeakObjectPtr<AActor> Owner;
+		uint32 Serial = 0;
+
+		// Probe requested this frame
+		FVector Start = FVector::ZeroVector;
+		FVector Right = FVector::ZeroVector;
+		FVector ForwardOffset = FVector::ZeroVector;
+		float Distance = 0.0f;
+		uint64 LastUpdateFrame = 0;
+
+		// Adaptive rate, never faster than MinProbeInterval
+		int32 ProbeInterval = 1;
+		int32 MinProbeInterval = 1;
+		int32 FramesUntilProbe = 0;
+		bool bDebugDraw = true;
+
+		// In-flight probe: index 0 is the right side, 1 the left
+		int32 NumPending = 0;
+		bool bSideHit[2] = { false, false };
+		FVector SideNormal[2];
+
+		FWallProbeResult Result;
+	};
+
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, int32 ProberHandle, uint32 Serial, int32 Side);
+	void PublishResult(FWallProber& Prober);
+
+	TArray<FWallProber> Probers;
+	TArray<int32> FreeProbers;
+	uint32 NextSerial = 1;
+
+	int32 NumTracesLastFrame = 0;
+};